@@ -29,6 +29,13 @@ keywords = [
     "decoration",
     "rect",
     "star",
+    "ellipse",
+    "none",
+    "hull",
+    "aabb",
+    "obb",
+    "circle",
+    "capsule",
     "--",
     "-=",
     "-+",
@@ -74,6 +81,9 @@ def parse_shape(pos, shape):
     if shape_type == "rect":
         width, height = map(float, shape[1:])
         assert width >= 0 and height >= 0
+    elif shape_type == "ellipse":
+        width, height, num_verts = map(float, shape[1:])
+        assert width >= 0 and height >= 0 and num_verts >= 3
     return "{" + shape_type + "," + ",".join(map(str, shape_args)) + "}"
 
 
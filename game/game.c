@@ -4,6 +4,7 @@
 #include "game_constants.h"
 #include "game_gui.h"
 #include "game_load_level.h"
+#include "game_pools.h"
 #include "game_timers.h"
 #include "sdl_wrapper.h"
 #include "state.h"
@@ -22,12 +23,13 @@ state_t *emscripten_init() {
     state->menu_scene = scene_init();
     state->player = NULL;
     state->held_keys = malloc(sizeof(bool) * (CHAR_MAX + 1));
-    state->timers = list_init(1, free);
+    state->timers = timer_array_init(1);
     state->curr_level = 0;
     state->level_time_elapsed = 0;
     state->game_status = MENU;
     state->num_deaths_so_far = 0;
     state->scene_boundary = INFINITE_BBOX;
+    init_body_pools(state);
     load_main_menu(state);
     return state;
 }
@@ -74,8 +76,13 @@ void emscripten_free(state_t *state) {
     scene_free(state->scene);
     scene_free(state->hud_scene);
     scene_free(state->menu_scene);
+    // after the game scene, which hands the pooled bodies back
+    free_body_pools(state);
     free(state->held_keys);
-    list_free(state->timers);
+    for (size_t i = 0; i < timer_array_size(state->timers); i++) {
+        free(timer_array_get(state->timers, i));
+    }
+    timer_array_free(state->timers);
     free(state);
     sdl_free();
 }
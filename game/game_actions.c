@@ -6,6 +6,7 @@
 #include "game_forces.h"
 #include "game_gui.h"
 #include "game_load_level.h"
+#include "game_pools.h"
 #include "polygon.h"
 #include "sdl_wrapper.h"
 #include <assert.h>
@@ -19,18 +20,21 @@
 
 body_t *create_bullet(state_t *state, body_t *crewmate) {
     assert(get_role(crewmate) == CREWMATE);
+    body_t *bullet = body_pool_take(state->bullet_pool);
+    if (!bullet) {
+        return NULL;
+    }
     crewmate_info_t *crewmate_info = (crewmate_info_t *)body_get_info(crewmate);
     vector_t bullet_init_loc = {
         .x = body_get_centroid(crewmate).x + BULLET_INIT_HORIZONTAL_OFFSET,
         .y = body_get_centroid(crewmate).y + BULLET_INIT_VERTICAL_OFFSET};
-    list_t *bullet_shape = initialize_rectangle_centered(
-        bullet_init_loc, BULLET_WIDTH, BULLET_HEIGHT);
-    damaging_obstacle_info_t *bullet_info = damaging_obstacle_info_init(
-        BULLET, crewmate_info->damage_per_bullet, NULL, true,
-        crewmate_info->game_over_message);
-    body_t *bullet = body_init_with_info(bullet_shape, BULLET_MASS,
-                                         BULLET_COLOR, bullet_info, free);
-    add_body_with_forces(state, bullet);
+    body_set_centroid(bullet, bullet_init_loc);
+    body_set_velocity(bullet, VEC_ZERO);
+    damaging_obstacle_info_t *bullet_info = body_get_info(bullet);
+    bullet_info->damage = crewmate_info->damage_per_bullet;
+    // The message lasts as long as the level, even if the crewmate doesn't
+    bullet_info->game_over_message = crewmate_info->game_over_message;
+    scene_add_body(state->scene, bullet);
     return bullet;
 }
 
@@ -61,8 +65,12 @@ void crewmate_attack_player(state_t *state, body_t *crewmate, double dt) {
         scene_detect_line_of_sight(state->scene, crewmate, state->player,
                                    crewmate_line_of_sight_opaqueness)) {
         if (crewmate_info->reloading_timer <= 0) {
-            fire_bullet(state, crewmate, create_bullet(state, crewmate));
-            crewmate_info->reloading_timer = crewmate_info->reload_time;
+            // If every bullet is in flight, try again next tick
+            body_t *bullet = create_bullet(state, crewmate);
+            if (bullet) {
+                fire_bullet(state, crewmate, bullet);
+                crewmate_info->reloading_timer = crewmate_info->reload_time;
+            }
         } else {
             crewmate_info->reloading_timer -= dt;
         }
@@ -75,7 +83,7 @@ void update_body_trajectory(body_t *body) {
     if (!trajectory_info) {
         return; // no trajectory associated with body
     }
-    list_t *trajectory_shape = trajectory_info->trajectory_shape;
+    polygon_t *trajectory_shape = trajectory_info->trajectory_shape;
     vector_t curr_point = get_curr_trajectory_point(body);
     vector_t next_point = get_next_trajectory_point(body);
     vector_t body_centroid = body_get_centroid(body);
@@ -83,7 +91,7 @@ void update_body_trajectory(body_t *body) {
     if (vec_dot(vec_subtract(next_point, curr_point),
                 vec_subtract(next_point, body_centroid)) <= 0) {
         trajectory_info->curr_point_index++;
-        trajectory_info->curr_point_index %= list_size(trajectory_shape);
+        trajectory_info->curr_point_index %= trajectory_shape->num_vertices;
     }
     vector_t direction = vec_direction(vec_subtract(next_point, body_centroid));
     vector_t new_velocty = vec_multiply(trajectory_info->speed, direction);
@@ -95,7 +103,7 @@ void pseudo_rotation_mech(body_t *prev_tongue, body_t *curr_tongue,
     assert(get_role(prev_tongue) & (TONGUE_TIP | TONGUE));
     assert(get_role(curr_tongue) & (TONGUE_TIP | TONGUE));
     body_role_t role = DECORATION;
-    body_info_t *tongue_info = body_info_init(role);
+    body_info_t *tongue_info = body_info_init(NULL, role);
     body_t *temp_rectangle =
         body_init_with_info(initialize_rectangle_rotated(
                                 body_get_centroid(prev_tongue),
@@ -109,7 +117,10 @@ void deploy_tongue(state_t *state, vector_t velocity) {
     body_t *player = state->player;
     assert(player);
     player_info_t *player_info = body_get_info(player);
-    if (player_info->tongue_status != READY) {
+    // The pieces of the last tongue are handed back the tick after it is
+    // removed, well before the tongue charges again
+    if (player_info->tongue_status != READY ||
+        !body_pool_take_all(state->tongue_pool)) {
         return;
     }
     sdl_play_sound_effect(TONGUE_SOUND_FILEPATH, false);
@@ -119,37 +130,23 @@ void deploy_tongue(state_t *state, vector_t velocity) {
     // wherever the mouth of the player is
     vector_t spawn_position = body_get_centroid(player);
     assert(TONGUE_NUM_PIECES >= 2);
-    body_t *prev = NULL;
     for (size_t i = 0; i < TONGUE_NUM_PIECES; i++) {
-        body_role_t role = i == TONGUE_NUM_PIECES - 1 ? TONGUE_TIP : TONGUE;
-        body_info_t *tongue_info =
-            role == TONGUE_TIP ? (body_info_t *)damaging_body_info_init(
-                                     TONGUE_TIP, player_info->tongue_damage)
-                               : body_info_init(role);
-        body_t *tongue_piece = body_init_with_info(
-            initialize_rectangle_anchored(
-                (anchor_option_t){.x_anchor = ANCHOR_MIN,
-                                  .y_anchor = ANCHOR_CENTER},
-                spawn_position, TONGUE_WIDTH, TONGUE_WIDTH),
-            TONGUE_PIECE_MASS, TONGUE_COLOR, tongue_info, free);
-        if (prev) {
-            create_spring(state->scene, TONGUE_SPRING_CONSTANT, prev,
-                          tongue_piece);
-            create_special_interaction(
-                state->scene, prev, tongue_piece,
-                (special_interaction_handler_t)pseudo_rotation_mech, true,
-                state, NULL);
-        } else {
-            create_spring(state->scene, TONGUE_SPRING_CONSTANT, tongue_piece,
-                          player);
+        body_t *tongue_piece = body_pool_get(state->tongue_pool, i);
+        if (get_role(tongue_piece) == TONGUE_TIP) {
+            get_damaging_body_info(tongue_piece)->damage =
+                player_info->tongue_damage;
         }
-        add_body_with_forces(state, tongue_piece);
+        // The tip was made immovable when it last attached to a wall
+        body_set_mass(tongue_piece, TONGUE_PIECE_MASS);
+        body_set_centroid(tongue_piece,
+                          vec_add(spawn_position,
+                                  (vector_t){.x = TONGUE_WIDTH / 2.0, .y = 0}));
         // Initialize velocities to go from 0 to velocity along the length of
         // the tongue
         body_set_velocity(
             tongue_piece,
             vec_multiply(((double)i / TONGUE_NUM_PIECES), velocity));
-        prev = tongue_piece;
+        scene_add_body(state->scene, tongue_piece);
     }
 }
 
@@ -159,14 +156,119 @@ void remove_tongue(state_t *state) {
     player_info_t *player_info = body_get_info(player);
     assert(player_info->tongue_status == DEPLOYED ||
            player_info->tongue_status == ATTACHED);
-    for (size_t i = 0; i < scene_bodies(state->scene); i++) {
-        body_t *body = scene_get_body(state->scene, i);
-        if (get_role(body) & (TONGUE | TONGUE_TIP)) {
-            body_remove(body);
+    for (size_t i = 0; i < TONGUE_NUM_PIECES; i++) {
+        body_remove(body_pool_get(state->tongue_pool, i));
+    }
+}
+
+/**
+ * Helper function.
+ * Adds the force of a spring between two bodies, like create_spring().
+ */
+void add_spring_force(double k, body_t *body1, body_t *body2) {
+    vector_t force = vec_multiply(
+        k, vec_subtract(body_get_centroid(body2), body_get_centroid(body1)));
+    body_add_force(body1, force);
+    body_add_force(body2, vec_negate(force));
+}
+
+/**
+ * Helper function.
+ * Adds the force of gravity on a body, unless it is immovable.
+ */
+void add_gravity_force(double g, body_t *body) {
+    double mass = body_get_mass(body);
+    if (mass != INFINITY) {
+        body_add_force(body, (vector_t){.x = 0, .y = -mass * g});
+    }
+}
+
+/**
+ * Helper function.
+ * Applies gravity to the bullets in flight, and removes the ones that left
+ * the level so that they can be fired again.
+ */
+void bullet_pool_force_creator(state_t *state) {
+    body_pool_t *pool = state->bullet_pool;
+    for (size_t i = 0; i < body_pool_size(pool); i++) {
+        if (!body_pool_is_in_use(pool, i)) {
+            continue;
+        }
+        body_t *bullet = body_pool_get(pool, i);
+        if (!bounding_box_overlaps(body_get_bounding_box(bullet),
+                                   state->scene_boundary)) {
+            body_remove(bullet);
+        } else {
+            add_gravity_force(BULLET_GRAVITY_ACCELERATION, bullet);
         }
     }
 }
 
+/**
+ * Helper function.
+ * Returns whether the pieces of the tongue are in the game scene, and not
+ * about to be handed back to their pool.
+ */
+bool is_tongue_deployed(body_pool_t *pool) {
+    // The pieces are all taken at once and removed together
+    return body_pool_is_in_use(pool, 0) &&
+           !body_is_removed(body_pool_get(pool, 0));
+}
+
+/**
+ * Helper function.
+ * Applies gravity and drag to the pieces of the deployed tongue, and the
+ * springs that hold it together and to the player.
+ */
+void tongue_pool_force_creator(state_t *state) {
+    body_pool_t *pool = state->tongue_pool;
+    if (!is_tongue_deployed(pool)) {
+        return;
+    }
+    body_t *prev = state->player;
+    for (size_t i = 0; i < TONGUE_NUM_PIECES; i++) {
+        body_t *tongue_piece = body_pool_get(pool, i);
+        add_gravity_force(BULLET_GRAVITY_ACCELERATION, tongue_piece);
+        body_add_force(tongue_piece,
+                       vec_multiply(-TONGUE_DRAG_CONSTANT,
+                                    body_get_velocity(tongue_piece)));
+        add_spring_force(TONGUE_SPRING_CONSTANT, prev, tongue_piece);
+        prev = tongue_piece;
+    }
+    player_info_t *player_info = body_get_info(state->player);
+    if (player_info->tongue_status == ATTACHED) {
+        add_spring_force(TONGUE_ATTACHED_SPRING_CONSTANT, state->player, prev);
+    }
+}
+
+/**
+ * Helper function.
+ * Draws the deployed tongue's pieces as one rotated strip.
+ */
+void tongue_pool_rotation_creator(state_t *state) {
+    body_pool_t *pool = state->tongue_pool;
+    if (!is_tongue_deployed(pool)) {
+        return;
+    }
+    for (size_t i = 1; i < TONGUE_NUM_PIECES; i++) {
+        pseudo_rotation_mech(body_pool_get(pool, i - 1),
+                             body_pool_get(pool, i), state);
+    }
+}
+
+void add_pooled_body_forces(state_t *state) {
+    // They don't depend on any body, so they last as long as the level
+    scene_add_body_array_force_creator(
+        state->scene, (force_creator_t)bullet_pool_force_creator, false, state,
+        NULL, 0, NULL);
+    scene_add_body_array_force_creator(
+        state->scene, (force_creator_t)tongue_pool_force_creator, false, state,
+        NULL, 0, NULL);
+    scene_add_body_array_force_creator(
+        state->scene, (force_creator_t)tongue_pool_rotation_creator, true,
+        state, NULL, 0, NULL);
+}
+
 void body_health_invincibility_effect(state_t *state, body_t *body, double dt) {
     body_health_info_t *health_info = get_health_info(body);
     if (health_info->invincibility_time_left > 0) {
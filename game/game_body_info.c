@@ -5,9 +5,19 @@
 
 #define INITIAL_LIST_SIZE 2
 
-body_info_t *body_info_init(body_role_t role) {
-    body_info_t *result = malloc(sizeof(body_info_t));
-    assert(result);
+/**
+ * Helper function.
+ * Allocates memory for an info from a scene's arena, or with malloc() if the
+ * scene is NULL.
+ */
+void *info_alloc(scene_t *scene, size_t size) {
+    void *info = scene ? scene_alloc(scene, size) : malloc(size);
+    assert(info);
+    return info;
+}
+
+body_info_t *body_info_init(scene_t *scene, body_role_t role) {
+    body_info_t *result = info_alloc(scene, sizeof(body_info_t));
     result->role = role;
     return result;
 }
@@ -22,9 +32,10 @@ body_health_info_t *body_health_info_init(size_t health,
     return health_info;
 }
 
-damaging_body_info_t *damaging_body_info_init(body_role_t role, size_t damage) {
+damaging_body_info_t *damaging_body_info_init(scene_t *scene, body_role_t role,
+                                              size_t damage) {
     damaging_body_info_t *damaging_body_info =
-        malloc(sizeof(damaging_body_info_t));
+        info_alloc(scene, sizeof(damaging_body_info_t));
     damaging_body_info->role = role;
     damaging_body_info->damage = damage;
     return damaging_body_info;
@@ -52,17 +63,17 @@ void player_info_free(player_info_t *player_info) {
     free(player_info);
 }
 
-key_and_door_info_t *key_and_door_info_init(body_role_t role, size_t id) {
-    key_and_door_info_t *key_and_door_info =
-        malloc(sizeof(key_and_door_info_t));
+key_and_door_info_t *key_and_door_info_init(scene_t *scene, body_role_t role,
+                                            size_t id) {
     assert(role & (KEY | DOOR));
-    assert(key_and_door_info);
+    key_and_door_info_t *key_and_door_info =
+        info_alloc(scene, sizeof(key_and_door_info_t));
     key_and_door_info->role = role;
     key_and_door_info->id = id;
     return key_and_door_info;
 }
 
-trajectory_info_t *trajectory_info_init(list_t *trajectory_shape,
+trajectory_info_t *trajectory_info_init(polygon_t *trajectory_shape,
                                         double speed) {
     if (!trajectory_shape) { // trajectory shape is NULL
         return NULL;
@@ -75,7 +86,7 @@ trajectory_info_t *trajectory_info_init(list_t *trajectory_shape,
 }
 
 void trajectory_info_free(trajectory_info_t *trajectory_info) {
-    list_free(trajectory_info->trajectory_shape);
+    polygon_free(trajectory_info->trajectory_shape);
     free(trajectory_info);
 }
 
@@ -99,7 +110,6 @@ crewmate_info_t *crewmate_info_init(size_t health, double invincibility_time,
 }
 
 void crewmate_info_free(crewmate_info_t *crewmate_info) {
-    free(crewmate_info->game_over_message);
     if (crewmate_info->trajectory_info) {
         trajectory_info_free(crewmate_info->trajectory_info);
     }
@@ -130,8 +140,9 @@ void damaging_obstacle_info_free(
     free(damaging_obstacle_info);
 }
 
-trampoline_info_t *trampoline_info_init(double bounciness) {
-    trampoline_info_t *trampoline_info = malloc(sizeof(trampoline_info_t));
+trampoline_info_t *trampoline_info_init(scene_t *scene, double bounciness) {
+    trampoline_info_t *trampoline_info =
+        info_alloc(scene, sizeof(trampoline_info_t));
     trampoline_info->role = TRAMPOLINE;
     trampoline_info->bounciness = bounciness;
     return trampoline_info;
@@ -157,16 +168,15 @@ trajectory_info_t *get_trajectory(body_t *body) {
 
 vector_t get_curr_trajectory_point(body_t *body) {
     trajectory_info_t *trajectory_info = get_trajectory(body);
-    return *(vector_t *)list_get(trajectory_info->trajectory_shape,
-                                 trajectory_info->curr_point_index);
+    return trajectory_info->trajectory_shape
+        ->vertices[trajectory_info->curr_point_index];
 }
 
 vector_t get_next_trajectory_point(body_t *body) {
     trajectory_info_t *trajectory_info = get_trajectory(body);
-    return *(vector_t *)list_get(
-        trajectory_info->trajectory_shape,
-        (trajectory_info->curr_point_index + 1) %
-            list_size(trajectory_info->trajectory_shape));
+    polygon_t *trajectory_shape = trajectory_info->trajectory_shape;
+    return trajectory_shape->vertices[(trajectory_info->curr_point_index + 1) %
+                                      trajectory_shape->num_vertices];
 }
 
 body_health_info_t *get_health_info(body_t *body) {
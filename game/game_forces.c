@@ -42,13 +42,13 @@ void player_ground_collision_handler(body_t *player, body_t *ground,
 }
 
 void player_trampoline_collision_handler(body_t *player, body_t *trampoline,
-                                         vector_t *collision_axis,
+                                         vector_t collision_axis,
                                          state_t *state) {
     assert(get_role(player) == PLAYER);
     assert(get_role(trampoline) == TRAMPOLINE);
     trampoline_info_t *trampoline_info = body_get_info(trampoline);
-    body_add_impulse(player,
-                     (vector_t){.x = 0, .y = trampoline_info->bounciness});
+    double elasticity = trampoline_info->bounciness;
+    physics_collision_handler(player, trampoline, collision_axis, &elasticity);
 }
 
 void tongue_tip_collision_handler(body_t *tongue_tip, body_t *to_attach,
@@ -61,10 +61,9 @@ void tongue_tip_collision_handler(body_t *tongue_tip, body_t *to_attach,
     body_t *player = state->player;
     assert(player);
     player_info_t *player_info = body_get_info(player);
-    // Make the tongue stick to the other body
+    // Make the tongue stick to the other body. The spring pulling the player
+    // is applied while the tongue is attached (see add_pooled_body_forces()).
     if (player_info->tongue_status == DEPLOYED) {
-        create_spring(state->scene, TONGUE_ATTACHED_SPRING_CONSTANT, player,
-                      tongue_tip);
         body_set_mass(tongue_tip, INFINITY);
         body_set_velocity(tongue_tip, VEC_ZERO);
         player_info->tongue_status = ATTACHED;
@@ -164,32 +163,103 @@ void create_asymmetric_interaction_helper(
     }
 }
 
-void create_asymmetric_collision(scene_t *scene, body_t *body1, body_t *body2,
-                                 body_role_t expected_role_1,
-                                 body_role_t expected_role_2,
-                                 collision_handler_t handler, bool is_post_tick,
-                                 bool is_contact_collision,
-                                 bool is_full_collision, bool resolve_collision,
-                                 void *aux, free_func_t freer) {
-    body_role_t role1 = get_role(body1);
-    body_role_t role2 = get_role(body2);
-    if ((role1 & expected_role_1) && (role2 & expected_role_2)) {
-        if (handler) {
-            create_generic_collision(scene, body1, body2, handler, is_post_tick,
-                                     is_contact_collision, is_full_collision,
-                                     aux, freer);
+/**
+ * A row of the game's collision rule table.
+ * role1, role2 - the roles of the pairs of bodies the row applies to.
+ *      The body with role1 is passed to the handler first.
+ * handler - if non-NULL, called with the game state when the bodies collide
+ * is_contact_collision - if true, the handler is called on every tick that the
+ *      bodies overlap, instead of only when they start overlapping
+ * friction_coefficient - if non-zero, friction is applied between the bodies
+ * is_resolved - if true, the bodies are pushed apart after they tick
+ * is_continuous - if true, continuous bodies are stopped by the other side of
+ *      the row instead of passing through it
+ */
+typedef struct game_collision_rule {
+    body_role_t role1;
+    body_role_t role2;
+    collision_handler_t handler;
+    bool is_contact_collision;
+    double friction_coefficient;
+    bool is_resolved;
+    bool is_continuous;
+} game_collision_rule_t;
+
+/**
+ * Every interaction between the roles of the game. Pairs of roles that no row
+ * mentions (e.g. decorations and anything, or keys and walls) are never
+ * checked for collisions.
+ */
+const game_collision_rule_t GAME_COLLISION_RULES[] = {
+    // Friction forces
+    {.role1 = PLAYER, .role2 = WALL,
+     .friction_coefficient = FRICTION_COEFFICIENT},
+    // Trampolines bounce the player
+    {.role1 = PLAYER, .role2 = TRAMPOLINE,
+     .handler = (collision_handler_t)player_trampoline_collision_handler},
+    // Level winning for vent
+    {.role1 = PLAYER, .role2 = VENT,
+     .handler = (collision_handler_t)level_winning_collision_handler,
+     .is_contact_collision = true},
+    // Instant resolution collision with solids
+    // Only applies when one of the solids is non-stationary
+    {.role1 = SOLID & ~BULLET & ~CREWMATE,
+     .role2 = WALL | DOOR | DAMAGING_OBSTACLE | CREWMATE,
+     .is_resolved = true},
+    // Collisions marking player standing on the ground
+    {.role1 = PLAYER, .role2 = WALL | DOOR | DAMAGING_OBSTACLE | TRAMPOLINE,
+     .handler = (collision_handler_t)player_ground_collision_handler,
+     .is_contact_collision = true},
+    // Tongue tip attachment to pull player
+    {.role1 = TONGUE_TIP, .role2 = WALL | DOOR,
+     .handler = (collision_handler_t)tongue_tip_collision_handler,
+     .is_continuous = true},
+    // Damaging obstacles and bullets damage player
+    {.role1 = PLAYER, .role2 = DAMAGING_OBSTACLE | BULLET,
+     .handler = (collision_handler_t)damaged_body_damager_collision_handler,
+     .is_contact_collision = true, .is_resolved = true, .is_continuous = true},
+    // Tongue tip damages crewmates
+    {.role1 = CREWMATE, .role2 = TONGUE_TIP,
+     .handler = (collision_handler_t)damaged_body_damager_collision_handler,
+     .is_contact_collision = true, .is_resolved = true, .is_continuous = true},
+    // Bullets disappear on contact with solids
+    {.role1 = BULLET, .role2 = SOLID & ~CREWMATE,
+     .handler = (collision_handler_t)bullet_collision_handler,
+     .is_contact_collision = true, .is_continuous = true},
+    // Player collects keys
+    {.role1 = PLAYER, .role2 = KEY,
+     .handler = (collision_handler_t)player_key_collision_handler,
+     .is_contact_collision = true},
+    // Player opens doors (with keys)
+    {.role1 = PLAYER, .role2 = DOOR,
+     .handler = (collision_handler_t)player_door_collision_handler,
+     .is_contact_collision = true},
+};
+
+void add_collision_rules(state_t *state) {
+    size_t num_rules =
+        sizeof(GAME_COLLISION_RULES) / sizeof(GAME_COLLISION_RULES[0]);
+    for (size_t i = 0; i < num_rules; i++) {
+        const game_collision_rule_t *row = &GAME_COLLISION_RULES[i];
+        if (row->friction_coefficient != 0) {
+            create_friction_rule(state->scene, row->friction_coefficient,
+                                 row->role1, row->role2);
         }
-    } else if ((role1 & expected_role_2) && (role2 & expected_role_1)) {
-        if (handler) {
-            create_generic_collision(scene, body2, body1, handler, is_post_tick,
-                                     is_contact_collision, is_full_collision,
-                                     aux, freer);
+        if (row->handler) {
+            collision_rule_t rule = {
+                .layer1 = row->role1,
+                .layer2 = row->role2,
+                .handler = row->handler,
+                .is_post_tick = false,
+                .is_contact_collision = row->is_contact_collision,
+                .is_full_collision = false,
+                .is_continuous = row->is_continuous};
+            scene_add_collision_rule(state->scene, rule, state, NULL);
+        }
+        if (row->is_resolved) {
+            create_instant_resolution_collision_rule(state->scene, row->role1,
+                                                     row->role2);
         }
-    } else {
-        return;
-    }
-    if (resolve_collision) {
-        create_instant_resolution_collision(scene, body1, body2);
     }
 }
 
@@ -204,7 +274,7 @@ void create_asymmetric_collision(scene_t *scene, body_t *body1, body_t *body2,
 //     double wall_height = max_y - min_y;
 //     // left wall
 //     vector_t left_wall_pos = {.x = min_x, .y = body_get_centroid(trampoline).y};
-//     list_t *left_wall_shape = initialize_rectangle_anchored(
+//     polygon_t *left_wall_shape = initialize_rectangle_anchored(
 //         (anchor_option_t){.x_anchor = ANCHOR_MAX, .y_anchor = ANCHOR_CENTER},
 //         left_wall_pos, wall_width, wall_height);
 //     body_t *left_wall = body_init(left_wall_shape, TRAMPOLINE_SIDE_WALL_MASS,
@@ -212,7 +282,7 @@ void create_asymmetric_collision(scene_t *scene, body_t *body1, body_t *body2,
 //     // right wall
 //     vector_t right_wall_pos = {.x = max_x,
 //                                .y = body_get_centroid(trampoline).y};
-//     list_t *right_wall_shape = initialize_rectangle_anchored(
+//     polygon_t *right_wall_shape = initialize_rectangle_anchored(
 //         (anchor_option_t){.x_anchor = ANCHOR_MIN, .y_anchor = ANCHOR_CENTER},
 //         right_wall_pos, wall_width, wall_height);
 //     body_t *right_wall = body_init(right_wall_shape, TRAMPOLINE_SIDE_WALL_MASS,
@@ -222,84 +292,30 @@ void create_asymmetric_collision(scene_t *scene, body_t *body1, body_t *body2,
 //     scene_add_body(state->scene, right_wall);
 // }
 
+void set_body_collisions(body_t *body) {
+    body_role_t role = get_role(body);
+    // Bullets and the tongue tip are small and fast enough to pass through
+    // thin walls between ticks
+    body_set_continuous(body, role & (BULLET | TONGUE_TIP));
+    // Keys and vents are never pushed or pushed against, so their
+    // rectangles are enough to tell when the player touches them
+    body_set_sensor(body, role & SENSOR ? SENSOR_BOUNDING_BOX : SENSOR_NONE);
+    body_set_collision_layers(body, role);
+}
+
 void add_body_with_forces(state_t *state, body_t *new_body) {
-    body_role_t new_body_role = get_role(new_body);
-    if (new_body_role & (BULLET | TONGUE | TONGUE_TIP)) {
-        create_global_gravity(state->scene, BULLET_GRAVITY_ACCELERATION,
-                              new_body);
-    } else {
+    // Bullets and the tongue are pooled, and get their forces from
+    // add_pooled_body_forces() instead
+    assert(!(get_role(new_body) & (BULLET | TONGUE | TONGUE_TIP)));
+    // Static bodies never move, so gravity would have no effect on them
+    if (!body_is_static(new_body)) {
         create_global_gravity(state->scene, GRAVITY_ACCELERATION, new_body);
     }
 
-    if (new_body_role == PLAYER) {
+    if (get_role(new_body) == PLAYER) {
         create_drag(state->scene, PLAYER_DRAG_CONSTANT, new_body);
-    } else if (new_body_role & (TONGUE | TONGUE_TIP)) {
-        create_drag(state->scene, TONGUE_DRAG_CONSTANT, new_body);
     }
 
-    for (size_t i = 0; i < scene_bodies(state->scene); i++) {
-        body_t *old_body = scene_get_body(state->scene, i);
-        body_role_t old_body_role = get_role(old_body);
-        // Friction forces
-        if ((old_body_role | new_body_role) == (PLAYER | WALL)) {
-            create_friction(state->scene, FRICTION_COEFFICIENT, old_body,
-                            new_body);
-        }
-        if ((old_body_role | new_body_role) == (PLAYER | TRAMPOLINE)) {
-            trampoline_info_t *trampoline_info = old_body_role == TRAMPOLINE
-                ? body_get_info(old_body) : body_get_info(new_body);
-            double elasticity = trampoline_info->bounciness;
-            create_physics_collision(state->scene, elasticity, old_body,
-                                     new_body);
-        }
-        // Level winning for vent
-        create_asymmetric_collision(
-            state->scene, new_body, old_body, PLAYER, VENT,
-            (collision_handler_t)level_winning_collision_handler, false, true,
-            false, false, state, NULL);
-        // Instant resolution collision with solids
-        // Only do when one of the solids is non-stationary
-        create_asymmetric_collision(
-            state->scene, new_body, old_body, SOLID & ~BULLET & ~CREWMATE,
-            WALL | DOOR | VENT | DAMAGING_OBSTACLE | CREWMATE, NULL, false,
-            true, false, true, state, NULL);
-        // Collisions marking player standing on the ground
-        create_asymmetric_collision(
-            state->scene, new_body, old_body, PLAYER,
-            WALL | DOOR | DAMAGING_OBSTACLE | TRAMPOLINE,
-            (collision_handler_t)player_ground_collision_handler, false, true,
-            false, false, state, NULL);
-        // Tongue tip attachment to pull player
-        create_asymmetric_collision(
-            state->scene, new_body, old_body, TONGUE_TIP, WALL | DOOR,
-            (collision_handler_t)tongue_tip_collision_handler, false, false,
-            false, false, state, NULL);
-        // Damaging obstacles and bullets damage player
-        create_asymmetric_collision(
-            state->scene, new_body, old_body, PLAYER,
-            DAMAGING_OBSTACLE | BULLET,
-            (collision_handler_t)damaged_body_damager_collision_handler, false,
-            true, false, true, state, NULL);
-        // Tongue tip damages crewmates
-        create_asymmetric_collision(
-            state->scene, new_body, old_body, CREWMATE, TONGUE_TIP,
-            (collision_handler_t)damaged_body_damager_collision_handler, false,
-            true, false, true, state, NULL);
-        // Bullets disappear on contact with solids
-        create_asymmetric_collision(
-            state->scene, new_body, old_body, BULLET, SOLID & ~CREWMATE,
-            (collision_handler_t)bullet_collision_handler, false, true, false,
-            false, state, NULL);
-        // Player collects keys
-        create_asymmetric_collision(
-            state->scene, new_body, old_body, PLAYER, KEY,
-            (collision_handler_t)player_key_collision_handler, false, true,
-            false, false, state, NULL);
-        // Player opens doors (with keys)
-        create_asymmetric_collision(
-            state->scene, new_body, old_body, PLAYER, DOOR,
-            (collision_handler_t)player_door_collision_handler, false, true,
-            false, false, state, NULL);
-    }
+    set_body_collisions(new_body);
     scene_add_body(state->scene, new_body);
 }
@@ -141,7 +141,7 @@ void display_player_health(state_t *state, body_t *player) {
         // anchor to top left corner
         anchor_option_t anchor_option = {.x_anchor = ANCHOR_MIN,
                                          .y_anchor = ANCHOR_MAX};
-        list_t *heart_shape = initialize_rectangle_anchored(
+        polygon_t *heart_shape = initialize_rectangle_anchored(
             anchor_option,
             (vector_t){.x = WINDOW_MIN_X + HEART_PADDING_LEFT +
                             (HEART_SIZE + HEART_SPACING) * i,
@@ -159,7 +159,7 @@ void display_keys_collected(state_t *state, body_t *player) {
     for (size_t i = 0; i < list_size(keys_obtained); i++) {
         anchor_option_t anchor_option = {.x_anchor = ANCHOR_MIN,
                                          .y_anchor = ANCHOR_MAX};
-        list_t *key_box_shape = initialize_rectangle_anchored(
+        polygon_t *key_box_shape = initialize_rectangle_anchored(
             anchor_option,
             (vector_t){.x = WINDOW_MIN_X + KEY_BOX_PADDING_LEFT +
                             (KEY_BOX_SIZE + KEY_BOX_SPACING) * i,
@@ -180,7 +180,7 @@ void display_tongue_timer_progress_bar(state_t *state, body_t *player) {
                                                   .y_anchor = ANCHOR_MAX};
 
     // progress bar shell
-    list_t *progress_bar_shell_shape = initialize_rectangle_anchored(
+    polygon_t *progress_bar_shell_shape = initialize_rectangle_anchored(
         progress_bar_anchor_option,
         (vector_t){.x = WINDOW_MIN_X + PROGRESS_BAR_SHELL_PADDING_LEFT,
                    .y = WINDOW_MAX_Y - PROGRESS_BAR_SHELL_PADDING_TOP},
@@ -194,7 +194,7 @@ void display_tongue_timer_progress_bar(state_t *state, body_t *player) {
     if ((status == DEPLOYED) || (status == ATTACHED)) {
         progress_remaining_width = (curr_charge_time / TONGUE_DEPLOYMENT_TIME) *
                                    PROGRESS_BAR_INTERIOR_MAX_WIDTH;
-        list_t *progress_bar_timer_shape = initialize_rectangle_anchored(
+        polygon_t *progress_bar_timer_shape = initialize_rectangle_anchored(
             progress_bar_anchor_option,
             (vector_t){.x = WINDOW_MIN_X + PROGRESS_BAR_SHELL_PADDING_LEFT +
                             PROGRESS_BAR_INTERIOR_PADDING,
@@ -213,7 +213,7 @@ void display_tongue_timer_progress_bar(state_t *state, body_t *player) {
         } else {
             progress_remaining_width = PROGRESS_BAR_INTERIOR_MAX_WIDTH;
         }
-        list_t *progress_bar_timer_shape = initialize_rectangle_anchored(
+        polygon_t *progress_bar_timer_shape = initialize_rectangle_anchored(
             progress_bar_anchor_option,
             (vector_t){.x = WINDOW_MIN_X + PROGRESS_BAR_SHELL_PADDING_LEFT +
                             PROGRESS_BAR_INTERIOR_PADDING,
@@ -230,7 +230,7 @@ void display_current_game_level(state_t *state) {
     // anchor to top left corner
     anchor_option_t level_anchor_option = {.x_anchor = ANCHOR_MIN,
                                            .y_anchor = ANCHOR_MAX};
-    list_t *background_shape = initialize_rectangle_anchored(
+    polygon_t *background_shape = initialize_rectangle_anchored(
         level_anchor_option,
         (vector_t){.x = WINDOW_MIN_X + LEVEL_TEXT_PADDING_LEFT,
                    .y = WINDOW_MAX_Y - LEVEL_TEXT_PADDING_TOP},
@@ -257,7 +257,7 @@ void display_curr_level_time_elapsed(state_t *state) {
     // anchor to top right corner
     anchor_option_t anchor_option = {.x_anchor = ANCHOR_MAX,
                                      .y_anchor = ANCHOR_MAX};
-    list_t *timer_rect = initialize_rectangle_anchored(
+    polygon_t *timer_rect = initialize_rectangle_anchored(
         anchor_option,
         (vector_t){.x = WINDOW_MAX_X - LEVEL_TIMER_PADDING_RIGHT,
                    .y = WINDOW_MAX_Y - LEVEL_TIMER_PADDING_TOP},
@@ -310,48 +310,59 @@ load_level_button_info_t *load_level_button_info_init(char *normal_texture,
 void menu_mouse_handler(state_t *state, mouse_event_type_t type,
                         vector_t mouse_scene_pos,
                         vector_t mouse_prev_scene_pos) {
-    for (size_t i = 0; i < scene_bodies(state->menu_scene); i++) {
-        body_t *body = scene_get_body(state->menu_scene, i);
+    list_t *buttons = list_init(1, NULL);
+    // Buttons the mouse just left go back to normal
+    scene_query_point(state->menu_scene, mouse_prev_scene_pos, buttons);
+    for (size_t i = 0; i < list_size(buttons); i++) {
+        body_t *body = list_get(buttons, i);
         button_info_t *button_info = body_get_info(body);
-        if (button_info) {
-            if (bounding_box_contains_point(body_get_bounding_box(body),
-                                            mouse_scene_pos)) {
-                if (type == MOUSE_PRESSED) {
-                    body_set_img_texture(body, button_info->clicked_texture,
-                                         STRETCH_TO_FIT);
-                } else if (type == MOUSE_RELEASED) {
-                    switch (button_info->action) {
-                        case LOAD_LEVEL:
-                            state->curr_level =
-                                ((load_level_button_info_t *)button_info)
-                                    ->level;
-                            load_level(state);
-                            break;
-                        case GO_TO_MAIN_MENU:
-                            load_main_menu(state);
-                            break;
-                        case RESUME_GAME:
-                            sdl_resume_music();
-                            state->game_status = PLAYING;
-                            sdl_on_key(game_key_handler);
-                            sdl_on_mouse(game_mouse_handler);
-                            scene_clear(state->menu_scene);
-                            break;
-                        case GO_TO_LEVEL_SELECTION:
-                            load_level_selection_menu(state);
-                            break;
-                    }
-                } else if (type == MOUSE_MOVED) {
-                    body_set_img_texture(body, button_info->hover_texture,
-                                         STRETCH_TO_FIT);
-                }
-            } else if (bounding_box_contains_point(body_get_bounding_box(body),
-                                                   mouse_prev_scene_pos)) {
-                body_set_img_texture(body, button_info->normal_texture,
-                                     STRETCH_TO_FIT);
+        if (button_info &&
+            !bounding_box_contains_point(body_get_bounding_box(body),
+                                         mouse_scene_pos)) {
+            body_set_img_texture(body, button_info->normal_texture,
+                                 STRETCH_TO_FIT);
+        }
+    }
+    list_clear(buttons);
+    scene_query_point(state->menu_scene, mouse_scene_pos, buttons);
+    for (size_t i = 0; i < list_size(buttons); i++) {
+        body_t *body = list_get(buttons, i);
+        button_info_t *button_info = body_get_info(body);
+        if (!button_info) {
+            continue;
+        }
+        if (type == MOUSE_PRESSED) {
+            body_set_img_texture(body, button_info->clicked_texture,
+                                 STRETCH_TO_FIT);
+        } else if (type == MOUSE_RELEASED) {
+            switch (button_info->action) {
+                case LOAD_LEVEL:
+                    state->curr_level =
+                        ((load_level_button_info_t *)button_info)->level;
+                    load_level(state);
+                    break;
+                case GO_TO_MAIN_MENU:
+                    load_main_menu(state);
+                    break;
+                case RESUME_GAME:
+                    sdl_resume_music();
+                    state->game_status = PLAYING;
+                    sdl_on_key(game_key_handler);
+                    sdl_on_mouse(game_mouse_handler);
+                    scene_clear(state->menu_scene);
+                    break;
+                case GO_TO_LEVEL_SELECTION:
+                    load_level_selection_menu(state);
+                    break;
             }
+            // Every action replaces the menu, which frees the buttons found
+            break;
+        } else if (type == MOUSE_MOVED) {
+            body_set_img_texture(body, button_info->hover_texture,
+                                 STRETCH_TO_FIT);
         }
     }
+    list_free(buttons);
 }
 
 void menu_key_handler(state_t *state, unsigned char key, key_event_type_t type,
@@ -378,8 +389,9 @@ void menu_key_handler(state_t *state, unsigned char key, key_event_type_t type,
     }
 }
 
-list_t *create_button_shape(double padding_x, double padding_y, double spacing,
-                            size_t num_buttons, size_t index) {
+polygon_t *create_button_shape(double padding_x, double padding_y,
+                               double spacing, size_t num_buttons,
+                               size_t index) {
     anchor_option_t anchor_option = {.x_anchor = ANCHOR_MIN,
                                      .y_anchor = ANCHOR_MAX};
     double button_width = WINDOW_WIDTH - 2 * padding_x;
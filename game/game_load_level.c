@@ -13,6 +13,8 @@
 const int LEVEL_FILE_LINE_LENGTH = 1000;
 const int LEVEL_FILE_ARG_LENGTH = 500;
 const int ANCHOR_STR_LENGTH = 3; // 2 characters + null terminator
+// The vertex budget of a hull collision proxy, if the level doesn't give one
+const size_t DEFAULT_HULL_PROXY_VERTICES = 8;
 
 const char *LEVEL_FILE_DIR = "resources/levels/";
 
@@ -31,6 +33,22 @@ anchor_option_t parse_anchor_option(char *anchor_str) {
                                                      : ANCHOR_CENTER};
 }
 
+collision_proxy_t parse_collision_proxy(char *proxy_str) {
+    if (!strcmp(proxy_str, "hull")) {
+        return COLLISION_PROXY_HULL;
+    } else if (!strcmp(proxy_str, "aabb")) {
+        return COLLISION_PROXY_AABB;
+    } else if (!strcmp(proxy_str, "obb")) {
+        return COLLISION_PROXY_OBB;
+    } else if (!strcmp(proxy_str, "circle")) {
+        return COLLISION_PROXY_CIRCLE;
+    } else if (!strcmp(proxy_str, "capsule")) {
+        return COLLISION_PROXY_CAPSULE;
+    }
+    assert(!strcmp(proxy_str, "none"));
+    return COLLISION_PROXY_NONE;
+}
+
 /**
  * Reads a named argument from a line of arguments (from a .lvl file)
  *
@@ -118,8 +136,8 @@ bool get_named_argument_color(char *args, char *arg_name, rgba_color_t *result,
     }
 }
 
-bool get_named_argument_shape(char *args, char *arg_name, list_t **result,
-                              list_t *default_value) {
+bool get_named_argument_shape(char *args, char *arg_name, polygon_t **result,
+                              polygon_t *default_value) {
     char shape_str[LEVEL_FILE_ARG_LENGTH];
     char shape_type[LEVEL_FILE_ARG_LENGTH];
     char shape_args[LEVEL_FILE_ARG_LENGTH];
@@ -144,6 +162,15 @@ bool get_named_argument_shape(char *args, char *arg_name, list_t **result,
             *result =
                 initialize_star_anchored(parse_anchor_option(anchor_str), pos,
                                          num_arms, circumradius, inradius);
+        } else if (!strcmp(shape_type, "ellipse")) {
+            char anchor_str[ANCHOR_STR_LENGTH];
+            vector_t pos = {.x = 0, .y = 0};
+            double width, height;
+            size_t num_verts;
+            assert(sscanf(shape_args, "%[^,],%lf,%lf,%lf,%lf,%zu", anchor_str,
+                          &pos.x, &pos.y, &width, &height, &num_verts) == 6);
+            *result = initialize_ellipse_anchored(
+                parse_anchor_option(anchor_str), pos, width, height, num_verts);
         } else {
             // TODO: other shapes
             assert(false);
@@ -157,11 +184,12 @@ bool get_named_argument_shape(char *args, char *arg_name, list_t **result,
 
 void load_player_paparazzi(state_t *state) {
     assert(state->player);
-    list_t *paparazzi_shape = initialize_rectangle_centered(
+    polygon_t *paparazzi_shape = initialize_rectangle_centered(
         body_get_centroid(state->player), PAPARAZZI_WIDTH, PAPARAZZI_HEIGHT);
     body_t *player_paparazzi =
         body_init_with_info(paparazzi_shape, PAPARAZZI_MASS, PAPARAZZI_COLOR,
-                            body_info_init(PLAYER_PAPARAZZI), free);
+                            body_info_init(state->scene, PLAYER_PAPARAZZI),
+                            NULL);
     create_spring(state->scene, PLAYER_PAPARAZZI_SPRING_CONSTANT,
                   player_paparazzi, state->player);
     create_drag(state->scene, PLAYER_PAPARAZZI_DRAG_CONSTANT, player_paparazzi);
@@ -174,6 +202,8 @@ void load_level(state_t *state) {
     scene_clear(state->scene);
     scene_clear(state->hud_scene);
     scene_clear(state->menu_scene);
+    add_collision_rules(state);
+    add_pooled_body_forces(state);
     sdl_on_key(game_key_handler);
     sdl_on_mouse(game_mouse_handler);
     sdl_play_music(BACKGROUND_MUSIC_FILEPATH);
@@ -201,11 +231,12 @@ void load_level(state_t *state) {
                    &scene_boundary.max_y);
             state->scene_boundary = scene_boundary;
         } else if (!strcmp(command, "body")) {
-            free_func_t freer = free;
+            // Infos that own no other memory are freed with the level
+            free_func_t freer = NULL;
             // Role and shape are required
             char role[LEVEL_FILE_ARG_LENGTH];
             assert(get_named_argument(args, "role", role, 0));
-            list_t *shape;
+            polygon_t *shape;
             assert(get_named_argument_shape(args, "shape", &shape, NULL));
             double mass;
             get_named_argument_double(args, "mass", &mass, INFINITY);
@@ -234,9 +265,9 @@ void load_level(state_t *state) {
                 info = (body_info_t *)player_info_init(
                     health, invincibility_time, tongue_damage);
             } else if (!strcmp(role, "vent")) {
-                info = body_info_init(VENT);
+                info = body_info_init(state->scene, VENT);
             } else if (!strcmp(role, "wall")) {
-                info = body_info_init(WALL);
+                info = body_info_init(state->scene, WALL);
             } else if (!strcmp(role, "damaging_obstacle")) {
                 freer = (free_func_t)damaging_obstacle_info_free;
                 char *game_over_message =
@@ -248,7 +279,7 @@ void load_level(state_t *state) {
                                           &disappear_upon_player_collision, 0);
                 size_t damage;
                 assert(get_named_argument_size_t(args, "damage", &damage, 0));
-                list_t *trajectory_shape;
+                polygon_t *trajectory_shape;
                 // Default value NULL means the body doesn't have a trajectory
                 // to follow.
                 get_named_argument_shape(args, "trajectory_shape",
@@ -261,12 +292,13 @@ void load_level(state_t *state) {
                     DAMAGING_OBSTACLE, damage, trajectory_info,
                     (bool)disappear_upon_player_collision, game_over_message);
             } else if (!strcmp(role, "crewmate")) {
+                freer = (free_func_t)crewmate_info_free;
                 size_t health;
                 assert(get_named_argument_size_t(args, "health", &health, 0));
                 double invincibility_time;
                 assert(get_named_argument_double(args, "invincibility_time",
                                                  &invincibility_time, 0));
-                list_t *trajectory_shape;
+                polygon_t *trajectory_shape;
                 get_named_argument_shape(args, "trajectory_shape",
                                          &trajectory_shape, NULL);
                 double speed;
@@ -279,8 +311,10 @@ void load_level(state_t *state) {
                 size_t damage_per_bullet;
                 assert(get_named_argument_size_t(args, "damage_per_bullet",
                                                  &damage_per_bullet, 0));
-                char *game_over_message =
-                    malloc(sizeof(char) * LEVEL_FILE_LINE_LENGTH);
+                // Bullets the crewmate fired still use its message after it
+                // is removed, so the message lasts as long as the level
+                char *game_over_message = scene_alloc(
+                    state->scene, sizeof(char) * LEVEL_FILE_LINE_LENGTH);
                 get_named_argument_str(args, "game_over_message",
                                        game_over_message, GAME_OVER_MESSAGE);
                 size_t facing_left;
@@ -289,28 +323,48 @@ void load_level(state_t *state) {
                     health, invincibility_time, trajectory_info, reload_time,
                     damage_per_bullet, game_over_message, (bool)facing_left);
             } else if (!strcmp(role, "decoration")) {
-                info = body_info_init(DECORATION);
+                info = body_info_init(state->scene, DECORATION);
             } else if (!strcmp(role, "key")) {
                 size_t id;
                 assert(get_named_argument_size_t(args, "id", &id, 0));
                 get_named_argument(args, "texture", texture_filename,
                                    KEY_IMAGES[id]);
-                info = (body_info_t *)key_and_door_info_init(KEY, id);
+                info = (body_info_t *)key_and_door_info_init(state->scene,
+                                                             KEY, id);
             } else if (!strcmp(role, "door")) {
                 size_t id;
                 assert(get_named_argument_size_t(args, "id", &id, 0));
                 get_named_argument_color(args, "color", &color,
                                          DOOR_COLORS[id]);
-                info = (body_info_t *)key_and_door_info_init(DOOR, id);
+                info = (body_info_t *)key_and_door_info_init(state->scene,
+                                                             DOOR, id);
             } else if (!strcmp(role, "trampoline")) {
                 double bounciness;
                 assert(get_named_argument_double(args, "bounciness",
                                                  &bounciness, 0));
-                info = (body_info_t *)trampoline_info_init(bounciness);
+                info = (body_info_t *)trampoline_info_init(state->scene,
+                                                           bounciness);
             } else {
                 assert(false);
             }
             body_t *body = body_init_with_info(shape, mass, color, info, freer);
+            // Detailed shapes can collide as a simpler polygon
+            char proxy_str[LEVEL_FILE_ARG_LENGTH];
+            get_named_argument(args, "collision_proxy", proxy_str, "none");
+            size_t proxy_vertices;
+            get_named_argument_size_t(args, "collision_proxy_vertices",
+                                      &proxy_vertices,
+                                      DEFAULT_HULL_PROXY_VERTICES);
+            body_set_collision_proxy(body, parse_collision_proxy(proxy_str),
+                                     proxy_vertices);
+            // Bodies with infinite mass that don't follow a trajectory never
+            // move, so the scene doesn't need to tick them
+            bool has_trajectory =
+                (get_role(body) & (CREWMATE | DAMAGING_OBSTACLE)) &&
+                get_trajectory(body);
+            if (mass == INFINITY && !has_trajectory) {
+                body_set_static(body, true);
+            }
             if (strlen(texture_filename) > 0) {
                 body_set_img_texture(body, texture_filename,
                                      texture_render_option);
@@ -0,0 +1,146 @@
+#include "game_pools.h"
+#include "game_body_info.h"
+#include "game_constants.h"
+#include "game_forces.h"
+#include "polygon.h"
+#include <assert.h>
+#include <stdlib.h>
+
+/**
+ * A body of a pool, which is given to the body as its release handler's aux
+ * so the pool can take it back in constant time.
+ */
+typedef struct pool_slot {
+    struct body_pool *pool;
+    body_t *body;
+    bool is_in_use;
+} pool_slot_t;
+
+/**
+ * slots - the bodies of the pool. The array never moves, since the bodies
+ *      point into it.
+ * free_slots - a stack of the indices of the slots that aren't in use
+ */
+struct body_pool {
+    pool_slot_t *slots;
+    size_t size;
+    size_t capacity;
+    size_t *free_slots;
+    size_t num_free_slots;
+};
+
+body_pool_t *body_pool_init(size_t capacity) {
+    body_pool_t *pool = malloc(sizeof(body_pool_t));
+    assert(pool);
+    pool->slots = malloc(capacity * sizeof(pool_slot_t));
+    pool->free_slots = malloc(capacity * sizeof(size_t));
+    assert(pool->slots && pool->free_slots);
+    pool->size = 0;
+    pool->capacity = capacity;
+    pool->num_free_slots = 0;
+    return pool;
+}
+
+void body_pool_free(body_pool_t *pool) {
+    assert(pool->num_free_slots == pool->size);
+    for (size_t i = 0; i < pool->size; i++) {
+        body_free(pool->slots[i].body);
+    }
+    free(pool->slots);
+    free(pool->free_slots);
+    free(pool);
+}
+
+/**
+ * Helper function.
+ * The release handler of pooled bodies, which puts a body back in its pool.
+ */
+void return_to_pool(body_t *body, pool_slot_t *slot) {
+    assert(slot->is_in_use);
+    body_pool_t *pool = slot->pool;
+    slot->is_in_use = false;
+    pool->free_slots[pool->num_free_slots] = slot - pool->slots;
+    pool->num_free_slots++;
+}
+
+void body_pool_add(body_pool_t *pool, body_t *body) {
+    assert(pool->size < pool->capacity);
+    pool_slot_t *slot = &pool->slots[pool->size];
+    *slot = (pool_slot_t){.pool = pool, .body = body, .is_in_use = false};
+    body_set_release_handler(body, (body_release_handler_t)return_to_pool,
+                             slot);
+    pool->free_slots[pool->num_free_slots] = pool->size;
+    pool->num_free_slots++;
+    pool->size++;
+}
+
+body_t *body_pool_take(body_pool_t *pool) {
+    if (pool->num_free_slots == 0) {
+        return NULL;
+    }
+    pool->num_free_slots--;
+    pool_slot_t *slot = &pool->slots[pool->free_slots[pool->num_free_slots]];
+    slot->is_in_use = true;
+    return slot->body;
+}
+
+bool body_pool_take_all(body_pool_t *pool) {
+    if (pool->num_free_slots < pool->size) {
+        return false;
+    }
+    for (size_t i = 0; i < pool->size; i++) {
+        pool->slots[i].is_in_use = true;
+    }
+    pool->num_free_slots = 0;
+    return true;
+}
+
+size_t body_pool_size(body_pool_t *pool) {
+    return pool->size;
+}
+
+body_t *body_pool_get(body_pool_t *pool, size_t index) {
+    assert(index < pool->size);
+    return pool->slots[index].body;
+}
+
+bool body_pool_is_in_use(body_pool_t *pool, size_t index) {
+    assert(index < pool->size);
+    return pool->slots[index].is_in_use;
+}
+
+void init_body_pools(state_t *state) {
+    state->bullet_pool = body_pool_init(BULLET_POOL_SIZE);
+    for (size_t i = 0; i < BULLET_POOL_SIZE; i++) {
+        // The damage and message are the ones of the crewmate firing it
+        damaging_obstacle_info_t *bullet_info =
+            damaging_obstacle_info_init(BULLET, 0, NULL, true, NULL);
+        body_t *bullet = body_init_with_info(
+            initialize_rectangle_centered(VEC_ZERO, BULLET_WIDTH,
+                                          BULLET_HEIGHT),
+            BULLET_MASS, BULLET_COLOR, bullet_info, free);
+        // Bullets collide as the circle around their square, which is cheaper
+        body_set_collision_proxy(bullet, COLLISION_PROXY_CIRCLE, 0);
+        set_body_collisions(bullet);
+        body_pool_add(state->bullet_pool, bullet);
+    }
+    // The pieces are in order from the player's mouth to the tip
+    state->tongue_pool = body_pool_init(TONGUE_NUM_PIECES);
+    for (size_t i = 0; i < TONGUE_NUM_PIECES; i++) {
+        body_info_t *tongue_info =
+            i == TONGUE_NUM_PIECES - 1
+                ? (body_info_t *)damaging_body_info_init(NULL, TONGUE_TIP, 0)
+                : body_info_init(NULL, TONGUE);
+        body_t *tongue_piece = body_init_with_info(
+            initialize_rectangle_centered(VEC_ZERO, TONGUE_WIDTH,
+                                          TONGUE_WIDTH),
+            TONGUE_PIECE_MASS, TONGUE_COLOR, tongue_info, free);
+        set_body_collisions(tongue_piece);
+        body_pool_add(state->tongue_pool, tongue_piece);
+    }
+}
+
+void free_body_pools(state_t *state) {
+    body_pool_free(state->bullet_pool);
+    body_pool_free(state->tongue_pool);
+}
@@ -5,10 +5,10 @@
 /**
  * A timer that performs some action on a state after a given time has passed.
 */
-typedef struct game_timer {
+struct game_timer {
     double time_left;
     state_func_t action;
-} game_timer_t;
+};
 
 /**
  * Initializes a timer.
@@ -24,19 +24,20 @@ game_timer_t *game_timer_init(double time, state_func_t action) {
  * Adds a timer to a state's list of timers.
 */
 void add_timer(state_t *state, double time, state_func_t action) {
-    list_add(state->timers, game_timer_init(time, action));
+    timer_array_add(state->timers, game_timer_init(time, action));
 }
 
 /**
  * Updates all the timers in a state. When some timer's time reaches 0,
- * it is removed and its action is performed.
+ * it is removed and its action is performed. The timers are independent, so
+ * the last one takes the removed one's place instead of all of them moving.
 */
 void handle_timers(state_t *state, double dt) {
-    for (size_t i = 0; i < list_size(state->timers); i++) {
-        game_timer_t *timer = list_get(state->timers, i);
+    for (size_t i = 0; i < timer_array_size(state->timers); i++) {
+        game_timer_t *timer = timer_array_get(state->timers, i);
         timer->time_left -= dt;
         if (timer->time_left <= 0) {
-            list_remove(state->timers, i);
+            timer_array_swap_remove(state->timers, i);
             i--;
             timer->action(state);
             free(timer);
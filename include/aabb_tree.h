@@ -0,0 +1,132 @@
+#ifndef __AABB_TREE_H__
+#define __AABB_TREE_H__
+
+#include "bounding_box.h"
+#include "vector.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * A dynamic bounding volume hierarchy over axis-aligned bounding boxes.
+ * Each leaf stores a user value with a "fat" bounding box, grown by a margin
+ * so that small movements don't require changing the tree. Internal nodes
+ * enclose their two children, and the tree is kept balanced with rotations
+ * as leaves are inserted, so queries take O(log N + k) time.
+ */
+typedef struct aabb_tree aabb_tree_t;
+
+/**
+ * A function called for every leaf found by a query.
+ *
+ * @param data the value stored in the leaf
+ * @param aux the auxiliary value passed to the query
+ * @return true to continue the query, false to stop it
+ */
+typedef bool (*aabb_tree_query_callback_t)(void *data, void *aux);
+
+/**
+ * Allocates memory for an empty tree.
+ *
+ * @param margin how much larger than the given bounding boxes the fat
+ *      bounding boxes of the leaves are, on every side
+ * @return the new tree
+ */
+aabb_tree_t *aabb_tree_init(double margin);
+
+/**
+ * Releases the memory allocated for a tree. Does not free the stored values.
+ *
+ * @param tree a pointer to a tree returned from aabb_tree_init()
+ */
+void aabb_tree_free(aabb_tree_t *tree);
+
+/**
+ * Removes all leaves from a tree.
+ *
+ * @param tree a pointer to a tree returned from aabb_tree_init()
+ */
+void aabb_tree_clear(aabb_tree_t *tree);
+
+/**
+ * Inserts a leaf into a tree.
+ *
+ * @param tree a pointer to a tree returned from aabb_tree_init()
+ * @param bbox the bounding box of the value
+ * @param data the value to store in the leaf
+ * @return the id of the leaf, valid until it is removed
+ */
+size_t aabb_tree_insert(aabb_tree_t *tree, bounding_box_t bbox, void *data);
+
+/**
+ * Removes a leaf from a tree. Asserts that the id is a leaf in the tree.
+ *
+ * @param tree a pointer to a tree returned from aabb_tree_init()
+ * @param leaf the id returned by aabb_tree_insert()
+ */
+void aabb_tree_remove(aabb_tree_t *tree, size_t leaf);
+
+/**
+ * Updates the bounding box of a leaf. The tree is only changed if the new
+ * bounding box is no longer inside the leaf's fat bounding box.
+ *
+ * @param tree a pointer to a tree returned from aabb_tree_init()
+ * @param leaf the id returned by aabb_tree_insert()
+ * @param bbox the new bounding box of the value
+ * @return true if the leaf had to be reinserted
+ */
+bool aabb_tree_move(aabb_tree_t *tree, size_t leaf, bounding_box_t bbox);
+
+/**
+ * Gets the fat bounding box of a leaf.
+ *
+ * @param tree a pointer to a tree returned from aabb_tree_init()
+ * @param leaf the id returned by aabb_tree_insert()
+ * @return the bounding box the leaf is stored with in the tree
+ */
+bounding_box_t aabb_tree_get_fat_bounding_box(aabb_tree_t *tree, size_t leaf);
+
+/**
+ * Gets the height of a tree, for testing how well balanced it is.
+ *
+ * @param tree a pointer to a tree returned from aabb_tree_init()
+ * @return 0 for an empty tree or a single leaf, else the length of the longest
+ *      path from the root to a leaf
+ */
+size_t aabb_tree_get_height(aabb_tree_t *tree);
+
+/**
+ * Calls a callback for every leaf whose fat bounding box overlaps a region.
+ *
+ * @param tree a pointer to a tree returned from aabb_tree_init()
+ * @param region the region to search
+ * @param callback the function to call for each leaf found
+ * @param aux an auxiliary value to pass to the callback
+ */
+void aabb_tree_query_region(aabb_tree_t *tree, bounding_box_t region,
+                            aabb_tree_query_callback_t callback, void *aux);
+
+/**
+ * Calls a callback for every leaf whose fat bounding box contains a point.
+ *
+ * @param tree a pointer to a tree returned from aabb_tree_init()
+ * @param point the point to search at
+ * @param callback the function to call for each leaf found
+ * @param aux an auxiliary value to pass to the callback
+ */
+void aabb_tree_query_point(aabb_tree_t *tree, vector_t point,
+                           aabb_tree_query_callback_t callback, void *aux);
+
+/**
+ * Calls a callback for every leaf whose fat bounding box is crossed by a line
+ * segment.
+ *
+ * @param tree a pointer to a tree returned from aabb_tree_init()
+ * @param start one end of the segment
+ * @param end the other end of the segment
+ * @param callback the function to call for each leaf found
+ * @param aux an auxiliary value to pass to the callback
+ */
+void aabb_tree_query_segment(aabb_tree_t *tree, vector_t start, vector_t end,
+                             aabb_tree_query_callback_t callback, void *aux);
+
+#endif // #ifndef __AABB_TREE_H__
@@ -0,0 +1,67 @@
+#ifndef __ARENA_H__
+#define __ARENA_H__
+
+#include <stddef.h>
+
+/**
+ * A region of memory that many small objects are allocated from, and that
+ * frees them all at once.
+ * Objects are never freed individually: their memory is reclaimed when the
+ * arena is reset, which keeps the arena's memory to be reused by the next
+ * objects allocated from it.
+ */
+typedef struct arena arena_t;
+
+/**
+ * Allocates memory for an empty arena.
+ *
+ * @param chunk_size the number of bytes the arena requests from the system at
+ *   a time. Larger objects get a chunk of their own.
+ * @return the new arena
+ */
+arena_t *arena_init(size_t chunk_size);
+
+/**
+ * Releases the memory of an arena and all the objects allocated from it.
+ *
+ * @param arena a pointer to an arena returned from arena_init()
+ */
+void arena_free(arena_t *arena);
+
+/**
+ * Allocates memory for an object from an arena.
+ * The memory is aligned for any type, and is not initialized.
+ *
+ * @param arena a pointer to an arena returned from arena_init()
+ * @param size the number of bytes to allocate
+ * @return a pointer to the memory, valid until the arena is reset or freed
+ */
+void *arena_alloc(arena_t *arena, size_t size);
+
+/**
+ * Frees every object allocated from an arena, in constant time.
+ * The arena keeps its memory, so allocating the same objects again doesn't
+ * request any more from the system.
+ *
+ * @param arena a pointer to an arena returned from arena_init()
+ */
+void arena_reset(arena_t *arena);
+
+/**
+ * Gets the number of bytes allocated from an arena since it was last reset,
+ * including the padding between objects.
+ *
+ * @param arena a pointer to an arena returned from arena_init()
+ * @return the number of bytes in use
+ */
+size_t arena_bytes_used(arena_t *arena);
+
+/**
+ * Gets the number of bytes an arena has requested from the system.
+ *
+ * @param arena a pointer to an arena returned from arena_init()
+ * @return the total size of the arena's chunks
+ */
+size_t arena_bytes_reserved(arena_t *arena);
+
+#endif // #ifndef __ARENA_H__
@@ -0,0 +1,112 @@
+#ifndef __ARRAY_H__
+#define __ARRAY_H__
+
+#include <assert.h>
+#include <stdlib.h>
+
+/**
+ * Defines a growable array of values of one type, name_t, along with the
+ * functions that use it, which are all inline:
+ *
+ * name_t *name_init(size_t initial_capacity)
+ * void name_free(name_t *array)
+ * size_t name_size(name_t *array)
+ * type name_get(name_t *array, size_t index)
+ * void name_set(name_t *array, size_t index, type value)
+ * void name_add(name_t *array, type value)
+ * void name_reserve(name_t *array, size_t capacity)
+ * void name_clear(name_t *array)
+ * void name_truncate(name_t *array, size_t size)
+ * type name_remove(name_t *array, size_t index)
+ * type name_swap_remove(name_t *array, size_t index)
+ *
+ * Unlike a list_t, the array holds the values themselves rather than void
+ * pointers, and never frees them: freeing the values the array holds is up to
+ * its user. name_remove() keeps the order of the other values, moving all the
+ * values after the removed one. name_swap_remove() moves the last value into
+ * the removed one's place instead, in constant time. To remove many values at
+ * once in order, the values to keep can be moved towards the front with
+ * name_set() in one pass and the rest dropped with name_truncate().
+ * Indices are only checked with assert().
+ *
+ * For example, DEFINE_ARRAY(body_array, body_t *) defines body_array_t and
+ * body_array_add(), body_array_get(), etc.
+ */
+#define DEFINE_ARRAY(name, type)                                              \
+    typedef struct name {                                                     \
+        type *data;                                                           \
+        size_t size;                                                          \
+        size_t capacity;                                                      \
+    } name##_t;                                                               \
+                                                                              \
+    static inline void name##_reserve(name##_t *array, size_t capacity) {     \
+        if (capacity <= array->capacity) {                                    \
+            return;                                                           \
+        }                                                                     \
+        array->data = realloc(array->data, capacity * sizeof(type));          \
+        assert(array->data);                                                  \
+        array->capacity = capacity;                                           \
+    }                                                                         \
+                                                                              \
+    static inline name##_t *name##_init(size_t initial_capacity) {            \
+        name##_t *array = malloc(sizeof(name##_t));                           \
+        assert(array);                                                        \
+        *array = (name##_t){.data = NULL, .size = 0, .capacity = 0};          \
+        name##_reserve(array, initial_capacity > 0 ? initial_capacity : 1);   \
+        return array;                                                         \
+    }                                                                         \
+                                                                              \
+    static inline void name##_free(name##_t *array) {                         \
+        free(array->data);                                                    \
+        free(array);                                                          \
+    }                                                                         \
+                                                                              \
+    static inline size_t name##_size(name##_t *array) {                       \
+        return array->size;                                                   \
+    }                                                                         \
+                                                                              \
+    static inline type name##_get(name##_t *array, size_t index) {            \
+        assert(index < array->size);                                          \
+        return array->data[index];                                            \
+    }                                                                         \
+                                                                              \
+    static inline void name##_set(name##_t *array, size_t index,              \
+                                  type value) {                               \
+        assert(index < array->size);                                          \
+        array->data[index] = value;                                           \
+    }                                                                         \
+                                                                              \
+    static inline void name##_add(name##_t *array, type value) {              \
+        if (array->size == array->capacity) {                                 \
+            name##_reserve(array, 2 * array->capacity);                       \
+        }                                                                     \
+        array->data[array->size] = value;                                     \
+        array->size++;                                                        \
+    }                                                                         \
+                                                                              \
+    static inline void name##_clear(name##_t *array) {                        \
+        array->size = 0;                                                      \
+    }                                                                         \
+                                                                              \
+    static inline void name##_truncate(name##_t *array, size_t size) {        \
+        assert(size <= array->size);                                          \
+        array->size = size;                                                   \
+    }                                                                         \
+                                                                              \
+    static inline type name##_remove(name##_t *array, size_t index) {         \
+        type value = name##_get(array, index);                                \
+        array->size--;                                                        \
+        for (size_t i = index; i < array->size; i++) {                        \
+            array->data[i] = array->data[i + 1];                              \
+        }                                                                     \
+        return value;                                                         \
+    }                                                                         \
+                                                                              \
+    static inline type name##_swap_remove(name##_t *array, size_t index) {    \
+        type value = name##_get(array, index);                                \
+        array->size--;                                                        \
+        array->data[index] = array->data[array->size];                        \
+        return value;                                                         \
+    }
+
+#endif // #ifndef __ARRAY_H__
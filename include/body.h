@@ -1,6 +1,7 @@
 #ifndef __BODY_H__
 #define __BODY_H__
 
+#include "array.h"
 #include "collision.h"
 #include "color.h"
 #include "list.h"
@@ -8,6 +9,7 @@
 #include "utils.h"
 #include "vector.h"
 #include <stdbool.h>
+#include <stdint.h>
 
 /**
  * A rigid body constrained to the plane.
@@ -17,24 +19,84 @@
  */
 typedef struct body body_t;
 
+/**
+ * A growable array of pointers to bodies (see array.h).
+ */
+DEFINE_ARRAY(body_array, body_t *)
+
+/**
+ * Contiguous storage for the motion state of many bodies: their centroids,
+ * velocities, accelerations, accumulated forces and impulses, masses,
+ * orientations and angular velocities, each in its own array. The bodies in
+ * a store can all be integrated in one linear pass over the arrays (see
+ * body_store_integrate()). Scenes keep their dynamic bodies in a store.
+ * A body that isn't in a store keeps its motion state to itself.
+ */
+typedef struct body_store body_store_t;
+
 /**
  * A function called when we want to determine a property of the body that is
  * used outside of the physics engine.
  */
 typedef bool (*body_predicate_t)(body_t *body);
 
+/**
+ * A function that takes back a body when a scene is done with it, in place of
+ * freeing it (see body_set_release_handler()).
+ */
+typedef void (*body_release_handler_t)(body_t *body, void *aux);
+
+/**
+ * A simpler polygon that a body collides with in place of its shape,
+ * made from the shape when it is set (see body_set_collision_proxy()).
+ * COLLISION_PROXY_NONE - the body collides with its shape
+ * COLLISION_PROXY_HULL - the convex hull of the shape, with a vertex budget
+ * COLLISION_PROXY_AABB - the axis-aligned bounding box of the shape
+ * COLLISION_PROXY_OBB - the smallest rotated rectangle containing the shape
+ * COLLISION_PROXY_CIRCLE - the smallest circle around the centroid containing
+ *      the shape
+ * COLLISION_PROXY_CAPSULE - the oriented bounding box, with its short sides
+ *      rounded off
+ * Circles and capsules are checked for collisions in closed form (see
+ * find_collision_capsules()), instead of vertex by vertex.
+ */
+typedef enum {
+    COLLISION_PROXY_NONE,
+    COLLISION_PROXY_HULL,
+    COLLISION_PROXY_AABB,
+    COLLISION_PROXY_OBB,
+    COLLISION_PROXY_CIRCLE,
+    COLLISION_PROXY_CAPSULE
+} collision_proxy_t;
+
+/**
+ * Whether a body is a sensor, and how it is checked for overlaps
+ * (see body_set_sensor()).
+ * SENSOR_NONE - the body is not a sensor
+ * SENSOR_BOUNDING_BOX - the body overlaps bodies whose bounding boxes overlap
+ *      its bounding box, without checking their shapes
+ * SENSOR_SHAPE - the body's shape is checked once the bounding boxes overlap,
+ *      like any other body
+ */
+typedef enum {
+    SENSOR_NONE,
+    SENSOR_BOUNDING_BOX,
+    SENSOR_SHAPE
+} sensor_mode_t;
+
 /**
  * Initializes a body without any info.
  * Acts like body_init_with_info() where info and info_freer are NULL.
  */
-body_t *body_init(list_t *shape, double mass, rgba_color_t color);
+body_t *body_init(polygon_t *shape, double mass, rgba_color_t color);
 
 /**
  * Allocates memory for a body with the given parameters.
  * The body is initially at rest.
  * Asserts that the mass is positive and that the required memory is allocated.
  *
- * @param shape a list of vectors describing the initial shape of the body
+ * @param shape the initial shape of the body, which the body takes ownership
+ *   of
  * @param mass the mass of the body (if INFINITY, stops the body from moving)
  * @param color the color of the body, used to draw it on the screen
  * @param info additional information to associate with the body,
@@ -42,7 +104,7 @@ body_t *body_init(list_t *shape, double mass, rgba_color_t color);
  * @param info_freer if non-NULL, a function call on the info to free it
  * @return a pointer to the newly allocated body
  */
-body_t *body_init_with_info(list_t *shape, double mass, rgba_color_t color,
+body_t *body_init_with_info(polygon_t *shape, double mass, rgba_color_t color,
                             void *info, free_func_t info_freer);
 
 /**
@@ -54,12 +116,62 @@ void body_free(body_t *body);
 
 /**
  * Gets the current shape of a body.
- * Returns a newly allocated vector list, which must be list_free()d.
+ * Returns a newly allocated polygon, which must be polygon_free()d.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the polygon describing the body's current position
+ */
+polygon_t *body_get_shape(body_t *body);
+
+/**
+ * Gets the current shape of a body without copying it.
+ * The polygon belongs to the body and must not be modified or freed.
+ * It is only valid until the body is next moved, rotated, given a new
+ * collision proxy, or freed, so use body_get_shape() to keep a shape.
  *
  * @param body a pointer to a body returned from body_init()
  * @return the polygon describing the body's current position
  */
-list_t *body_get_shape(body_t *body);
+const polygon_t *body_borrow_shape(body_t *body);
+
+/**
+ * Places a body's vertices and edge normals at its current position and
+ * orientation, and recomputes its bounding box if it rotated. A body only
+ * stores its shape in local space, and moving it doesn't touch its vertices:
+ * they are placed the first time they are used after it moves. Call this
+ * before using a body from several threads at once.
+ *
+ * @param body a pointer to a body returned from body_init()
+ */
+void body_update_shape(body_t *body);
+
+/**
+ * Gets the number of distinct local-space shapes that bodies are made of.
+ * Bodies made from the same polygon, even at different positions, share one
+ * copy of it. A shape is freed with the last body made of it.
+ *
+ * @return the number of shapes in use
+ */
+size_t body_shape_prototypes(void);
+
+/**
+ * Gets the polygon a body collides with: its collision proxy if it has one
+ * (see body_set_collision_proxy()), or else its shape.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return a copy of the polygon. The caller owns it.
+ */
+polygon_t *body_get_collision_shape(body_t *body);
+
+/**
+ * Gets the polygon a body collides with without copying it.
+ * Like body_borrow_shape(), it must not be modified or freed, and is only
+ * valid until the body next changes.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the body's collision proxy, or else its shape
+ */
+const polygon_t *body_borrow_collision_shape(body_t *body);
 
 /**
  * Gets the current center of mass of a body.
@@ -108,6 +220,8 @@ texture_wrapper_t *body_get_texture(body_t *body);
 /**
  * Gets the bounding box of a body. In other words, gets the rectangular region
  * that fully encloses the body's shape.
+ * The bounding box is stored in the body and moved along with it, so this is
+ * cheap to call. After the body rotates, it is recomputed on the next call.
  *
  * @param body a pointer to a body returned from body_init()
  * @return the bounding box of a body
@@ -237,12 +351,74 @@ void body_add_impulse(body_t *body, vector_t impulse);
  * The body should be translated at the *average* of the velocities before
  * and after the tick.
  * Resets the forces and impulses accumulated on the body.
+ * Static bodies (see body_set_static()) are not moved.
  *
  * @param body the body to tick
  * @param dt the number of seconds elapsed since the last tick
  */
 void body_tick(body_t *body, double dt);
 
+/**
+ * Moves a body by the displacement and rotation that body_store_integrate()
+ * computed for it, as body_tick() would have.
+ *
+ * @param body a body in a store that has been integrated
+ */
+void body_apply_integration(body_t *body);
+
+/**
+ * Allocates memory for an empty body store.
+ *
+ * @return the new store
+ */
+body_store_t *body_store_init(void);
+
+/**
+ * Moves the bodies still in a store out of it, and releases the store's
+ * memory. The bodies are not freed.
+ *
+ * @param store a pointer to a store returned from body_store_init()
+ */
+void body_store_free(body_store_t *store);
+
+/**
+ * Gets the number of bodies in a store.
+ *
+ * @param store a pointer to a store returned from body_store_init()
+ * @return the number of bodies added and not removed
+ */
+size_t body_store_size(body_store_t *store);
+
+/**
+ * Moves a body's motion state into a store. Asserts that the body isn't
+ * already in a store. The body behaves the same, but its state is kept with
+ * the state of the other bodies in the store.
+ *
+ * @param store a pointer to a store returned from body_store_init()
+ * @param body the body to add
+ */
+void body_store_add(body_store_t *store, body_t *body);
+
+/**
+ * Moves a body's motion state out of the store it is in, if any.
+ * The last body in the store takes its place. Bodies are removed from their
+ * store when they are freed.
+ *
+ * @param body the body to remove
+ */
+void body_store_remove(body_t *body);
+
+/**
+ * Integrates the motion of every body in a store over a tick, like
+ * body_tick() but without moving them: sets their velocities and
+ * accelerations, resets their forces and impulses, and records how far each
+ * should move. Each body is then moved with body_apply_integration().
+ *
+ * @param store a pointer to a store returned from body_store_init()
+ * @param dt the number of seconds elapsed since the last tick
+ */
+void body_store_integrate(body_store_t *store, double dt);
+
 /**
  * Copy the contents of a body_t object.
  * @param body a pointer to a solid body
@@ -257,7 +433,7 @@ body_t *body_copy(body_t *body);
  * @param dt the time that passed
  * @return a polygon representing the shape of the future body
  */
-list_t *future_body_trans_rot(body_t *body, double dt);
+polygon_t *future_body_trans_rot(body_t *body, double dt);
 
 /**
  * Returns the shape of the body as if it was ticked, but only the translational
@@ -266,7 +442,7 @@ list_t *future_body_trans_rot(body_t *body, double dt);
  * @param dt the time that passed
  * @return a polygon representing the shape of the future body
  */
-list_t *future_body_translational(body_t *body, double dt);
+polygon_t *future_body_translational(body_t *body, double dt);
 
 /**
  * Returns the shape of the body as if it was ticked, but only the rotational
@@ -275,10 +451,14 @@ list_t *future_body_translational(body_t *body, double dt);
  * @param dt the time that passed
  * @return a polygon representing the shape of the future body
  */
-list_t *future_body_rotational(body_t *body, double dt);
+polygon_t *future_body_rotational(body_t *body, double dt);
 
 /**
  * Detects a collision between two bodies.
+ * Bodies whose bounding boxes don't overlap are rejected without running the
+ * full collision check. Each body remembers its last few results, so checking
+ * the same pair again, in either order, is free until one of the bodies moves
+ * or rotates.
  * @param body1 the first body
  * @param body2 the second body
  * @return a collision_info_t struct that tells if the bodies collided and if
@@ -286,6 +466,63 @@ list_t *future_body_rotational(body_t *body, double dt);
  */
 collision_info_t detect_body_collision(body_t *body1, body_t *body2);
 
+/**
+ * Detects a collision between two bodies, first testing an axis that
+ * separated them before (see find_collision_with_hint()).
+ *
+ * @param body1 the first body
+ * @param body2 the second body
+ * @param axis_hint if non-NULL, the axis to test first, or VEC_ZERO for none.
+ *   Updated with the axis to test first next time.
+ * @return a collision_info_t struct that tells if the bodies collided and if
+ * so, the axis of collision
+ */
+collision_info_t detect_body_collision_with_hint(body_t *body1, body_t *body2,
+                                                 vector_t *axis_hint);
+
+/**
+ * Detects a collision between two bodies like
+ * detect_body_collision_with_hint(), using results the bodies remember but
+ * without remembering a new one. Only the bodies are read, so different pairs
+ * can be checked on several threads at once, as long as no body changes and
+ * every body was updated with body_update_shape() since it last moved.
+ *
+ * @param body1 the first body
+ * @param body2 the second body
+ * @param axis_hint if non-NULL, the axis to test first, or VEC_ZERO for none.
+ *   Updated with the axis to test first next time.
+ * @return a collision_info_t struct that tells if the bodies collided and if
+ * so, the axis of collision
+ */
+collision_info_t detect_body_collision_readonly(body_t *body1, body_t *body2,
+                                                vector_t *axis_hint);
+
+/**
+ * Remembers the result of detect_body_collision_readonly() for a pair of
+ * bodies, so checking the pair again is free until one of them changes.
+ *
+ * @param body1 the first body
+ * @param body2 the second body
+ * @param info the collision between body1 and body2, with the axis pointing
+ *   from body1 towards body2
+ */
+void body_remember_collision(body_t *body1, body_t *body2,
+                             collision_info_t info);
+
+/**
+ * Finds when a body moving in a straight line first touches another body
+ * (see find_time_of_impact()). Uses the bodies' bounding boxes to skip bodies
+ * that are out of reach.
+ *
+ * @param body1 the moving body, at its starting position
+ * @param body2 the body it moves towards
+ * @param displacement how far body1 moves relative to body2
+ * @return the fraction of the displacement after which the bodies first
+ *   touch, 0 if they already overlap, or INFINITY if they don't touch
+ */
+double body_time_of_impact(body_t *body1, body_t *body2,
+                           vector_t displacement);
+
 /**
  * Marks a body for removal--future calls to body_is_removed() will return true.
  * Does not free the body.
@@ -305,4 +542,159 @@ void body_remove(body_t *body);
  */
 bool body_is_removed(body_t *body);
 
+/**
+ * Makes a body be handed back to whatever keeps it, instead of being freed,
+ * once a scene is done with it: after it is removed, or when the scene is
+ * cleared or freed. This lets bodies that are added and removed often, like
+ * projectiles, be reused without being made again.
+ * The handler then owns the body, and must eventually body_free() it.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param handler the function to call with the body and aux, or NULL to have
+ *   the body freed again
+ * @param aux an auxiliary value to pass to the handler
+ */
+void body_set_release_handler(body_t *body, body_release_handler_t handler,
+                              void *aux);
+
+/**
+ * Frees a body, or hands it to its release handler if it has one (see
+ * body_set_release_handler()).
+ * A body that is handed back is out of any store, no longer marked for
+ * removal, and has no forces or impulses left to apply, so it can be added to
+ * a scene again.
+ *
+ * @param body a pointer to a body returned from body_init()
+ */
+void body_release(body_t *body);
+
+/**
+ * Sets the collision layers of a body, a bitmask that collision rules match
+ * against (see scene_add_collision_rule()).
+ * Bodies start with no layers, so no collision rules apply to them.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param layers the new collision layers of the body
+ */
+void body_set_collision_layers(body_t *body, uint32_t layers);
+
+/**
+ * Gets the collision layers of a body.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the layers set with body_set_collision_layers(), or 0 if none were
+ */
+uint32_t body_get_collision_layers(body_t *body);
+
+/**
+ * Makes a body static or dynamic. Static bodies, like walls, have infinite
+ * mass and never move: scenes don't tick them, and never check two static
+ * bodies against each other for collisions.
+ * Must be called before the body is added to a scene, and static bodies
+ * should not be moved after that.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param is_static whether the body is static. Making a body static also sets
+ *      its mass to INFINITY and stops it.
+ */
+void body_set_static(body_t *body, bool is_static);
+
+/**
+ * Returns whether a body is static (see body_set_static()).
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return true if the body is static, false if it is dynamic
+ */
+bool body_is_static(body_t *body);
+
+/**
+ * Sets whether a body uses continuous collision detection. Scenes sweep
+ * continuous bodies along their movement every tick and stop them when they
+ * first touch a body they have a continuous collision rule with (see
+ * collision_rule_t), so that small, fast bodies like bullets can't pass
+ * through thin walls between ticks.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param is_continuous whether the body uses continuous collision detection
+ */
+void body_set_continuous(body_t *body, bool is_continuous);
+
+/**
+ * Returns whether a body uses continuous collision detection
+ * (see body_set_continuous()).
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return true if the body is continuous
+ */
+bool body_is_continuous(body_t *body);
+
+/**
+ * Makes a body a sensor, like a key or a goal, that only exists to call the
+ * handlers of collision rules when something overlaps it. Scenes never check
+ * sensors against static bodies, and continuous bodies pass through them.
+ * The friction, physics and instant resolution handlers in forces.h ignore
+ * pairs with a sensor.
+ * Bodies are not sensors by default.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param mode how the sensor is checked for overlaps, or SENSOR_NONE to make
+ *   the body solid again
+ */
+void body_set_sensor(body_t *body, sensor_mode_t mode);
+
+/**
+ * Gets how a body is checked for overlaps as a sensor
+ * (see body_set_sensor()).
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the mode set with body_set_sensor(), or SENSOR_NONE if none was
+ */
+sensor_mode_t body_get_sensor(body_t *body);
+
+/**
+ * Returns whether a body is a sensor (see body_set_sensor()).
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return true if the body's sensor mode is not SENSOR_NONE
+ */
+bool body_is_sensor(body_t *body);
+
+/**
+ * Sets the algorithm used to check a body for collisions with other bodies
+ * (see collision_method_t). A body's choice overrides COLLISION_METHOD_AUTO
+ * on the other body of a pair; if both bodies choose an algorithm, either one
+ * may be used.
+ * Bodies use COLLISION_METHOD_AUTO by default.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param method the algorithm to use
+ */
+void body_set_collision_method(body_t *body, collision_method_t method);
+
+/**
+ * Gets the algorithm used to check a body for collisions
+ * (see body_set_collision_method()).
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the algorithm the body uses
+ */
+collision_method_t body_get_collision_method(body_t *body);
+
+/**
+ * Gives a body a collision proxy made from its current shape. Collisions,
+ * times of impact and raycasts use the proxy, so their cost depends on the
+ * proxy instead of on how detailed the shape is. The shape is still drawn.
+ * Bodies with a circle or capsule proxy still use their shape for times of
+ * impact and raycasts, and body_get_collision_shape() returns the shape.
+ * The proxy moves and rotates with the body, and the body's bounding box
+ * contains both.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param proxy the kind of proxy, or COLLISION_PROXY_NONE to remove it
+ * @param max_vertices the vertex budget of a COLLISION_PROXY_HULL, at least 3.
+ *   Ignored for other proxies.
+ */
+void body_set_collision_proxy(body_t *body, collision_proxy_t proxy,
+                              size_t max_vertices);
+
 #endif // #ifndef __BODY_H__
@@ -20,4 +20,37 @@ vector_t bounding_box_center(bounding_box_t bbox);
 
 bool bounding_box_contains_point(bounding_box_t bbox, vector_t point);
 
+/**
+ * Returns whether two bounding boxes overlap. Boxes that only touch along an
+ * edge or at a corner count as overlapping.
+ */
+bool bounding_box_overlaps(bounding_box_t bbox1, bounding_box_t bbox2);
+
+/**
+ * Returns whether a bounding box fully encloses another one.
+ */
+bool bounding_box_contains(bounding_box_t outer, bounding_box_t inner);
+
+/**
+ * Returns the smallest bounding box that encloses both bounding boxes.
+ */
+bounding_box_t bounding_box_union(bounding_box_t bbox1, bounding_box_t bbox2);
+
+/**
+ * Returns a bounding box grown by the same margin on every side.
+ */
+bounding_box_t bounding_box_expand(bounding_box_t bbox, double margin);
+
+/**
+ * Returns the perimeter of a bounding box.
+ */
+double bounding_box_perimeter(bounding_box_t bbox);
+
+/**
+ * Returns whether the line segment from start to end passes through or touches
+ * a bounding box.
+ */
+bool bounding_box_intersects_segment(bounding_box_t bbox, vector_t start,
+                                     vector_t end);
+
 #endif // #ifndef __BOUNDING_BOX_H__
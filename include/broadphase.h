@@ -0,0 +1,133 @@
+#ifndef __BROADPHASE_H__
+#define __BROADPHASE_H__
+
+#include "body.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * A pair of bodies whose bounding boxes overlap, found by the broadphase.
+ * The fields after the bodies are state that the owner of the broadphase can
+ * attach to the pair. It is carried over between calls to
+ * broadphase_find_pairs() for as long as the two bodies stay a candidate pair,
+ * and is zeroed when the pair first appears.
+ *
+ * status - whether the bodies were colliding the last time they were checked
+ * separating_axis - the axis to test first the next time the pair is checked
+ *      for a collision (see detect_body_collision_with_hint())
+ */
+typedef struct body_pair {
+    body_t *body1;
+    body_t *body2;
+    collision_status_t status;
+    vector_t separating_axis;
+} body_pair_t;
+
+/**
+ * A uniform-grid spatial hash over body bounding boxes.
+ * Dynamic bodies are added every time the candidate pairs are needed, and
+ * broadphase_find_pairs() reports every pair of bodies whose bounding boxes
+ * overlap without testing all N^2 pairs. Static bodies are kept in a separate
+ * grid that is only rebuilt when they are added or removed, and pairs of two
+ * static bodies are never reported.
+ */
+typedef struct broadphase broadphase_t;
+
+/**
+ * Allocates memory for an empty broadphase.
+ *
+ * @param cell_size the side length of a grid cell. Should be a bit larger than
+ *      a typical moving body.
+ * @return the new broadphase
+ */
+broadphase_t *broadphase_init(double cell_size);
+
+/**
+ * Releases the memory allocated for a broadphase. Does not free the bodies.
+ *
+ * @param broadphase a pointer to a broadphase returned from broadphase_init()
+ */
+void broadphase_free(broadphase_t *broadphase);
+
+/**
+ * Removes all bodies, including static ones, from the broadphase and forgets
+ * the state of all pairs.
+ *
+ * @param broadphase a pointer to a broadphase returned from broadphase_init()
+ */
+void broadphase_clear(broadphase_t *broadphase);
+
+/**
+ * Adds a body for the next call to broadphase_find_pairs(), using its
+ * current bounding box. Bodies have to be added again before every call.
+ *
+ * @param broadphase a pointer to a broadphase returned from broadphase_init()
+ * @param body the body to add
+ */
+void broadphase_add_body(broadphase_t *broadphase, body_t *body);
+
+/**
+ * Adds a static body (see body_set_static()), using its current bounding box.
+ * It stays in the broadphase until it is removed (see
+ * broadphase_forget_removed_bodies()) or the broadphase is cleared.
+ * It is only paired while it has collision layers.
+ *
+ * @param broadphase a pointer to a broadphase returned from broadphase_init()
+ * @param body the static body to add
+ */
+void broadphase_add_static_body(broadphase_t *broadphase, body_t *body);
+
+/**
+ * Finds all pairs of added bodies whose bounding boxes overlap and removes the
+ * added dynamic bodies from the grid. Pairs are reported in the order their
+ * dynamic bodies were added, with static bodies after all dynamic ones, and
+ * keep their state if they were also found by the last call.
+ *
+ * @param broadphase a pointer to a broadphase returned from broadphase_init()
+ * @return the number of pairs found
+ */
+size_t broadphase_find_pairs(broadphase_t *broadphase);
+
+/**
+ * Gets a pair found by the last call to broadphase_find_pairs().
+ * Asserts that the index is valid.
+ *
+ * @param broadphase a pointer to a broadphase returned from broadphase_init()
+ * @param index the index of the pair (starting at 0)
+ * @return a pointer to the pair, valid until the next broadphase_find_pairs()
+ */
+body_pair_t *broadphase_get_pair(broadphase_t *broadphase, size_t index);
+
+/**
+ * Gets the number of pairs that were found by the call to
+ * broadphase_find_pairs() before the last one, but not by the last one,
+ * because the bounding boxes of their bodies stopped overlapping or one of
+ * the bodies was not added. Pairs containing a body that was removed (see
+ * broadphase_forget_removed_bodies()) are not included.
+ *
+ * @param broadphase a pointer to a broadphase returned from broadphase_init()
+ * @return the number of pairs lost by the last call
+ */
+size_t broadphase_lost_pairs(broadphase_t *broadphase);
+
+/**
+ * Gets a pair lost by the last call to broadphase_find_pairs(), with the
+ * state it had before it was lost. Asserts that the index is valid.
+ *
+ * @param broadphase a pointer to a broadphase returned from broadphase_init()
+ * @param index the index of the pair (starting at 0)
+ * @return a pointer to the pair, valid until the next broadphase_find_pairs()
+ */
+body_pair_t *broadphase_get_lost_pair(broadphase_t *broadphase, size_t index);
+
+/**
+ * Forgets the state of every pair that contains a body marked for removal,
+ * so that a body allocated later at the same address starts with fresh state,
+ * and removes static bodies that are marked for removal.
+ * Must be called before the removed bodies are freed.
+ *
+ * @param broadphase a pointer to a broadphase returned from broadphase_init()
+ */
+void broadphase_forget_removed_bodies(broadphase_t *broadphase);
+
+#endif // #ifndef __BROADPHASE_H__
@@ -2,6 +2,7 @@
 #define __COLLISION_H__
 
 #include "list.h"
+#include "polygon.h"
 #include "vector.h"
 #include <stdbool.h>
 
@@ -11,6 +12,24 @@ typedef enum {
     FULL_COLLISION
 } collision_status_t;
 
+/**
+ * The algorithm used to check two shapes for a collision.
+ * SAT tests every edge normal of both shapes, which costs O((n + m)^2) for
+ * shapes with n and m vertices. GJK/EPA only visits the parts of the shapes'
+ * Minkowski difference near the origin, so it is faster for shapes with many
+ * vertices, like ellipses and stars. Both give the same result for convex
+ * shapes that partially collide. When one shape's projection contains the
+ * other's along some axis, SAT reports that axis as a full collision, while
+ * GJK/EPA reports the axis of least penetration, so the axis, overlap and
+ * status may differ. For concave shapes, GJK/EPA checks their convex hulls.
+ * COLLISION_METHOD_AUTO picks GJK/EPA for shapes with many vertices together.
+ */
+typedef enum {
+    COLLISION_METHOD_AUTO,
+    COLLISION_METHOD_SAT,
+    COLLISION_METHOD_GJK
+} collision_method_t;
+
 /**
  * Represents the status of a collision between two shapes.
  * The shapes are either not colliding, or they are colliding along some axis.
@@ -30,9 +49,58 @@ typedef struct {
     double overlap;
 } collision_info_t;
 
+/**
+ * Counters of the work done by collision detection, kept separately for each
+ * thread (see collision_get_stats()).
+ * bounding_box_rejects - pairs of bodies found apart by their bounding boxes
+ *      alone (see detect_body_collision())
+ * sat_calls - pairs of polygons checked with the separating axis theorem
+ * gjk_calls - pairs of polygons checked with GJK/EPA
+ * axes_projected - axes that both polygons of a pair were projected onto,
+ *      including axis hints
+ */
+typedef struct {
+    size_t bounding_box_rejects;
+    size_t sat_calls;
+    size_t gjk_calls;
+    size_t axes_projected;
+} collision_stats_t;
+
+/**
+ * Gets the collision counters of the calling thread. They only ever grow, so
+ * the work done by a sequence of calls is the difference between the counters
+ * before and after it.
+ *
+ * @return a pointer to the calling thread's counters
+ */
+collision_stats_t *collision_get_stats(void);
+
+/**
+ * A capsule: every point within a radius of the segment from start to end.
+ * A circle is a capsule whose start and end are the same point.
+ */
+typedef struct {
+    vector_t start;
+    vector_t end;
+    double radius;
+} capsule_t;
+
+/**
+ * The unit edge normals of a polygon that SAT tests, without repeating
+ * parallel ones (see find_edge_normals()). Normals only change when the
+ * polygon rotates, so they can be computed once and rotated with it.
+ * normals - an array with room for at least as many normals as the polygon
+ *      has vertices
+ * num_normals - the number of normals in the array
+ */
+typedef struct {
+    vector_t *normals;
+    size_t num_normals;
+} edge_normals_t;
+
 /**
  * Computes the status of the collision between two convex polygons.
- * The shapes are given as lists of vertices in counterclockwise order.
+ * The shapes' vertices are in counterclockwise order.
  * There is an edge between each pair of consecutive vertices,
  * and one between the first vertex and the last vertex.
  *
@@ -41,6 +109,123 @@ typedef struct {
  * @return whether the shapes are colliding, and if so, the collision axis.
  * The axis should be a unit vector pointing from shape1 towards shape2.
  */
-collision_info_t find_collision(list_t *shape1, list_t *shape2);
+collision_info_t find_collision(polygon_t *shape1, polygon_t *shape2);
+
+/**
+ * Computes the status of the collision between two convex polygons, like
+ * find_collision(), but first tests an axis that separated the shapes before.
+ * Shapes that move only a little between calls are usually still separated
+ * along the same axis, so this avoids testing every edge normal.
+ *
+ * @param shape1 the first shape
+ * @param shape2 the second shape
+ * @param axis_hint if non-NULL, an axis to test first, or VEC_ZERO for none.
+ *   Updated to the axis of the result, to be passed to the next call.
+ * @return the same as find_collision(), except that if the shapes are not
+ *   colliding, the axis may be the hint instead of an edge normal
+ */
+collision_info_t find_collision_with_hint(polygon_t *shape1, polygon_t *shape2,
+                                          vector_t *axis_hint);
+
+/**
+ * Computes the status of the collision between two convex polygons, like
+ * find_collision_with_hint(), but with a choice of algorithm.
+ *
+ * @param shape1 the first shape
+ * @param shape2 the second shape
+ * @param method the algorithm to use if the hint doesn't separate the shapes
+ * @param axis_hint if non-NULL, an axis to test first, or VEC_ZERO for none.
+ *   Updated to the axis of the result, to be passed to the next call.
+ * @return the same as find_collision_with_hint()
+ */
+collision_info_t find_collision_with_method(polygon_t *shape1,
+                                            polygon_t *shape2,
+                                            collision_method_t method,
+                                            vector_t *axis_hint);
+
+/**
+ * Computes the unit edge normals of a polygon, skipping degenerate edges and
+ * edges parallel to one already found.
+ *
+ * @param shape the polygon
+ * @param normals set to the normals. Its array must have room for
+ *   shape->num_vertices normals.
+ */
+void find_edge_normals(polygon_t *shape, edge_normals_t *normals);
+
+/**
+ * Computes the status of the collision between two convex polygons, like
+ * find_collision_with_method(), but with SAT testing precomputed edge normals
+ * instead of computing them from the edges on every call.
+ *
+ * @param shape1 the first shape
+ * @param normals1 the edge normals of shape1, or NULL to compute them
+ * @param shape2 the second shape
+ * @param normals2 the edge normals of shape2, or NULL to compute them
+ * @param method the algorithm to use if the hint doesn't separate the shapes
+ * @param axis_hint if non-NULL, an axis to test first, or VEC_ZERO for none.
+ *   Updated to the axis of the result, to be passed to the next call.
+ * @return the same as find_collision_with_hint()
+ */
+collision_info_t find_collision_with_normals(polygon_t *shape1,
+                                             edge_normals_t *normals1,
+                                             polygon_t *shape2,
+                                             edge_normals_t *normals2,
+                                             collision_method_t method,
+                                             vector_t *axis_hint);
+
+/**
+ * Computes the status of the collision between two convex polygons, like
+ * find_collision(), using the GJK intersection test and EPA to find the
+ * collision axis and overlap. Doesn't allocate memory.
+ *
+ * @param shape1 the first shape
+ * @param shape2 the second shape
+ * @return the same as find_collision(), except that if the shapes are not
+ *   colliding, the axis may be any axis that separates them
+ */
+collision_info_t find_collision_gjk(polygon_t *shape1, polygon_t *shape2);
+
+/**
+ * Computes the status of the collision between two capsules (or circles)
+ * in closed form, from the closest points of their segments.
+ * The overlap and status are measured along the axis like find_collision().
+ *
+ * @param capsule1 the first capsule
+ * @param capsule2 the second capsule
+ * @return the same as find_collision()
+ */
+collision_info_t find_collision_capsules(capsule_t capsule1,
+                                         capsule_t capsule2);
+
+/**
+ * Computes the status of the collision between a capsule (or circle) and a
+ * convex polygon. While the capsule's segment is outside the polygon, this
+ * only finds the closest points of the segment and each edge. Otherwise it
+ * tests the polygon's edge normals like find_collision().
+ *
+ * @param capsule the capsule
+ * @param polygon the polygon, in either winding direction
+ * @return the same as find_collision(), with the axis pointing from the
+ *   capsule towards the polygon
+ */
+collision_info_t find_collision_capsule_polygon(capsule_t capsule,
+                                                polygon_t *polygon);
+
+/**
+ * Finds when a convex polygon moving in a straight line first touches another
+ * convex polygon, using the separating axis theorem on the swept shapes.
+ * Each edge normal separates the shapes for an interval of time; the shapes
+ * touch once no axis separates them anymore.
+ *
+ * @param shape1 the moving shape, at its starting position
+ * @param shape2 the shape it moves towards
+ * @param displacement how far shape1 moves relative to shape2
+ * @return the fraction of the displacement (between 0 and 1) after which the
+ *   shapes first touch, 0 if they already overlap, or INFINITY if they don't
+ *   touch during the movement
+ */
+double find_time_of_impact(polygon_t *shape1, polygon_t *shape2,
+                           vector_t displacement);
 
 #endif // #ifndef __COLLISION_H__
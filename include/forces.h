@@ -3,17 +3,6 @@
 
 #include "scene.h"
 
-/**
- * A function called when a collision occurs.
- * @param body1 the first body passed to create_collision()
- * @param body2 the second body passed to create_collision()
- * @param axis a unit vector pointing from body1 towards body2
- *   that defines the direction the two bodies are colliding in
- * @param aux the auxiliary value passed to create_collision()
- */
-typedef void (*collision_handler_t)(body_t *body1, body_t *body2, vector_t axis,
-                                    void *aux);
-
 /**
  * A function called when an interaction occurs between two bodies. Ex, when one
  * body is within the line of sight of another body.
@@ -180,6 +169,33 @@ void create_one_body_full_destructive_collision(scene_t *scene,
  */
 void create_friction(scene_t *scene, double mu, body_t *body1, body_t *body2);
 
+/**
+ * Adds a collision rule to a scene that applies friction between every pair of
+ * touching bodies with the given collision layers, like create_friction().
+ * Sensors (see body_set_sensor()) have no friction.
+ *
+ * @param scene the scene containing the bodies
+ * @param mu the coefficient of friction
+ * @param layer1 the collision layers of the first body
+ * @param layer2 the collision layers of the second body
+ */
+void create_friction_rule(scene_t *scene, double mu, uint32_t layer1,
+                          uint32_t layer2);
+
+/**
+ * A collision handler that applies the impulses of a physics collision
+ * with the given elasticity, as in create_physics_collision().
+ * Can be used as the handler of a collision rule. Ignores sensors
+ * (see body_set_sensor()).
+ *
+ * @param body1 the first body
+ * @param body2 the second body
+ * @param axis the collision axis
+ * @param elasticity a pointer to the "coefficient of restitution"
+ */
+void physics_collision_handler(body_t *body1, body_t *body2, vector_t axis,
+                               double *elasticity);
+
 /**
  * Adds a force creator to a scene that applies impulses
  * to resolve collisions between two bodies in the scene.
@@ -204,6 +220,19 @@ void create_physics_collision(scene_t *scene, double elasticity, body_t *body1,
 void create_instant_resolution_collision(scene_t *scene, body_t *body1,
                                          body_t *body2);
 
+/**
+ * Adds a collision rule to a scene that pushes apart every pair of overlapping
+ * bodies with the given collision layers, like
+ * create_instant_resolution_collision(). Pairs where both bodies have infinite
+ * mass, and pairs with a sensor (see body_set_sensor()), are left alone.
+ *
+ * @param scene the scene containing the bodies
+ * @param layer1 the collision layers of the first body
+ * @param layer2 the collision layers of the second body
+ */
+void create_instant_resolution_collision_rule(scene_t *scene, uint32_t layer1,
+                                              uint32_t layer2);
+
 /**
  * Adds a force creator to a scene that calls a given collision handler
  * function each time two bodies interact. For example, one body could be within
@@ -20,6 +20,11 @@ typedef enum game_status {
     PLAYING,
 } game_status_t;
 
+// A timer of the game (see game_timers.h)
+typedef struct game_timer game_timer_t;
+
+DEFINE_ARRAY(timer_array, game_timer_t *)
+
 typedef struct state {
     scene_t *scene;
     scene_t *hud_scene;
@@ -27,12 +32,15 @@ typedef struct state {
     body_t *player;
     // Table to keep track of which keys are held, bool entry for every char
     bool *held_keys;
-    list_t *timers;
+    timer_array_t *timers;
     size_t curr_level;
     double level_time_elapsed;
     game_status_t game_status;
     size_t num_deaths_so_far; // this should not be reset when we reset level;
     bounding_box_t scene_boundary;
+    // Bodies reused across spawns and levels (see game_pools.h)
+    struct body_pool *bullet_pool;
+    struct body_pool *tongue_pool;
 } state_t;
 
 #endif // #ifndef __GAME_H__
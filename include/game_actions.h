@@ -14,6 +14,15 @@ void game_mouse_handler(state_t *state, mouse_event_type_t type,
 
 vector_t get_camera_for_player_pos(state_t *state);
 
+/**
+ * Adds the forces on the pooled bullets and tongue pieces to the game scene.
+ * They stay registered for the whole level, and only act on the bodies that
+ * are in use. Must be called again every time the scene is cleared.
+ *
+ * @param state the game state
+ */
+void add_pooled_body_forces(state_t *state);
+
 void perform_game_actions(state_t *state, double dt);
 
 #endif // #ifndef __GAME_ACTIONS_H__
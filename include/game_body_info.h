@@ -23,7 +23,9 @@ typedef enum body_role {
     TRAMPOLINE = 1 << 12,
     // Role combinations
     ANY = (1 << 13) - 1,
-    SOLID = ANY & ~(DECORATION | PLAYER_PAPARAZZI | KEY),
+    // Bodies that only exist to be touched by the player
+    SENSOR = KEY | VENT,
+    SOLID = ANY & ~(DECORATION | PLAYER_PAPARAZZI | SENSOR),
 } body_role_t;
 
 typedef enum tongue_status {
@@ -37,7 +39,14 @@ typedef struct body_info {
     body_role_t role;
 } body_info_t;
 
-body_info_t *body_info_init(body_role_t role);
+/**
+ * The infos that don't own any other memory can be allocated from a scene
+ * (see scene_alloc()). They are freed when the scene is cleared, so the bodies
+ * they belong to must not free them. This is meant for the bodies loaded with
+ * a level; bodies made while playing it allocate their infos with malloc() by
+ * passing a NULL scene, and free them.
+ */
+body_info_t *body_info_init(scene_t *scene, body_role_t role);
 
 typedef struct body_health_info {
     int32_t health;
@@ -50,7 +59,8 @@ typedef struct damaging_body_info {
     size_t damage; // size_t because health is discrete
 } damaging_body_info_t;
 
-damaging_body_info_t *damaging_body_info_init(body_role_t role, size_t damage);
+damaging_body_info_t *damaging_body_info_init(scene_t *scene, body_role_t role,
+                                              size_t damage);
 
 typedef struct player_info {
     body_role_t role;
@@ -73,15 +83,17 @@ typedef struct key_and_door_info {
     size_t id;
 } key_and_door_info_t;
 
-key_and_door_info_t *key_and_door_info_init(body_role_t role, size_t id);
+key_and_door_info_t *key_and_door_info_init(scene_t *scene, body_role_t role,
+                                            size_t id);
 
 typedef struct trajectory_info {
-    list_t *trajectory_shape;
+    polygon_t *trajectory_shape;
     double speed;
     size_t curr_point_index;
 } trajectory_info_t;
 
-trajectory_info_t *trajectory_info_init(list_t *trajectory_shape, double speed);
+trajectory_info_t *trajectory_info_init(polygon_t *trajectory_shape,
+                                        double speed);
 
 void trajectory_info_free(trajectory_info_t *trajectory_info);
 
@@ -93,6 +105,8 @@ typedef struct crewmate_info {
     double reload_time;
     double reloading_timer;
     size_t damage_per_bullet;
+    // shared with the bullets the crewmate fires, so it isn't freed with the
+    // crewmate, but with the level
     char *game_over_message;
     bool facing_left;
 } crewmate_info_t;
@@ -130,7 +144,7 @@ typedef struct trampoline_info {
     double bounciness;
 } trampoline_info_t;
 
-trampoline_info_t *trampoline_info_init(double bounciness);
+trampoline_info_t *trampoline_info_init(scene_t *scene, double bounciness);
 
 body_role_t get_role(body_t *body);
 
@@ -60,6 +60,8 @@
 #define BULLET_INIT_VERTICAL_OFFSET 0
 #define BULLET_MASS 0.1
 #define BULLET_SPEED 100
+// The most bullets in flight at once; crewmates wait to fire past that
+#define BULLET_POOL_SIZE 32
 
 #define TRAMPOLINE_SIDE_WALL_THICKNESS_RATIO 6
 #define TRAMPOLINE_SIDE_WALL_MASS 0
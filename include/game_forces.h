@@ -3,6 +3,30 @@
 
 #include "game.h"
 
+/**
+ * Adds the collision rules between the roles of the game to the game scene.
+ * Must be called again every time the scene is cleared.
+ *
+ * @param state the game state
+ */
+void add_collision_rules(state_t *state);
+
+/**
+ * Sets how a body collides from its role: whether it is continuous or a
+ * sensor, and its collision layers, which are its role.
+ *
+ * @param body the body, whose info has a role
+ */
+void set_body_collisions(body_t *body);
+
+/**
+ * Adds a body to the game scene along with its gravity and drag forces.
+ * Static bodies don't get gravity. The body's collisions are set from its role
+ * (see set_body_collisions()).
+ *
+ * @param state the game state
+ * @param new_body the body to add
+ */
 void add_body_with_forces(state_t *state, body_t *new_body);
 
 #endif // #ifndef __GAME_FORCES_H__
@@ -0,0 +1,82 @@
+#ifndef __GAME_POOLS_H__
+#define __GAME_POOLS_H__
+
+#include "body.h"
+#include "game.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Bodies that are made once and then added to the game scene and removed from
+ * it over and over, like bullets and the pieces of the tongue. The scene hands
+ * a pool's bodies back to it instead of freeing them (see
+ * body_set_release_handler()), when they are removed or when the level is
+ * cleared, so spawning and despawning them allocates nothing.
+ * A body is in use from when it is taken from the pool until the scene hands
+ * it back.
+ */
+typedef struct body_pool body_pool_t;
+
+/**
+ * Allocates memory for an empty pool.
+ *
+ * @param capacity the number of bodies the pool can hold
+ * @return the new pool
+ */
+body_pool_t *body_pool_init(size_t capacity);
+
+/**
+ * Frees a pool and all its bodies. None of them may be in a scene.
+ *
+ * @param pool the pool to free
+ */
+void body_pool_free(body_pool_t *pool);
+
+/**
+ * Gives a body, which isn't in a scene, to a pool.
+ * Asserts that the pool isn't full.
+ *
+ * @param pool the pool to add to
+ * @param body the body, which the pool now owns
+ */
+void body_pool_add(body_pool_t *pool, body_t *body);
+
+/**
+ * Takes any body of a pool that isn't in use, in constant time.
+ * The caller is expected to add it to the game scene.
+ *
+ * @param pool the pool to take from
+ * @return the body, or NULL if all of them are in use
+ */
+body_t *body_pool_take(body_pool_t *pool);
+
+/**
+ * Takes every body of a pool, if none of them are in use.
+ *
+ * @param pool the pool to take from
+ * @return whether the bodies were taken
+ */
+bool body_pool_take_all(body_pool_t *pool);
+
+size_t body_pool_size(body_pool_t *pool);
+
+body_t *body_pool_get(body_pool_t *pool, size_t index);
+
+bool body_pool_is_in_use(body_pool_t *pool, size_t index);
+
+/**
+ * Makes the bullets and the tongue pieces of the game, in their pools.
+ *
+ * @param state the game state
+ */
+void init_body_pools(state_t *state);
+
+/**
+ * Frees the pools of the game. Must be called after the game scene is freed,
+ * which hands the bodies in use back to them.
+ *
+ * @param state the game state
+ */
+void free_body_pools(state_t *state);
+
+#endif // #ifndef __GAME_POOLS_H__
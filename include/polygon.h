@@ -4,6 +4,8 @@
 #include "bounding_box.h"
 #include "list.h"
 #include "vector.h"
+#include <stdbool.h>
+#include <stddef.h>
 
 typedef enum anchor_option_1d {
     ANCHOR_MIN,
@@ -16,49 +18,127 @@ typedef struct anchor_option {
     anchor_option_1d_t y_anchor;
 } anchor_option_t;
 
-bounding_box_t polygon_get_bounding_box(list_t *polygon);
+/**
+ * A polygon, with its vertices stored inline in a single allocation.
+ * There is an edge between each pair of consecutive vertices, plus one between
+ * the last and the first.
+ */
+typedef struct polygon {
+    size_t num_vertices;
+    vector_t vertices[];
+} polygon_t;
+
+/**
+ * Allocates memory for a polygon. Its vertices are not initialized.
+ *
+ * @param num_vertices the number of vertices of the polygon
+ * @return the new polygon, to be freed with polygon_free()
+ */
+polygon_t *polygon_init(size_t num_vertices);
+
+/**
+ * Allocates memory for a polygon with the vertices in a list.
+ *
+ * @param vertices a list of vector_t pointers, which is not freed
+ * @return the new polygon, to be freed with polygon_free()
+ */
+polygon_t *polygon_from_list(list_t *vertices);
+
+/**
+ * Copies a polygon.
+ *
+ * @param polygon the polygon to copy
+ * @return the new polygon, to be freed with polygon_free()
+ */
+polygon_t *polygon_copy(const polygon_t *polygon);
+
+/**
+ * Releases the memory allocated for a polygon.
+ *
+ * @param polygon a polygon returned from polygon_init() or any other function
+ *   returning a new polygon
+ */
+void polygon_free(polygon_t *polygon);
+
+bounding_box_t polygon_get_bounding_box(const polygon_t *polygon);
 
 /**
  * Computes the area of a polygon.
  * See https://en.wikipedia.org/wiki/Shoelace_formula#Statement.
  *
- * @param polygon the list of vertices that make up the polygon,
+ * @param polygon the vertices of the polygon,
  * listed in a counterclockwise direction. There is an edge between
  * each pair of consecutive vertices, plus one between the first and last.
  * @return the area of the polygon
  */
-double polygon_area(list_t *polygon);
+double polygon_area(const polygon_t *polygon);
 
 /**
  * Computes the center of mass of a polygon.
  * See https://en.wikipedia.org/wiki/Centroid#Of_a_polygon.
  *
- * @param polygon the list of vertices that make up the polygon,
+ * @param polygon the vertices of the polygon,
  * listed in a counterclockwise direction. There is an edge between
  * each pair of consecutive vertices, plus one between the first and last.
  * @return the centroid of the polygon
  */
-vector_t polygon_centroid(list_t *polygon);
+vector_t polygon_centroid(const polygon_t *polygon);
 
 /**
  * Translates all vertices in a polygon by a given vector.
  * Note: mutates the original polygon.
  *
- * @param polygon the list of vertices that make up the polygon
+ * @param polygon the polygon
  * @param translation the vector to add to each vertex's position
  */
-void polygon_translate(list_t *polygon, vector_t translation);
+void polygon_translate(polygon_t *polygon, vector_t translation);
 
 /**
  * Rotates vertices in a polygon by a given angle about a given point.
  * Note: mutates the original polygon.
  *
- * @param polygon the list of vertices that make up the polygon
+ * @param polygon the polygon
  * @param angle the angle to rotate the polygon, in radians.
  * A positive angle means counterclockwise.
  * @param point the point to rotate around
  */
-void polygon_rotate(list_t *polygon, double angle, vector_t point);
+void polygon_rotate(polygon_t *polygon, double angle, vector_t point);
+
+/**
+ * Clips a line segment against a convex polygon (Cyrus-Beck clipping).
+ * Points along the segment are written as start + t * (end - start),
+ * with t between 0 and 1. Does not allocate memory.
+ *
+ * @param polygon a convex polygon, in either winding direction
+ * @param start the start of the segment
+ * @param end the end of the segment
+ * @param t_enter if non-NULL and the segment hits the polygon, set to where
+ * the segment enters it. This is 0 if start is inside the polygon.
+ * @param t_exit if non-NULL and the segment hits the polygon, set to where
+ * the segment leaves it. This is 1 if end is inside the polygon.
+ * @return whether any part of the segment is inside or on the polygon
+ */
+bool polygon_segment_intersect(const polygon_t *polygon, vector_t start,
+                               vector_t end, double *t_enter, double *t_exit);
+
+/**
+ * Computes the convex hull of a polygon, with a limited number of vertices.
+ * If the hull has more vertices than the budget, the vertices that contribute
+ * the least area are dropped, so the result fits inside the full hull.
+ *
+ * @param polygon the polygon, whose vertices can be in any order
+ * @param max_vertices the most vertices the hull can have, at least 3
+ * @return a new counterclockwise polygon. The caller owns it.
+ */
+polygon_t *polygon_convex_hull(polygon_t *polygon, size_t max_vertices);
+
+/**
+ * Computes the smallest rectangle, at any rotation, that contains a polygon.
+ *
+ * @param polygon the polygon
+ * @return a new counterclockwise rectangle. The caller owns it.
+ */
+polygon_t *polygon_oriented_bounding_box(polygon_t *polygon);
 
 /**
  * Initializes a star-shaped polygon.
@@ -70,27 +150,28 @@ void polygon_rotate(list_t *polygon, double angle, vector_t point);
  * @return a polygon with the given parameters. A point at a distance of
  *          the circumradius lies on x-axis.
  */
-list_t *initialize_star(vector_t center, size_t num_arms, double circumradius,
-                        double inradius);
+polygon_t *initialize_star(vector_t center, size_t num_arms,
+                           double circumradius, double inradius);
 
-list_t *initialize_star_anchored(anchor_option_t anchor, vector_t pos,
-                                 size_t num_arms, double circumradius,
-                                 double inradius);
+polygon_t *initialize_star_anchored(anchor_option_t anchor, vector_t pos,
+                                    size_t num_arms, double circumradius,
+                                    double inradius);
 
-list_t *initialize_regular_polygon(vector_t center, double circumradius,
-                                   size_t num_verts);
+polygon_t *initialize_regular_polygon(vector_t center, double circumradius,
+                                      size_t num_verts);
 
-list_t *initialize_pacman(vector_t center, double mouth_angle,
-                          double face_radius, size_t num_segments_pacman_back);
+polygon_t *initialize_pacman(vector_t center, double mouth_angle,
+                             double face_radius,
+                             size_t num_segments_pacman_back);
 
-list_t *initialize_rectangle(double min_x, double min_y, double max_x,
-                             double max_y);
+polygon_t *initialize_rectangle(double min_x, double min_y, double max_x,
+                                double max_y);
 
-list_t *initialize_rectangle_centered(vector_t center, double width,
-                                      double height);
+polygon_t *initialize_rectangle_centered(vector_t center, double width,
+                                         double height);
 
-list_t *initialize_rectangle_anchored(anchor_option_t anchor, vector_t pos,
-                                      double width, double height);
+polygon_t *initialize_rectangle_anchored(anchor_option_t anchor, vector_t pos,
+                                         double width, double height);
 
 /**
  * Initializes a rotated rectangle whose 4 sides are not parallel to the x- and
@@ -101,16 +182,16 @@ list_t *initialize_rectangle_anchored(anchor_option_t anchor, vector_t pos,
  * @param pos2 The other point upon which the opposite side of the rectangle is
  * anchored to.
  * @param width The width of the rectangle.
- * @return A list_t pointer that represents the rotated rectangle shape.
+ * @return A polygon_t pointer that represents the rotated rectangle shape.
  */
-list_t *initialize_rectangle_rotated(vector_t pos1, vector_t pos2,
-                                     double width);
+polygon_t *initialize_rectangle_rotated(vector_t pos1, vector_t pos2,
+                                        double width);
 
-list_t *initialize_ellipse(vector_t center, double width, double height,
-                           size_t num_verts);
+polygon_t *initialize_ellipse(vector_t center, double width, double height,
+                              size_t num_verts);
 
-list_t *initialize_ellipse_anchored(anchor_option_t anchor, vector_t pos,
-                                    double width, double height,
-                                    size_t num_verts);
+polygon_t *initialize_ellipse_anchored(anchor_option_t anchor, vector_t pos,
+                                       double width, double height,
+                                       size_t num_verts);
 
 #endif // #ifndef __POLYGON_H__
@@ -3,6 +3,10 @@
 
 #include "body.h"
 #include "list.h"
+#include <stdint.h>
+
+// The largest number of collision rules a scene can have
+#define MAX_COLLISION_RULES 32
 
 /**
  * A collection of bodies and force creators.
@@ -18,6 +22,54 @@ typedef struct scene scene_t;
  */
 typedef void (*force_creator_t)(void *aux);
 
+/**
+ * A function called when a collision occurs.
+ * @param body1 the first body passed to create_collision()
+ * @param body2 the second body passed to create_collision()
+ * @param axis a unit vector pointing from body1 towards body2
+ *   that defines the direction the two bodies are colliding in
+ * @param aux the auxiliary value passed to create_collision()
+ */
+typedef void (*collision_handler_t)(body_t *body1, body_t *body2, vector_t axis,
+                                    void *aux);
+
+/**
+ * A collision handler that applies to every pair of bodies in a scene
+ * whose collision layers match, instead of to one fixed pair of bodies.
+ * See body_set_collision_layers().
+ *
+ * layer1 - the handler is called for pairs where one body has any of these
+ *      layers and the other body has any of the layers in layer2.
+ *      The body matching layer1 is passed to the handler as body1.
+ * layer2 - the layers that the other body must have
+ * handler - the function to call when the bodies collide
+ * end_handler - if non-NULL, the function to call when the bodies stop
+ *      colliding, with the axis that last separated them. Contacts with a
+ *      body that is removed end without calling it.
+ * is_post_tick - if true, the rule is only applied after the bodies tick
+ * is_contact_collision - if true, the handler is applied even if the bodies
+ *      collided in the last frame
+ * is_full_collision - if true, the handler is only applied if the collision
+ *      is full - that is, the bodies fully overlap
+ * is_continuous - if true, continuous bodies (see body_set_continuous()) with
+ *      one side's layers are stopped when they would pass through bodies with
+ *      the other side's layers
+ *
+ * Pairs of bodies whose layers no rule matches are skipped before any
+ * collision detection, and bodies whose layers no rule mentions are never
+ * checked for collisions.
+ */
+typedef struct collision_rule {
+    uint32_t layer1;
+    uint32_t layer2;
+    collision_handler_t handler;
+    collision_handler_t end_handler;
+    bool is_post_tick;
+    bool is_contact_collision;
+    bool is_full_collision;
+    bool is_continuous;
+} collision_rule_t;
+
 /**
  * Allocates memory for an empty scene.
  * Makes a reasonable guess of the number of bodies to allocate space for.
@@ -30,6 +82,8 @@ scene_t *scene_init(void);
 /**
  * Releases memory allocated for a given scene
  * and all the bodies and force creators it contains.
+ * Bodies with a release handler are handed back instead of being freed (see
+ * body_release()).
  *
  * @param scene a pointer to a scene returned from scene_init()
  */
@@ -55,6 +109,7 @@ body_t *scene_get_body(scene_t *scene, size_t index);
 
 /**
  * Adds a body to a scene.
+ * Whether the body is static (see body_set_static()) must already be set.
  *
  * @param scene a pointer to a scene returned from scene_init()
  * @param body a pointer to the body to add to the scene
@@ -73,12 +128,28 @@ void scene_add_body(scene_t *scene, body_t *body);
 void scene_remove_body(scene_t *scene, size_t index);
 
 /**
- * Removes all bodies and forces from the scene.
+ * Removes all bodies, forces and collision rules from the scene.
+ * Also frees all the memory allocated with scene_alloc().
  *
  * @param scene a pointer to a scene returned from scene_init()
  */
 void scene_clear(scene_t *scene);
 
+/**
+ * Allocates memory that lives until the scene is next cleared or freed, such
+ * as the parameters of the scene's force creators and collision rules.
+ * The memory comes from an arena (see arena.h), so it must not be freed, and
+ * freeing it all when the scene is cleared takes constant time.
+ * Memory for an object that is removed before the scene is cleared is not
+ * reused until then, so this is meant for objects that last about as long as
+ * a level.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param size the number of bytes to allocate
+ * @return a pointer to the uninitialized memory
+ */
+void *scene_alloc(scene_t *scene, size_t size);
+
 /**
  * @deprecated Use scene_add_bodies_force_creator() instead
  * so the scene knows which bodies the force creator depends on
@@ -111,6 +182,129 @@ void scene_add_bodies_generic_force_creator(scene_t *scene,
                                             bool is_post_tick, void *aux,
                                             list_t *bodies, free_func_t freer);
 
+/**
+ * Adds a force creator to a scene, like
+ * scene_add_bodies_generic_force_creator(), with the bodies it depends on in
+ * an array instead of a list. The scene keeps a copy of the array in the
+ * memory it frees when it is cleared, so adding the force creator allocates
+ * nothing from the system once the scene has grown to the level's size.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param forcer a force creator function
+ * @param is_post_tick whether the force creator is invoked after the bodies
+ *   move, rather than before
+ * @param aux an auxiliary value to pass to forcer when it is called
+ * @param bodies the bodies affected by the force creator, which the caller
+ *   keeps. The force creator will be removed if any of these bodies are
+ *   removed.
+ * @param num_bodies the number of bodies, which may be 0
+ * @param freer if non-NULL, a function to call in order to free aux
+ */
+void scene_add_body_array_force_creator(scene_t *scene, force_creator_t forcer,
+                                        bool is_post_tick, void *aux,
+                                        body_t **bodies, size_t num_bodies,
+                                        free_func_t freer);
+
+/**
+ * Adds a collision rule to a scene, to be applied every time scene_tick() is
+ * called. Candidate pairs are found with a broadphase over the bounding boxes
+ * of all bodies with nonzero collision layers, so only bodies that are close to
+ * each other are checked for collisions.
+ * Each candidate pair is checked for a collision once per phase of the tick,
+ * and whether it began, persisted or ended touching is passed to every rule
+ * that matches it. Within a tick, rules are applied pair by pair, in the order
+ * the rules were added. Asserts that the scene has fewer than
+ * MAX_COLLISION_RULES rules and that the rule has a handler or end_handler.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param rule the layers, handler and options of the rule
+ * @param aux an auxiliary value to pass to the handler when it is called
+ * @param freer if non-NULL, a function to call in order to free aux
+ */
+void scene_add_collision_rule(scene_t *scene, collision_rule_t rule, void *aux,
+                              free_func_t freer);
+
+/**
+ * Finds the bodies in a scene whose bounding boxes overlap a region, using the
+ * scene's spatial index. The index is updated when bodies are added and at the
+ * end of every scene_tick(), so bodies moved since then may be missed.
+ * Bodies marked for removal are skipped.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param region the region to search
+ * @param bodies a list to add the bodies found to, in the order they are in
+ *      the scene. The list should not own the bodies, so its freer should be
+ *      NULL.
+ * @return the number of bodies added to the list
+ */
+size_t scene_query_region(scene_t *scene, bounding_box_t region,
+                          list_t *bodies);
+
+/**
+ * Finds the bodies in a scene whose bounding boxes contain a point,
+ * like scene_query_region().
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param point the point to search at
+ * @param bodies a list to add the bodies found to, in scene order
+ * @return the number of bodies added to the list
+ */
+size_t scene_query_point(scene_t *scene, vector_t point, list_t *bodies);
+
+/**
+ * Finds the bodies in a scene whose bounding boxes are crossed by a line
+ * segment, like scene_query_region().
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param start one end of the segment
+ * @param end the other end of the segment
+ * @param bodies a list to add the bodies found to, in scene order
+ * @return the number of bodies added to the list
+ */
+size_t scene_query_segment(scene_t *scene, vector_t start, vector_t end,
+                           list_t *bodies);
+
+/**
+ * A function that decides whether a raycast can hit a body.
+ *
+ * @param body a body whose bounding box the ray crosses
+ * @param aux the auxiliary value passed to scene_raycast()
+ * @return true if the body can be hit, false if the ray passes through it
+ */
+typedef bool (*raycast_filter_t)(body_t *body, void *aux);
+
+/**
+ * The first body hit by a raycast.
+ * body - the body that was hit
+ * distance - how far from the start of the ray the body was hit.
+ *      0 if the ray starts inside the body.
+ * point - the point where the ray enters the body
+ */
+typedef struct raycast_hit {
+    body_t *body;
+    double distance;
+    vector_t point;
+} raycast_hit_t;
+
+/**
+ * Casts a ray along a line segment and finds the first body it hits,
+ * by clipping the segment against the shapes of the bodies along it.
+ * Uses the scene's spatial index like scene_query_segment(), and doesn't
+ * allocate memory. Bodies marked for removal are skipped.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param start the start of the ray
+ * @param end the end of the ray
+ * @param filter if non-NULL, only bodies it returns true for can be hit
+ * @param aux an auxiliary value to pass to the filter
+ * @param hit if non-NULL, set to the closest hit. Ties go to the body that
+ *      is first in the scene. If NULL, the raycast stops at the first hit
+ *      found, which is faster when only whether anything was hit matters.
+ * @return whether any body was hit
+ */
+bool scene_raycast(scene_t *scene, vector_t start, vector_t end,
+                   raycast_filter_t filter, void *aux, raycast_hit_t *hit);
+
 /**
  * Detects if a body is "visible" from the point of view of another body.
  *
@@ -127,12 +321,49 @@ void scene_add_bodies_generic_force_creator(scene_t *scene,
 bool scene_detect_line_of_sight(scene_t *scene, body_t *body1, body_t *body2,
                                 body_predicate_t opaqueness_predicate);
 
+/**
+ * Counters of the collision work a scene did in one tick, to tune levels and
+ * check that optimizations do less work. Counts both phases of the tick, but
+ * only the collision rules: collisions created between two bodies (see
+ * create_collision()) are not counted.
+ * candidate_pairs - pairs of bodies found by the broadphases
+ * pairs_checked - candidate pairs that a rule could match, which were checked
+ *      for a collision. Pairs whose result the bodies remembered are checked
+ *      without any other work.
+ * bounding_box_rejects - checked pairs found apart by their bounding boxes
+ * sat_calls, gjk_calls, axes_projected - the polygon tests of the checked
+ *      pairs (see collision_stats_t)
+ * contacts - checked pairs that were touching
+ * handler_calls - calls to the handlers and end handlers of collision rules
+ */
+typedef struct scene_stats {
+    size_t candidate_pairs;
+    size_t pairs_checked;
+    size_t bounding_box_rejects;
+    size_t sat_calls;
+    size_t gjk_calls;
+    size_t axes_projected;
+    size_t contacts;
+    size_t handler_calls;
+} scene_stats_t;
+
+/**
+ * Gets the collision work a scene did in its last tick. The counters are reset
+ * at the start of every scene_tick().
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return the counters of the last tick, or of the current one if called from
+ *   a force creator or collision handler
+ */
+scene_stats_t scene_get_stats(scene_t *scene);
+
 /**
  * Executes a tick of a given scene over a small time interval.
- * This requires executing all the force creators
- * and then ticking each body (see body_tick()).
+ * This requires executing all the force creators and collision rules
+ * and then ticking each body that isn't static (see body_tick()).
  * If any bodies are marked for removal, they should be removed from the scene
- * and freed, along with any force creators acting on them.
+ * and freed (or handed back, see body_release()), along with any force
+ * creators acting on them.
  *
  * @param scene a pointer to a scene returned from scene_init()
  * @param dt the time elapsed since the last tick, in seconds
@@ -0,0 +1,73 @@
+#ifndef __THREAD_POOL_H__
+#define __THREAD_POOL_H__
+
+#include <stddef.h>
+
+/**
+ * A fixed set of worker threads that split loops over independent items
+ * with the thread that runs them.
+ * On builds without threads (emscripten without pthread support), pools have
+ * no workers and every loop runs on the calling thread.
+ */
+typedef struct thread_pool thread_pool_t;
+
+/**
+ * A function that processes a range of the items of a loop.
+ * Different ranges of the same loop may be processed at the same time on
+ * different threads, so it must only write state that belongs to its items.
+ *
+ * @param aux the auxiliary value passed to thread_pool_run()
+ * @param start the index of the first item to process
+ * @param end one past the index of the last item to process
+ */
+typedef void (*thread_pool_func_t)(void *aux, size_t start, size_t end);
+
+/**
+ * Allocates memory for a thread pool and starts its worker threads.
+ * If some workers can't be started, the pool has fewer of them.
+ *
+ * @param num_workers the number of threads to start, besides the thread that
+ *   runs loops
+ * @return the new thread pool
+ */
+thread_pool_t *thread_pool_init(size_t num_workers);
+
+/**
+ * Stops the workers of a thread pool and releases its memory.
+ *
+ * @param pool a pointer to a thread pool returned from thread_pool_init()
+ */
+void thread_pool_free(thread_pool_t *pool);
+
+/**
+ * Returns the number of worker threads that a pool would use on this
+ * machine: one fewer than the number of processors, so that the thread that
+ * runs loops has a processor too. 0 on builds without threads.
+ *
+ * @return the suggested number of workers for thread_pool_init()
+ */
+size_t thread_pool_default_workers(void);
+
+/**
+ * Gets the number of worker threads a pool started.
+ *
+ * @param pool a pointer to a thread pool returned from thread_pool_init()
+ * @return the number of workers, not counting the thread that runs loops
+ */
+size_t thread_pool_workers(thread_pool_t *pool);
+
+/**
+ * Processes the items of a loop, split into one contiguous range per thread,
+ * and returns once every item has been processed. The calling thread processes
+ * the first range, and func is never called with an empty range. Must not be
+ * called from a thread_pool_func_t.
+ *
+ * @param pool a pointer to a thread pool returned from thread_pool_init()
+ * @param count the number of items
+ * @param func the function that processes a range of items
+ * @param aux an auxiliary value to pass to func
+ */
+void thread_pool_run(thread_pool_t *pool, size_t count,
+                     thread_pool_func_t func, void *aux);
+
+#endif // #ifndef __THREAD_POOL_H__
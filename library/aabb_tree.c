@@ -0,0 +1,397 @@
+#include "aabb_tree.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+// Marks a missing parent or child, or the end of the free list
+#define NULL_NODE SIZE_MAX
+
+const size_t AABB_TREE_INITIAL_CAPACITY = 16;
+
+/**
+ * A node of the tree. Leaves have no children and store a value.
+ * parent - the parent node, or the next free node for nodes in the free list
+ * height - 0 for leaves, -1 for free nodes
+ */
+typedef struct aabb_tree_node {
+    bounding_box_t bbox;
+    void *data;
+    size_t parent;
+    size_t child1;
+    size_t child2;
+    int32_t height;
+} aabb_tree_node_t;
+
+/**
+ * nodes - a pool of nodes, indexed by id. Ids stay valid when it grows.
+ * free_list - the first unused node in the pool
+ * stack - reused by queries to store the nodes left to visit
+ */
+typedef struct aabb_tree {
+    aabb_tree_node_t *nodes;
+    size_t capacity;
+    size_t free_list;
+    size_t root;
+    double margin;
+    size_t *stack;
+    size_t stack_capacity;
+} aabb_tree_t;
+
+/**
+ * Helper function.
+ * Links the nodes from start to the end of the pool into the free list.
+ */
+void link_free_nodes(aabb_tree_t *tree, size_t start) {
+    for (size_t i = start; i < tree->capacity; i++) {
+        tree->nodes[i].parent = i + 1 < tree->capacity ? i + 1 : NULL_NODE;
+        tree->nodes[i].height = -1;
+    }
+    tree->free_list = start;
+}
+
+aabb_tree_t *aabb_tree_init(double margin) {
+    assert(margin >= 0);
+    aabb_tree_t *tree = malloc(sizeof(aabb_tree_t));
+    assert(tree);
+    tree->capacity = AABB_TREE_INITIAL_CAPACITY;
+    tree->nodes = malloc(sizeof(aabb_tree_node_t) * tree->capacity);
+    assert(tree->nodes);
+    link_free_nodes(tree, 0);
+    tree->root = NULL_NODE;
+    tree->margin = margin;
+    tree->stack_capacity = AABB_TREE_INITIAL_CAPACITY;
+    tree->stack = malloc(sizeof(size_t) * tree->stack_capacity);
+    assert(tree->stack);
+    return tree;
+}
+
+void aabb_tree_free(aabb_tree_t *tree) {
+    free(tree->nodes);
+    free(tree->stack);
+    free(tree);
+}
+
+void aabb_tree_clear(aabb_tree_t *tree) {
+    link_free_nodes(tree, 0);
+    tree->root = NULL_NODE;
+}
+
+size_t tree_allocate_node(aabb_tree_t *tree) {
+    if (tree->free_list == NULL_NODE) {
+        size_t old_capacity = tree->capacity;
+        tree->capacity *= 2;
+        tree->nodes =
+            realloc(tree->nodes, sizeof(aabb_tree_node_t) * tree->capacity);
+        assert(tree->nodes);
+        link_free_nodes(tree, old_capacity);
+    }
+    size_t id = tree->free_list;
+    aabb_tree_node_t *node = &tree->nodes[id];
+    tree->free_list = node->parent;
+    node->data = NULL;
+    node->parent = NULL_NODE;
+    node->child1 = NULL_NODE;
+    node->child2 = NULL_NODE;
+    node->height = 0;
+    return id;
+}
+
+void tree_free_node(aabb_tree_t *tree, size_t id) {
+    tree->nodes[id].parent = tree->free_list;
+    tree->nodes[id].height = -1;
+    tree->free_list = id;
+}
+
+bool tree_is_leaf(aabb_tree_node_t *node) {
+    return node->child1 == NULL_NODE;
+}
+
+/**
+ * Helper function.
+ * Replaces a child of a node, or the root if the node is NULL_NODE.
+ */
+void tree_replace_child(aabb_tree_t *tree, size_t parent, size_t old_child,
+                        size_t new_child) {
+    if (parent == NULL_NODE) {
+        tree->root = new_child;
+    } else if (tree->nodes[parent].child1 == old_child) {
+        tree->nodes[parent].child1 = new_child;
+    } else {
+        tree->nodes[parent].child2 = new_child;
+    }
+}
+
+/**
+ * Helper function.
+ * Recomputes the height and bounding box of an internal node from its children.
+ */
+void tree_refit_node(aabb_tree_t *tree, size_t id) {
+    aabb_tree_node_t *node = &tree->nodes[id];
+    aabb_tree_node_t *child1 = &tree->nodes[node->child1];
+    aabb_tree_node_t *child2 = &tree->nodes[node->child2];
+    node->height =
+        1 + (child1->height > child2->height ? child1->height : child2->height);
+    node->bbox = bounding_box_union(child1->bbox, child2->bbox);
+}
+
+/**
+ * Helper function.
+ * Makes the taller child of a node its parent, if the children's heights
+ * differ by more than 1. Moves the shorter of the grandchildren under the old
+ * node, so the subtree gets shorter.
+ *
+ * @param tree the tree
+ * @param a the root of the subtree to balance
+ * @param tall the taller child of a
+ * @return the new root of the subtree
+ */
+size_t rotate_up(aabb_tree_t *tree, size_t a, size_t tall) {
+    aabb_tree_node_t *node_a = &tree->nodes[a];
+    aabb_tree_node_t *node_tall = &tree->nodes[tall];
+    size_t grandchild1 = node_tall->child1;
+    size_t grandchild2 = node_tall->child2;
+
+    // tall takes a's place, with a as its first child
+    node_tall->child1 = a;
+    node_tall->parent = node_a->parent;
+    node_a->parent = tall;
+    tree_replace_child(tree, node_tall->parent, a, tall);
+
+    // The taller grandchild stays under tall, the other replaces tall under a
+    size_t keep = grandchild1, move = grandchild2;
+    if (tree->nodes[grandchild2].height > tree->nodes[grandchild1].height) {
+        keep = grandchild2;
+        move = grandchild1;
+    }
+    node_tall->child2 = keep;
+    if (node_a->child1 == tall) {
+        node_a->child1 = move;
+    } else {
+        node_a->child2 = move;
+    }
+    tree->nodes[move].parent = a;
+    tree_refit_node(tree, a);
+    tree_refit_node(tree, tall);
+    return tall;
+}
+
+/**
+ * Helper function.
+ * Performs a rotation at a node if its subtree is unbalanced.
+ *
+ * @return the root of the subtree after balancing
+ */
+size_t tree_balance(aabb_tree_t *tree, size_t a) {
+    aabb_tree_node_t *node_a = &tree->nodes[a];
+    if (tree_is_leaf(node_a) || node_a->height < 2) {
+        return a;
+    }
+    int32_t height_difference = tree->nodes[node_a->child2].height -
+                                tree->nodes[node_a->child1].height;
+    if (height_difference > 1) {
+        return rotate_up(tree, a, node_a->child2);
+    }
+    if (height_difference < -1) {
+        return rotate_up(tree, a, node_a->child1);
+    }
+    return a;
+}
+
+/**
+ * Helper function.
+ * Balances and refits every node from a node up to the root.
+ */
+void fix_upwards(aabb_tree_t *tree, size_t id) {
+    while (id != NULL_NODE) {
+        id = tree_balance(tree, id);
+        tree_refit_node(tree, id);
+        id = tree->nodes[id].parent;
+    }
+}
+
+/**
+ * Helper function.
+ * Finds the node that is cheapest to pair a new leaf with, where the cost is
+ * the total increase in the perimeters of the bounding boxes.
+ */
+size_t find_best_sibling(aabb_tree_t *tree, bounding_box_t leaf_bbox) {
+    size_t id = tree->root;
+    while (!tree_is_leaf(&tree->nodes[id])) {
+        aabb_tree_node_t *node = &tree->nodes[id];
+        double perimeter = bounding_box_perimeter(node->bbox);
+        double combined_perimeter =
+            bounding_box_perimeter(bounding_box_union(node->bbox, leaf_bbox));
+        // Cost of making a new parent for this node and the leaf
+        double cost = 2 * combined_perimeter;
+        // Minimum cost added to every ancestor if the leaf goes further down
+        double inheritance_cost = 2 * (combined_perimeter - perimeter);
+
+        double child_costs[2];
+        size_t children[] = {node->child1, node->child2};
+        for (size_t i = 0; i < 2; i++) {
+            aabb_tree_node_t *child = &tree->nodes[children[i]];
+            double child_cost = bounding_box_perimeter(
+                bounding_box_union(child->bbox, leaf_bbox));
+            if (!tree_is_leaf(child)) {
+                child_cost -= bounding_box_perimeter(child->bbox);
+            }
+            child_costs[i] = child_cost + inheritance_cost;
+        }
+        if (cost < child_costs[0] && cost < child_costs[1]) {
+            break;
+        }
+        id = child_costs[0] < child_costs[1] ? children[0] : children[1];
+    }
+    return id;
+}
+
+void tree_insert_leaf(aabb_tree_t *tree, size_t leaf) {
+    if (tree->root == NULL_NODE) {
+        tree->root = leaf;
+        tree->nodes[leaf].parent = NULL_NODE;
+        return;
+    }
+    bounding_box_t leaf_bbox = tree->nodes[leaf].bbox;
+    size_t sibling = find_best_sibling(tree, leaf_bbox);
+
+    // tree_allocate_node() may move the pool, so index it again afterwards
+    size_t new_parent = tree_allocate_node(tree);
+    size_t old_parent = tree->nodes[sibling].parent;
+    aabb_tree_node_t *parent_node = &tree->nodes[new_parent];
+    parent_node->parent = old_parent;
+    parent_node->child1 = sibling;
+    parent_node->child2 = leaf;
+    tree_replace_child(tree, old_parent, sibling, new_parent);
+    tree->nodes[sibling].parent = new_parent;
+    tree->nodes[leaf].parent = new_parent;
+    fix_upwards(tree, new_parent);
+}
+
+void tree_remove_leaf(aabb_tree_t *tree, size_t leaf) {
+    if (leaf == tree->root) {
+        tree->root = NULL_NODE;
+        return;
+    }
+    size_t parent = tree->nodes[leaf].parent;
+    size_t grandparent = tree->nodes[parent].parent;
+    size_t sibling = tree->nodes[parent].child1 == leaf
+                         ? tree->nodes[parent].child2
+                         : tree->nodes[parent].child1;
+    // The sibling takes the parent's place
+    tree_replace_child(tree, grandparent, parent, sibling);
+    tree->nodes[sibling].parent = grandparent;
+    tree_free_node(tree, parent);
+    fix_upwards(tree, grandparent);
+}
+
+size_t aabb_tree_insert(aabb_tree_t *tree, bounding_box_t bbox, void *data) {
+    size_t leaf = tree_allocate_node(tree);
+    tree->nodes[leaf].bbox = bounding_box_expand(bbox, tree->margin);
+    tree->nodes[leaf].data = data;
+    tree_insert_leaf(tree, leaf);
+    return leaf;
+}
+
+void aabb_tree_remove(aabb_tree_t *tree, size_t leaf) {
+    assert(leaf < tree->capacity && tree->nodes[leaf].height == 0);
+    tree_remove_leaf(tree, leaf);
+    tree_free_node(tree, leaf);
+}
+
+bool aabb_tree_move(aabb_tree_t *tree, size_t leaf, bounding_box_t bbox) {
+    assert(leaf < tree->capacity && tree->nodes[leaf].height == 0);
+    if (bounding_box_contains(tree->nodes[leaf].bbox, bbox)) {
+        return false;
+    }
+    tree_remove_leaf(tree, leaf);
+    tree->nodes[leaf].bbox = bounding_box_expand(bbox, tree->margin);
+    tree_insert_leaf(tree, leaf);
+    return true;
+}
+
+bounding_box_t aabb_tree_get_fat_bounding_box(aabb_tree_t *tree, size_t leaf) {
+    assert(leaf < tree->capacity && tree->nodes[leaf].height == 0);
+    return tree->nodes[leaf].bbox;
+}
+
+size_t aabb_tree_get_height(aabb_tree_t *tree) {
+    return tree->root == NULL_NODE ? 0 : tree->nodes[tree->root].height;
+}
+
+/**
+ * The shape searched for by a query.
+ */
+typedef struct aabb_tree_query {
+    bool (*test)(bounding_box_t bbox, struct aabb_tree_query *query);
+    bounding_box_t region;
+    vector_t start;
+    vector_t end;
+} aabb_tree_query_t;
+
+bool node_overlaps_region(bounding_box_t bbox, aabb_tree_query_t *query) {
+    return bounding_box_overlaps(bbox, query->region);
+}
+
+bool node_contains_point(bounding_box_t bbox, aabb_tree_query_t *query) {
+    return bbox.min_x <= query->start.x && query->start.x <= bbox.max_x &&
+           bbox.min_y <= query->start.y && query->start.y <= bbox.max_y;
+}
+
+bool node_crosses_segment(bounding_box_t bbox, aabb_tree_query_t *query) {
+    return bounding_box_intersects_segment(bbox, query->start, query->end);
+}
+
+/**
+ * Helper function.
+ * Visits every node that passes the query's test, depth first.
+ * Subtrees of nodes that fail the test are skipped.
+ */
+void run_query(aabb_tree_t *tree, aabb_tree_query_t *query,
+               aabb_tree_query_callback_t callback, void *aux) {
+    if (tree->root == NULL_NODE) {
+        return;
+    }
+    size_t stack_size = 0;
+    tree->stack[stack_size++] = tree->root;
+    while (stack_size > 0) {
+        size_t id = tree->stack[--stack_size];
+        aabb_tree_node_t *node = &tree->nodes[id];
+        if (!query->test(node->bbox, query)) {
+            continue;
+        }
+        if (tree_is_leaf(node)) {
+            if (!callback(node->data, aux)) {
+                return;
+            }
+            continue;
+        }
+        if (stack_size + 2 > tree->stack_capacity) {
+            tree->stack_capacity *= 2;
+            tree->stack =
+                realloc(tree->stack, sizeof(size_t) * tree->stack_capacity);
+            assert(tree->stack);
+        }
+        // Push the second child first so the first child is visited first
+        tree->stack[stack_size++] = node->child2;
+        tree->stack[stack_size++] = node->child1;
+    }
+}
+
+void aabb_tree_query_region(aabb_tree_t *tree, bounding_box_t region,
+                            aabb_tree_query_callback_t callback, void *aux) {
+    aabb_tree_query_t query = {.test = node_overlaps_region, .region = region};
+    run_query(tree, &query, callback, aux);
+}
+
+void aabb_tree_query_point(aabb_tree_t *tree, vector_t point,
+                           aabb_tree_query_callback_t callback, void *aux) {
+    aabb_tree_query_t query = {.test = node_contains_point, .start = point};
+    run_query(tree, &query, callback, aux);
+}
+
+void aabb_tree_query_segment(aabb_tree_t *tree, vector_t start, vector_t end,
+                             aabb_tree_query_callback_t callback, void *aux) {
+    aabb_tree_query_t query = {
+        .test = node_crosses_segment, .start = start, .end = end};
+    run_query(tree, &query, callback, aux);
+}
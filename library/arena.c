@@ -0,0 +1,111 @@
+#include "arena.h"
+#include <assert.h>
+#include <stdalign.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+/**
+ * A block of memory that objects are allocated from, front to back.
+ * capacity - the number of bytes after the header that objects can use
+ * used - the number of those bytes that have been allocated
+ * next - the chunk to allocate from once this one is full. The chunks
+ *      after the current one are empty, and are kept to be reused.
+ */
+typedef struct chunk {
+    size_t capacity;
+    size_t used;
+    struct chunk *next;
+    alignas(max_align_t) char data[];
+} chunk_t;
+
+/**
+ * first - the first chunk, or NULL if nothing has been allocated yet
+ * current - the chunk being allocated from
+ */
+struct arena {
+    size_t chunk_size;
+    chunk_t *first;
+    chunk_t *current;
+    size_t bytes_used;
+    size_t bytes_reserved;
+};
+
+arena_t *arena_init(size_t chunk_size) {
+    assert(chunk_size > 0);
+    arena_t *arena = malloc(sizeof(arena_t));
+    assert(arena);
+    arena->chunk_size = chunk_size;
+    arena->first = NULL;
+    arena->current = NULL;
+    arena->bytes_used = 0;
+    arena->bytes_reserved = 0;
+    return arena;
+}
+
+void arena_free(arena_t *arena) {
+    chunk_t *chunk = arena->first;
+    while (chunk) {
+        chunk_t *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    free(arena);
+}
+
+/**
+ * Helper function.
+ * Allocates an empty chunk with room for at least the given number of bytes.
+ */
+chunk_t *chunk_init(arena_t *arena, size_t size) {
+    size_t capacity = size > arena->chunk_size ? size : arena->chunk_size;
+    chunk_t *chunk = malloc(sizeof(chunk_t) + capacity);
+    assert(chunk);
+    chunk->capacity = capacity;
+    chunk->used = 0;
+    chunk->next = NULL;
+    arena->bytes_reserved += capacity;
+    return chunk;
+}
+
+void *arena_alloc(arena_t *arena, size_t size) {
+    // Every object starts where any type can
+    size_t padded_size = (size + alignof(max_align_t) - 1) /
+                         alignof(max_align_t) * alignof(max_align_t);
+    chunk_t *chunk = arena->current;
+    if (!chunk) {
+        chunk = arena->first = chunk_init(arena, padded_size);
+    }
+    while (chunk->capacity - chunk->used < padded_size) {
+        if (!chunk->next) {
+            chunk->next = chunk_init(arena, padded_size);
+        } else if (chunk->next->capacity < padded_size) {
+            // Too small for this object, but the next objects may fit in it
+            chunk_t *large = chunk_init(arena, padded_size);
+            large->next = chunk->next;
+            chunk->next = large;
+        }
+        chunk = chunk->next;
+        chunk->used = 0;
+    }
+    arena->current = chunk;
+    void *result = chunk->data + chunk->used;
+    chunk->used += padded_size;
+    arena->bytes_used += padded_size;
+    return result;
+}
+
+void arena_reset(arena_t *arena) {
+    arena->current = arena->first;
+    if (arena->first) {
+        arena->first->used = 0;
+    }
+    arena->bytes_used = 0;
+}
+
+size_t arena_bytes_used(arena_t *arena) {
+    return arena->bytes_used;
+}
+
+size_t arena_bytes_reserved(arena_t *arena) {
+    return arena->bytes_reserved;
+}
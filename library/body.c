@@ -5,55 +5,461 @@
 #include "utils.h"
 #include <assert.h>
 #include <float.h>
+#include <math.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
-typedef struct body {
-    list_t *shape;
-    double mass;
-    rgba_color_t color;
-    texture_wrapper_t *texture;
+// The number of collision results each body remembers
+#define COLLISION_CACHE_SIZE 4
+// The number of results in each set of a body's cache, which a pair's result
+// can be stored in any of
+#define COLLISION_CACHE_WAYS 2
+// The number of buckets in the table of shape prototypes
+#define SHAPE_PROTOTYPE_BUCKETS 256
+// The grid that local vertices are snapped to when interned, so shapes that
+// only differ by rounding share a prototype
+#define SHAPE_VERTEX_TOLERANCE 1e-9
+
+/**
+ * A collision result remembered for a pair of bodies. It stays valid until
+ * either body's shape changes, which gives the body a new shape version.
+ * Entries are stored in the body of the pair with the lower address, in the
+ * set picked by the other body's address, most recently stored first.
+ *
+ * other - the other body of the pair, or NULL for an unused entry
+ * version - the shape version of the body storing the entry
+ * other_version - the shape version of the other body
+ * info - the collision, with the axis pointing towards the other body
+ */
+typedef struct collision_cache_entry {
+    body_t *other;
+    size_t version;
+    size_t other_version;
+    collision_info_t info;
+} collision_cache_entry_t;
+
+// The 64-bit golden ratio, which spreads addresses over the cache's sets
+const uint64_t CACHE_HASH_MULTIPLIER = 11400714819323198485ULL;
+
+// Shape versions are unique across all bodies, so an entry for a freed body
+// never matches a new body allocated at the same address
+size_t next_shape_version = 1;
+
+// The parameters of the FNV-1a hash that shape prototypes are interned by
+const uint64_t SHAPE_HASH_OFFSET_BASIS = 14695981039346656037ULL;
+const uint64_t SHAPE_HASH_PRIME = 1099511628211ULL;
+
+/**
+ * A polygon in local space: relative to the centroid of the bodies using it,
+ * at orientation 0. Prototypes are interned, so every body made from the same
+ * shape shares one, wherever the bodies are. A prototype is freed along with
+ * the last body using it.
+ *
+ * vertices - the polygon, which never changes once interned
+ * edge_normals - the edge normals of the polygon, at orientation 0
+ * hash - the hash of the vertices' grid points, which picks the bucket
+ * num_refs - the number of bodies using the prototype
+ * next - the next prototype in the same bucket
+ */
+typedef struct shape_prototype {
+    polygon_t *vertices;
+    edge_normals_t edge_normals;
+    size_t hash;
+    size_t num_refs;
+    struct shape_prototype *next;
+} shape_prototype_t;
+
+// The interned prototypes, chained by hash. Bodies are only made and freed by
+// one thread at a time, so the table isn't locked.
+shape_prototype_t *shape_prototypes[SHAPE_PROTOTYPE_BUCKETS];
+size_t num_shape_prototypes = 0;
+
+// The initial capacity of a store's arrays
+const size_t DEFAULT_BODY_STORE_CAPACITY = 16;
+
+/**
+ * The motion state of one body, laid out so that a body that isn't in a store
+ * can be its own store of one body.
+ */
+typedef struct body_motion {
+    body_t *body;
+    vector_t centroid;
     vector_t velocity;
     vector_t acceleration;
-    double orientation;
-    vector_t centroid;
-    double angular_velocity;
     vector_t net_force;
     vector_t net_impulse;
+    vector_t displacement;
+    double mass;
+    double orientation;
+    double angular_velocity;
+    double rotation;
+} body_motion_t;
+
+/**
+ * Parallel arrays of the motion state of the bodies in a store. The body at
+ * bodies[i] has its state at index i of every array.
+ * displacements, rotations - how far each body moves in the tick being
+ *      integrated, until the body is moved (see body_store_integrate())
+ */
+struct body_store {
+    size_t size;
+    size_t capacity;
+    body_t **bodies;
+    vector_t *centroids;
+    vector_t *velocities;
+    vector_t *accelerations;
+    vector_t *net_forces;
+    vector_t *net_impulses;
+    vector_t *displacements;
+    double *masses;
+    double *orientations;
+    double *angular_velocities;
+    double *rotations;
+};
+
+/**
+ * shape - the body's polygon, in local space
+ * collision_shape - the body's collision proxy in local space, or NULL unless
+ *      it has a polygon proxy
+ * world_shape, world_collision_shape, edge_normals - the polygons and the
+ *      normals of the edges that the body collides with, at the body's
+ *      centroid and orientation. They are only updated when they are used
+ *      after the body moves (see update_world_shape()), and are NULL until
+ *      first used.
+ * world_version - the shape version that the world-space polygons were last
+ *      updated at, or 0 if they need to be updated
+ * world_orientation, world_cos, world_sin - the orientation that edge_normals
+ *      were last rotated to, and its cosine and sine. Translations keep them,
+ *      so only rotations redo the trigonometry and the normals.
+ * is_bounding_box_stale - whether the body rotated since its bounding box was
+ *      computed. Translations move the box along with the body.
+ * store - the store holding the body's motion state: either a scene's store,
+ *      or own_store, whose arrays point into own_motion
+ * index - the index of the body's state in the store's arrays
+ * release_handler, release_aux - what the body is handed to instead of being
+ *      freed by a scene, if anything (see body_release())
+ */
+typedef struct body {
+    shape_prototype_t *shape;
+    shape_prototype_t *collision_shape;
+    bool is_round;
+    capsule_t capsule;
+    polygon_t *world_shape;
+    polygon_t *world_collision_shape;
+    edge_normals_t edge_normals;
+    size_t world_version;
+    double world_orientation;
+    double world_cos;
+    double world_sin;
+    body_store_t *store;
+    size_t index;
+    body_store_t own_store;
+    body_motion_t own_motion;
+    rgba_color_t color;
+    texture_wrapper_t *texture;
+    bounding_box_t bounding_box;
+    bool is_bounding_box_stale;
     bool is_marked_for_removal;
+    bool is_static;
+    bool is_continuous;
+    sensor_mode_t sensor_mode;
+    collision_method_t collision_method;
+    uint32_t collision_layers;
     void *info;
     free_func_t info_freer;
+    body_release_handler_t release_handler;
+    void *release_aux;
+    size_t shape_version;
+    collision_cache_entry_t collision_cache[COLLISION_CACHE_SIZE];
 } body_t;
 
-body_t *body_init(list_t *shape, double mass, rgba_color_t color) {
+// A field of a body's motion state, in the arrays of the body's store
+#define MOTION(body, array) ((body)->store->array[(body)->index])
+
+/**
+ * Helper function.
+ * Makes a body the only body of its own store, which holds the state in
+ * own_motion.
+ */
+void use_own_store(body_t *body) {
+    body_motion_t *motion = &body->own_motion;
+    motion->body = body;
+    body->own_store = (body_store_t){.size = 1,
+                                     .capacity = 1,
+                                     .bodies = &motion->body,
+                                     .centroids = &motion->centroid,
+                                     .velocities = &motion->velocity,
+                                     .accelerations = &motion->acceleration,
+                                     .net_forces = &motion->net_force,
+                                     .net_impulses = &motion->net_impulse,
+                                     .displacements = &motion->displacement,
+                                     .masses = &motion->mass,
+                                     .orientations = &motion->orientation,
+                                     .angular_velocities =
+                                         &motion->angular_velocity,
+                                     .rotations = &motion->rotation};
+    body->store = &body->own_store;
+    body->index = 0;
+}
+
+/**
+ * Helper function.
+ * Returns the index of the point of the vertex grid nearest to a coordinate.
+ */
+int64_t quantize_coordinate(double coordinate) {
+    return llround(coordinate / SHAPE_VERTEX_TOLERANCE);
+}
+
+/**
+ * Helper function.
+ * Hashes the grid points of a polygon's vertices.
+ */
+size_t hash_shape(polygon_t *shape) {
+    uint64_t hash = SHAPE_HASH_OFFSET_BASIS;
+    for (size_t i = 0; i < shape->num_vertices; i++) {
+        int64_t coordinates[2] = {quantize_coordinate(shape->vertices[i].x),
+                                  quantize_coordinate(shape->vertices[i].y)};
+        const unsigned char *bytes = (const unsigned char *)coordinates;
+        for (size_t b = 0; b < sizeof(coordinates); b++) {
+            hash ^= bytes[b];
+            hash *= SHAPE_HASH_PRIME;
+        }
+    }
+    return (size_t)hash;
+}
+
+/**
+ * Helper function.
+ * Returns whether two polygons have the same vertices, up to half the vertex
+ * tolerance.
+ */
+bool shapes_equal(polygon_t *shape1, polygon_t *shape2) {
+    if (shape1->num_vertices != shape2->num_vertices) {
+        return false;
+    }
+    for (size_t i = 0; i < shape1->num_vertices; i++) {
+        vector_t *vertex1 = &shape1->vertices[i];
+        vector_t *vertex2 = &shape2->vertices[i];
+        if (fabs(vertex1->x - vertex2->x) > SHAPE_VERTEX_TOLERANCE / 2 ||
+            fabs(vertex1->y - vertex2->y) > SHAPE_VERTEX_TOLERANCE / 2) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Helper function.
+ * Moves a polygon into the local space of a body at a centroid and
+ * orientation, snapping its vertices to the vertex grid, and returns the
+ * prototype of the polygon, which is created if no body uses the same polygon
+ * yet. Takes ownership of the polygon.
+ */
+shape_prototype_t *shape_prototype_intern(polygon_t *shape, vector_t centroid,
+                                          double orientation) {
+    for (size_t i = 0; i < shape->num_vertices; i++) {
+        vector_t *vertex = &shape->vertices[i];
+        *vertex = vec_subtract(*vertex, centroid);
+        if (orientation != 0) {
+            *vertex = vec_rotate(*vertex, -orientation);
+        }
+        vertex->x = quantize_coordinate(vertex->x) * SHAPE_VERTEX_TOLERANCE;
+        vertex->y = quantize_coordinate(vertex->y) * SHAPE_VERTEX_TOLERANCE;
+    }
+    size_t hash = hash_shape(shape);
+    shape_prototype_t **bucket =
+        &shape_prototypes[hash % SHAPE_PROTOTYPE_BUCKETS];
+    for (shape_prototype_t *prototype = *bucket; prototype;
+         prototype = prototype->next) {
+        if (prototype->hash == hash &&
+            shapes_equal(prototype->vertices, shape)) {
+            polygon_free(shape);
+            prototype->num_refs++;
+            return prototype;
+        }
+    }
+    shape_prototype_t *prototype = malloc(sizeof(shape_prototype_t));
+    assert(prototype);
+    prototype->vertices = shape;
+    prototype->edge_normals.normals =
+        malloc(shape->num_vertices * sizeof(vector_t));
+    assert(prototype->edge_normals.normals);
+    find_edge_normals(shape, &prototype->edge_normals);
+    prototype->hash = hash;
+    prototype->num_refs = 1;
+    prototype->next = *bucket;
+    *bucket = prototype;
+    num_shape_prototypes++;
+    return prototype;
+}
+
+/**
+ * Helper function.
+ * Stops a body from using a prototype, and frees it if no body uses it.
+ */
+void shape_prototype_release(shape_prototype_t *prototype) {
+    prototype->num_refs--;
+    if (prototype->num_refs > 0) {
+        return;
+    }
+    shape_prototype_t **link =
+        &shape_prototypes[prototype->hash % SHAPE_PROTOTYPE_BUCKETS];
+    while (*link != prototype) {
+        link = &(*link)->next;
+    }
+    *link = prototype->next;
+    polygon_free(prototype->vertices);
+    free(prototype->edge_normals.normals);
+    free(prototype);
+    num_shape_prototypes--;
+}
+
+/**
+ * Helper function.
+ * Places the vertices of a local-space polygon at a centroid, rotated by the
+ * angle with the given cosine and sine.
+ */
+void place_shape(polygon_t *local_shape, polygon_t *world_shape,
+                 vector_t centroid, double cos_angle, double sin_angle) {
+    for (size_t i = 0; i < local_shape->num_vertices; i++) {
+        vector_t *local = &local_shape->vertices[i];
+        vector_t *world = &world_shape->vertices[i];
+        world->x = centroid.x + local->x * cos_angle - local->y * sin_angle;
+        world->y = centroid.y + local->x * sin_angle + local->y * cos_angle;
+    }
+}
+
+/**
+ * Helper function.
+ * Brings a body's world-space polygons and edge normals up to date with its
+ * centroid and orientation, if it moved since they were last updated.
+ */
+void update_world_shape(body_t *body) {
+    if (body->world_version == body->shape_version) {
+        return;
+    }
+    if (!body->world_shape) {
+        body->world_shape = polygon_copy(body->shape->vertices);
+    }
+    if (body->collision_shape && !body->world_collision_shape) {
+        body->world_collision_shape =
+            polygon_copy(body->collision_shape->vertices);
+    }
+    shape_prototype_t *collision_prototype =
+        body->collision_shape ? body->collision_shape : body->shape;
+    edge_normals_t *base_normals = &collision_prototype->edge_normals;
+    double orientation = MOTION(body, orientations);
+    bool is_rotated = !body->edge_normals.normals ||
+                      orientation != body->world_orientation;
+    if (!body->edge_normals.normals) {
+        body->edge_normals.normals = malloc(
+            collision_prototype->vertices->num_vertices * sizeof(vector_t));
+        assert(body->edge_normals.normals);
+    }
+    if (is_rotated) {
+        double cos_angle = cos(orientation);
+        double sin_angle = sin(orientation);
+        for (size_t i = 0; i < base_normals->num_normals; i++) {
+            vector_t normal = base_normals->normals[i];
+            body->edge_normals.normals[i] =
+                (vector_t){.x = normal.x * cos_angle - normal.y * sin_angle,
+                           .y = normal.x * sin_angle + normal.y * cos_angle};
+        }
+        body->edge_normals.num_normals = base_normals->num_normals;
+        body->world_orientation = orientation;
+        body->world_cos = cos_angle;
+        body->world_sin = sin_angle;
+    }
+
+    vector_t centroid = MOTION(body, centroids);
+    place_shape(body->shape->vertices, body->world_shape, centroid,
+                body->world_cos, body->world_sin);
+    if (body->collision_shape) {
+        place_shape(body->collision_shape->vertices,
+                    body->world_collision_shape, centroid, body->world_cos,
+                    body->world_sin);
+    }
+    body->world_version = body->shape_version;
+}
+
+/**
+ * Helper function.
+ * Frees the world-space state that depends on a body's collision shape, after
+ * the collision shape changes.
+ */
+void forget_world_collision_shape(body_t *body) {
+    if (body->world_collision_shape) {
+        polygon_free(body->world_collision_shape);
+        body->world_collision_shape = NULL;
+    }
+    free(body->edge_normals.normals);
+    body->edge_normals = (edge_normals_t){.normals = NULL, .num_normals = 0};
+    body->world_version = 0;
+}
+
+body_t *body_init(polygon_t *shape, double mass, rgba_color_t color) {
     return body_init_with_info(shape, mass, color, NULL, NULL);
 }
 
-body_t *body_init_with_info(list_t *shape, double mass, rgba_color_t color,
+body_t *body_init_with_info(polygon_t *shape, double mass, rgba_color_t color,
                             void *info, free_func_t info_freer) {
     body_t *body = malloc(sizeof(body_t));
     assert(body);
     bounding_box_t bbox = polygon_get_bounding_box(shape);
-    *(body) = (body_t){.shape = shape,
-                       .mass = mass,
+    vector_t centroid = polygon_centroid(shape);
+    *(body) = (body_t){.shape = shape_prototype_intern(shape, centroid, 0),
+                       .collision_shape = NULL,
+                       .is_round = false,
+                       .world_shape = NULL,
+                       .world_collision_shape = NULL,
+                       .edge_normals = {.normals = NULL, .num_normals = 0},
+                       .world_version = 0,
+                       .world_orientation = 0,
+                       .world_cos = 1,
+                       .world_sin = 0,
+                       .own_motion = {.centroid = centroid,
+                                      .velocity = VEC_ZERO,
+                                      .acceleration = VEC_ZERO,
+                                      .net_force = VEC_ZERO,
+                                      .net_impulse = VEC_ZERO,
+                                      .displacement = VEC_ZERO,
+                                      .mass = mass,
+                                      .orientation = 0,
+                                      .angular_velocity = 0,
+                                      .rotation = 0},
                        .color = color,
                        .texture = texture_wrapper_init(bbox),
-                       .velocity = VEC_ZERO,
-                       .acceleration = VEC_ZERO,
-                       .orientation = 0,
-                       .centroid = polygon_centroid(shape),
-                       .angular_velocity = 0,
-                       .net_force = VEC_ZERO,
-                       .net_impulse = VEC_ZERO,
+                       .bounding_box = bbox,
+                       .is_bounding_box_stale = false,
                        .is_marked_for_removal = false,
+                       .is_static = false,
+                       .is_continuous = false,
+                       .sensor_mode = SENSOR_NONE,
+                       .collision_method = COLLISION_METHOD_AUTO,
+                       .collision_layers = 0,
                        .info = info,
-                       .info_freer = info_freer};
+                       .info_freer = info_freer,
+                       .release_handler = NULL,
+                       .release_aux = NULL,
+                       .shape_version = next_shape_version++,
+                       .collision_cache = {{0}}};
+    use_own_store(body);
     return body;
 }
 
 void body_free(body_t *body) {
-    list_free(body->shape);
+    body_store_remove(body);
+    shape_prototype_release(body->shape);
+    if (body->collision_shape) {
+        shape_prototype_release(body->collision_shape);
+    }
+    if (body->world_shape) {
+        polygon_free(body->world_shape);
+    }
+    forget_world_collision_shape(body);
     if (body->info_freer) {
         body->info_freer(body->info);
     }
@@ -63,20 +469,90 @@ void body_free(body_t *body) {
     free(body);
 }
 
-list_t *body_get_shape(body_t *body) {
-    return list_copy(body->shape, (copy_func_t)vec_copy);
+const polygon_t *body_borrow_shape(body_t *body) {
+    update_world_shape(body);
+    return body->world_shape;
+}
+
+polygon_t *body_get_shape(body_t *body) {
+    return polygon_copy(body_borrow_shape(body));
+}
+
+/**
+ * Helper function.
+ * Returns the polygon a body collides with, without copying it.
+ * Round bodies use their shape for times of impact and raycasts.
+ */
+polygon_t *get_collision_shape(body_t *body) {
+    update_world_shape(body);
+    return body->world_collision_shape ? body->world_collision_shape
+                                       : body->world_shape;
+}
+
+const polygon_t *body_borrow_collision_shape(body_t *body) {
+    return get_collision_shape(body);
+}
+
+polygon_t *body_get_collision_shape(body_t *body) {
+    return polygon_copy(get_collision_shape(body));
+}
+
+/**
+ * Helper function.
+ * Recomputes the bounding box of a body, which contains both its shape and
+ * its collision proxy.
+ */
+void update_bounding_box(body_t *body) {
+    update_world_shape(body);
+    body->bounding_box = polygon_get_bounding_box(body->world_shape);
+    if (body->world_collision_shape) {
+        body->bounding_box = bounding_box_union(
+            body->bounding_box,
+            polygon_get_bounding_box(body->world_collision_shape));
+    }
+    if (body->is_round) {
+        capsule_t capsule = body->capsule;
+        bounding_box_t capsule_bbox = {
+            .min_x = fmin(capsule.start.x, capsule.end.x) - capsule.radius,
+            .min_y = fmin(capsule.start.y, capsule.end.y) - capsule.radius,
+            .max_x = fmax(capsule.start.x, capsule.end.x) + capsule.radius,
+            .max_y = fmax(capsule.start.y, capsule.end.y) + capsule.radius};
+        body->bounding_box =
+            bounding_box_union(body->bounding_box, capsule_bbox);
+    }
+    body->is_bounding_box_stale = false;
+}
+
+/**
+ * Helper function.
+ * Returns a body's bounding box, recomputing it if the body rotated.
+ */
+bounding_box_t get_bounding_box(body_t *body) {
+    if (body->is_bounding_box_stale) {
+        update_bounding_box(body);
+    }
+    return body->bounding_box;
+}
+
+void body_update_shape(body_t *body) {
+    update_world_shape(body);
+    get_bounding_box(body);
+}
+
+size_t body_shape_prototypes(void) {
+    return num_shape_prototypes;
 }
 
 vector_t body_get_centroid(body_t *body) {
-    return body->centroid;
+    return MOTION(body, centroids);
 }
 
 vector_t body_get_velocity(body_t *body) {
-    return body->velocity;
+    return MOTION(body, velocities);
 }
 
 double body_get_mass(body_t *body) {
-    return body->mass;
+    return MOTION(body, masses);
 }
 
 rgba_color_t body_get_color(body_t *body) {
@@ -88,24 +564,44 @@ texture_wrapper_t *body_get_texture(body_t *body) {
 }
 
 bounding_box_t body_get_bounding_box(body_t *body) {
-    return polygon_get_bounding_box(body->shape);
+    return get_bounding_box(body);
 }
 
 vector_t body_get_acceleration(body_t *body) {
-    return body->acceleration;
+    return MOTION(body, accelerations);
 }
 
 void body_translate(body_t *body, vector_t translation) {
-    polygon_translate(body->shape, translation);
-    body->centroid = vec_add(body->centroid, translation);
+    if (translation.x == 0 && translation.y == 0) {
+        return;
+    }
+    body->capsule.start = vec_add(body->capsule.start, translation);
+    body->capsule.end = vec_add(body->capsule.end, translation);
+    MOTION(body, centroids) = vec_add(MOTION(body, centroids), translation);
+    if (!body->is_bounding_box_stale) {
+        body->bounding_box =
+            bounding_box_translate(body->bounding_box, translation);
+    }
+    body->shape_version = next_shape_version++;
     if (body->texture) {
         texture_translate(body->texture, translation);
     }
 }
 
 void body_rotate(body_t *body, double angle) {
-    polygon_rotate(body->shape, angle, body->centroid);
-    body->orientation += angle;
+    if (angle == 0) {
+        return;
+    }
+    vector_t centroid = MOTION(body, centroids);
+    body->capsule.start = vec_add(
+        centroid,
+        vec_rotate(vec_subtract(body->capsule.start, centroid), angle));
+    body->capsule.end = vec_add(
+        centroid, vec_rotate(vec_subtract(body->capsule.end, centroid), angle));
+    // The vertices and the bounding box are only updated when they are used
+    body->is_bounding_box_stale = true;
+    body->shape_version = next_shape_version++;
+    MOTION(body, orientations) += angle;
 }
 
 void *body_get_info(body_t *body) {
@@ -132,16 +628,16 @@ void body_set_visibility(body_t *body, bool visibility) {
 }
 
 void body_set_centroid(body_t *body, vector_t x) {
-    vector_t displacement = vec_subtract(x, body->centroid);
+    vector_t displacement = vec_subtract(x, MOTION(body, centroids));
     body_translate(body, displacement);
 }
 
 void body_set_velocity(body_t *body, vector_t v) {
-    body->velocity = v;
+    MOTION(body, velocities) = v;
 }
 
 void body_set_mass(body_t *body, double mass) {
-    body->mass = mass;
+    MOTION(body, masses) = mass;
 }
 
 void body_set_color(body_t *body, rgba_color_t color) {
@@ -149,20 +645,20 @@ void body_set_color(body_t *body, rgba_color_t color) {
 }
 
 void body_set_angular_velocity(body_t *body, double angular_velocity) {
-    body->angular_velocity = angular_velocity;
+    MOTION(body, angular_velocities) = angular_velocity;
 }
 
 void body_set_rotation(body_t *body, double angle) {
-    double d_theta = angle - body->orientation;
+    double d_theta = angle - MOTION(body, orientations);
     body_rotate(body, d_theta);
 }
 
 void body_add_force(body_t *body, vector_t force) {
-    body->net_force = vec_add(body->net_force, force);
+    MOTION(body, net_forces) = vec_add(MOTION(body, net_forces), force);
 }
 
 void body_add_impulse(body_t *body, vector_t impulse) {
-    body->net_impulse = vec_add(body->net_impulse, impulse);
+    MOTION(body, net_impulses) = vec_add(MOTION(body, net_impulses), impulse);
 }
 
 /**
@@ -176,7 +672,37 @@ void body_add_impulse(body_t *body, vector_t impulse) {
  *               rotated.
  */
 void update_rotation(body_t *body, double dt) {
-    body_rotate(body, dt * body->angular_velocity);
+    body_rotate(body, dt * MOTION(body, angular_velocities));
+}
+
+/**
+ * Helper function.
+ * Integrates the motion of a range of the bodies in a store over a tick.
+ * Sets their velocities and accelerations according to the forces and
+ * impulses applied to them, resets those, and records how far they should
+ * move. The loop only touches the store's arrays, one index at a time.
+ */
+void integrate_bodies(body_store_t *store, size_t start, size_t end,
+                      double dt) {
+    for (size_t i = start; i < end; i++) {
+        double mass = store->masses[i];
+        // Massless and infinitely heavy bodies keep their velocity
+        double inverse_mass = (mass != 0 && mass != INFINITY) ? 1 / mass : 0;
+        vector_t velocity = store->velocities[i];
+        vector_t next_velocity = vec_add(
+            vec_add(velocity,
+                    vec_multiply(dt * inverse_mass, store->net_forces[i])),
+            vec_multiply(inverse_mass, store->net_impulses[i]));
+        store->net_forces[i] = VEC_ZERO;
+        store->net_impulses[i] = VEC_ZERO;
+        // Bodies move at the average of the velocities before and after
+        store->displacements[i] =
+            vec_multiply(dt / 2, vec_add(velocity, next_velocity));
+        store->rotations[i] = dt * store->angular_velocities[i];
+        store->accelerations[i] =
+            vec_multiply(1 / dt, vec_subtract(next_velocity, velocity));
+        store->velocities[i] = next_velocity;
+    }
 }
 
 /**
@@ -190,46 +716,201 @@ void update_rotation(body_t *body, double dt) {
  *               translated.
  */
 void update_translation(body_t *body, double dt) {
-    vector_t next_velocity = body->velocity;
-    if ((body->mass != 0) && (body->mass != INFINITY)) {
-        next_velocity = vec_add(next_velocity,
-                                vec_multiply(dt / body->mass, body->net_force));
-        next_velocity = vec_add(
-            next_velocity, vec_multiply(1 / body->mass, body->net_impulse));
-    }
-    body->net_force = VEC_ZERO;
-    body->net_impulse = VEC_ZERO;
-    body_translate(
-        body, vec_multiply(dt / 2, vec_add(body->velocity, next_velocity)));
-    body->velocity = next_velocity;
+    integrate_bodies(body->store, body->index, body->index + 1, dt);
+    MOTION(body, rotations) = 0;
+    body_apply_integration(body);
 }
 
 void body_tick(body_t *body, double dt) {
-    vector_t old_velocity = body_get_velocity(body);
-    update_translation(body, dt);
-    update_rotation(body, dt);
-    vector_t new_velocity = body_get_velocity(body);
-    vector_t accel = vec_multiply(1/dt, vec_subtract(new_velocity, old_velocity));
-    body->acceleration = accel;
+    if (body->is_static) {
+        // Static bodies never move, so only the accumulated forces are reset
+        MOTION(body, net_forces) = VEC_ZERO;
+        MOTION(body, net_impulses) = VEC_ZERO;
+        return;
+    }
+    integrate_bodies(body->store, body->index, body->index + 1, dt);
+    body_apply_integration(body);
+}
+
+void body_apply_integration(body_t *body) {
+    vector_t displacement = MOTION(body, displacements);
+    double rotation = MOTION(body, rotations);
+    MOTION(body, displacements) = VEC_ZERO;
+    MOTION(body, rotations) = 0;
+    body_translate(body, displacement);
+    body_rotate(body, rotation);
+}
+
+/**
+ * Helper function.
+ * Copies the motion state at one index of a store to an index of another.
+ */
+void copy_motion(body_store_t *from, size_t from_index, body_store_t *to,
+                 size_t to_index) {
+    to->bodies[to_index] = from->bodies[from_index];
+    to->centroids[to_index] = from->centroids[from_index];
+    to->velocities[to_index] = from->velocities[from_index];
+    to->accelerations[to_index] = from->accelerations[from_index];
+    to->net_forces[to_index] = from->net_forces[from_index];
+    to->net_impulses[to_index] = from->net_impulses[from_index];
+    to->displacements[to_index] = from->displacements[from_index];
+    to->masses[to_index] = from->masses[from_index];
+    to->orientations[to_index] = from->orientations[from_index];
+    to->angular_velocities[to_index] = from->angular_velocities[from_index];
+    to->rotations[to_index] = from->rotations[from_index];
+}
+
+/**
+ * Helper function.
+ * Resizes one of the arrays of a store.
+ */
+void *resize_store_array(void *array, size_t capacity, size_t element_size) {
+    array = realloc(array, capacity * element_size);
+    assert(array);
+    return array;
+}
+
+body_store_t *body_store_init(void) {
+    body_store_t *store = malloc(sizeof(body_store_t));
+    assert(store);
+    *store = (body_store_t){.size = 0, .capacity = 0};
+    return store;
+}
+
+void body_store_free(body_store_t *store) {
+    while (store->size > 0) {
+        body_store_remove(store->bodies[store->size - 1]);
+    }
+    free(store->bodies);
+    free(store->centroids);
+    free(store->velocities);
+    free(store->accelerations);
+    free(store->net_forces);
+    free(store->net_impulses);
+    free(store->displacements);
+    free(store->masses);
+    free(store->orientations);
+    free(store->angular_velocities);
+    free(store->rotations);
+    free(store);
+}
+
+size_t body_store_size(body_store_t *store) {
+    return store->size;
+}
+
+void body_store_add(body_store_t *store, body_t *body) {
+    assert(body->store == &body->own_store);
+    if (store->size == store->capacity) {
+        size_t capacity = store->capacity ? 2 * store->capacity
+                                          : DEFAULT_BODY_STORE_CAPACITY;
+        store->bodies =
+            resize_store_array(store->bodies, capacity, sizeof(body_t *));
+        store->centroids =
+            resize_store_array(store->centroids, capacity, sizeof(vector_t));
+        store->velocities =
+            resize_store_array(store->velocities, capacity, sizeof(vector_t));
+        store->accelerations = resize_store_array(store->accelerations,
+                                                  capacity, sizeof(vector_t));
+        store->net_forces =
+            resize_store_array(store->net_forces, capacity, sizeof(vector_t));
+        store->net_impulses = resize_store_array(store->net_impulses, capacity,
+                                                 sizeof(vector_t));
+        store->displacements = resize_store_array(store->displacements,
+                                                  capacity, sizeof(vector_t));
+        store->masses =
+            resize_store_array(store->masses, capacity, sizeof(double));
+        store->orientations =
+            resize_store_array(store->orientations, capacity, sizeof(double));
+        store->angular_velocities = resize_store_array(
+            store->angular_velocities, capacity, sizeof(double));
+        store->rotations =
+            resize_store_array(store->rotations, capacity, sizeof(double));
+        store->capacity = capacity;
+    }
+    copy_motion(body->store, body->index, store, store->size);
+    body->store = store;
+    body->index = store->size;
+    store->size++;
+}
+
+void body_store_remove(body_t *body) {
+    body_store_t *store = body->store;
+    if (store == &body->own_store) {
+        return;
+    }
+    size_t index = body->index;
+    copy_motion(store, index, &body->own_store, 0);
+    body->store = &body->own_store;
+    body->index = 0;
+    // Fill the gap with the last body
+    store->size--;
+    if (index < store->size) {
+        copy_motion(store, store->size, store, index);
+        store->bodies[index]->index = index;
+    }
+}
+
+void body_store_integrate(body_store_t *store, double dt) {
+    integrate_bodies(store, 0, store->size, dt);
 }
 
 body_t *body_copy(body_t *body) {
     body_t *result = malloc(sizeof(body_t));
     assert(result);
-    result->shape = list_copy(body->shape, (copy_func_t)vec_copy);
-    result->mass = body->mass;
+    // The copy shares the body's prototypes, and places its own vertices
+    // when they are used
+    result->shape = body->shape;
+    result->shape->num_refs++;
+    result->collision_shape = body->collision_shape;
+    if (result->collision_shape) {
+        result->collision_shape->num_refs++;
+    }
+    result->is_round = body->is_round;
+    result->capsule = body->capsule;
+    result->world_shape = NULL;
+    result->world_collision_shape = NULL;
+    result->edge_normals = (edge_normals_t){.normals = NULL, .num_normals = 0};
+    result->world_version = 0;
+    result->world_orientation = body->world_orientation;
+    result->world_cos = body->world_cos;
+    result->world_sin = body->world_sin;
     result->color = body->color;
-    result->velocity = body->velocity;
-    result->orientation = body->orientation;
-    result->angular_velocity = body->angular_velocity;
-    result->net_force = body->net_force;
-    result->net_impulse = body->net_impulse;
+    // The copy is never drawn, so it doesn't need its own texture
+    result->texture = NULL;
+    result->bounding_box = body->bounding_box;
+    result->is_bounding_box_stale = body->is_bounding_box_stale;
+    result->own_motion =
+        (body_motion_t){.centroid = MOTION(body, centroids),
+                        .velocity = MOTION(body, velocities),
+                        .acceleration = MOTION(body, accelerations),
+                        .net_force = MOTION(body, net_forces),
+                        .net_impulse = MOTION(body, net_impulses),
+                        .displacement = MOTION(body, displacements),
+                        .mass = MOTION(body, masses),
+                        .orientation = MOTION(body, orientations),
+                        .angular_velocity = MOTION(body, angular_velocities),
+                        .rotation = MOTION(body, rotations)};
+    // The copy is never in a store
+    use_own_store(result);
+    result->is_marked_for_removal = body->is_marked_for_removal;
+    result->is_static = body->is_static;
+    result->is_continuous = body->is_continuous;
+    result->sensor_mode = body->sensor_mode;
+    result->collision_method = body->collision_method;
+    result->collision_layers = body->collision_layers;
     result->info = NULL;
     result->info_freer = NULL;
+    result->release_handler = NULL;
+    result->release_aux = NULL;
+    result->shape_version = next_shape_version++;
+    for (size_t i = 0; i < COLLISION_CACHE_SIZE; i++) {
+        result->collision_cache[i].other = NULL;
+    }
     return result;
 }
 
-list_t *future_body_helper(body_t *body, double dt, bool translate,
+polygon_t *future_body_helper(body_t *body, double dt, bool translate,
                            bool rotate) {
     body_t *future_body = body_copy(body);
     if (translate) {
@@ -238,25 +919,180 @@ list_t *future_body_helper(body_t *body, double dt, bool translate,
     if (rotate) {
         update_rotation(future_body, dt);
     }
-    list_t *result = body_get_shape(future_body);
+    polygon_t *result = body_get_shape(future_body);
     body_free(future_body);
     return result;
 }
 
-list_t *future_body_trans_rot(body_t *body, double dt) {
+polygon_t *future_body_trans_rot(body_t *body, double dt) {
     return future_body_helper(body, dt, true, true);
 }
 
-list_t *future_body_translational(body_t *body, double dt) {
+polygon_t *future_body_translational(body_t *body, double dt) {
     return future_body_helper(body, dt, true, false);
 }
 
-list_t *future_body_rotational(body_t *body, double dt) {
+polygon_t *future_body_rotational(body_t *body, double dt) {
     return future_body_helper(body, dt, false, true);
 }
 
 collision_info_t detect_body_collision(body_t *body1, body_t *body2) {
-    return find_collision(body1->shape, body2->shape);
+    return detect_body_collision_with_hint(body1, body2, NULL);
+}
+
+/**
+ * Helper function.
+ * Treats two overlapping bounding boxes as the shapes of a collision.
+ * The axis is the one the boxes overlap least along.
+ */
+collision_info_t find_bounding_box_collision(bounding_box_t bbox1,
+                                             bounding_box_t bbox2) {
+    double overlap_x =
+        fmin(bbox1.max_x, bbox2.max_x) - fmax(bbox1.min_x, bbox2.min_x);
+    double overlap_y =
+        fmin(bbox1.max_y, bbox2.max_y) - fmax(bbox1.min_y, bbox2.min_y);
+    vector_t offset = vec_subtract(bounding_box_center(bbox2),
+                                   bounding_box_center(bbox1));
+    collision_info_t info = {.collided = PARTIAL_COLLISION};
+    if (overlap_x < overlap_y) {
+        info.axis = (vector_t){.x = offset.x < 0 ? -1 : 1, .y = 0};
+        info.overlap = overlap_x;
+    } else {
+        info.axis = (vector_t){.x = 0, .y = offset.y < 0 ? -1 : 1};
+        info.overlap = overlap_y;
+    }
+    // Like find_collision(), boxes that only touch don't collide
+    if (info.overlap == 0) {
+        info.collided = NO_COLLISION;
+    } else if (bounding_box_contains(bbox1, bbox2) ||
+               bounding_box_contains(bbox2, bbox1)) {
+        info.collided = FULL_COLLISION;
+    }
+    return info;
+}
+
+/**
+ * Helper function.
+ * Detects a collision between two bodies without using the cache.
+ */
+collision_info_t find_body_collision(body_t *body1, body_t *body2,
+                                     vector_t *axis_hint) {
+    bounding_box_t bbox1 = get_bounding_box(body1);
+    bounding_box_t bbox2 = get_bounding_box(body2);
+    if (!bounding_box_overlaps(bbox1, bbox2)) {
+        // The shapes can't collide if their bounding boxes don't.
+        // Like find_collision(), still report an axis from body1 to body2.
+        collision_get_stats()->bounding_box_rejects++;
+        vector_t center1 = bounding_box_center(bbox1);
+        vector_t center2 = bounding_box_center(bbox2);
+        return (collision_info_t){
+            .collided = NO_COLLISION,
+            .axis = vec_direction(vec_subtract(center2, center1)),
+            .overlap = 0};
+    }
+    if (body1->sensor_mode == SENSOR_BOUNDING_BOX ||
+        body2->sensor_mode == SENSOR_BOUNDING_BOX) {
+        return find_bounding_box_collision(bbox1, bbox2);
+    }
+    if (body1->is_round && body2->is_round) {
+        return find_collision_capsules(body1->capsule, body2->capsule);
+    } else if (body1->is_round) {
+        return find_collision_capsule_polygon(body1->capsule,
+                                              get_collision_shape(body2));
+    } else if (body2->is_round) {
+        collision_info_t info = find_collision_capsule_polygon(
+            body2->capsule, get_collision_shape(body1));
+        info.axis = vec_negate(info.axis);
+        return info;
+    }
+    collision_method_t method = body1->collision_method
+                                    ? body1->collision_method
+                                    : body2->collision_method;
+    return find_collision_with_normals(
+        get_collision_shape(body1), &body1->edge_normals,
+        get_collision_shape(body2), &body2->edge_normals, method, axis_hint);
+}
+
+/**
+ * Helper function.
+ * Finds the cache set of a pair of bodies, which belongs to the body with the
+ * lower address.
+ */
+collision_cache_entry_t *get_cache_set(body_t *owner, body_t *other) {
+    // Allocations are aligned, so the low bits of the address are the same
+    // for every body, and only the high bits of the product are well mixed
+    uint64_t hash = ((uint64_t)(uintptr_t)other >> 4) * CACHE_HASH_MULTIPLIER;
+    size_t set = (size_t)(hash >> 32) %
+                 (COLLISION_CACHE_SIZE / COLLISION_CACHE_WAYS);
+    return &owner->collision_cache[set * COLLISION_CACHE_WAYS];
+}
+
+collision_info_t detect_body_collision_with_hint(body_t *body1, body_t *body2,
+                                                 vector_t *axis_hint) {
+    collision_info_t info =
+        detect_body_collision_readonly(body1, body2, axis_hint);
+    body_remember_collision(body1, body2, info);
+    return info;
+}
+
+collision_info_t detect_body_collision_readonly(body_t *body1, body_t *body2,
+                                                vector_t *axis_hint) {
+    // Always detect in the same order, so both orders share one result
+    bool is_swapped = (uintptr_t)body2 < (uintptr_t)body1;
+    body_t *owner = is_swapped ? body2 : body1;
+    body_t *other = is_swapped ? body1 : body2;
+    collision_cache_entry_t *set = get_cache_set(owner, other);
+    collision_cache_entry_t *entry = NULL;
+    for (size_t i = 0; i < COLLISION_CACHE_WAYS; i++) {
+        if (set[i].other == other && set[i].version == owner->shape_version &&
+            set[i].other_version == other->shape_version) {
+            entry = &set[i];
+            break;
+        }
+    }
+    collision_info_t info =
+        entry ? entry->info : find_body_collision(owner, other, axis_hint);
+    if (is_swapped) {
+        info.axis = vec_negate(info.axis);
+    }
+    return info;
+}
+
+void body_remember_collision(body_t *body1, body_t *body2,
+                             collision_info_t info) {
+    bool is_swapped = (uintptr_t)body2 < (uintptr_t)body1;
+    body_t *owner = is_swapped ? body2 : body1;
+    body_t *other = is_swapped ? body1 : body2;
+    if (is_swapped) {
+        info.axis = vec_negate(info.axis);
+    }
+    // The pair's old result makes room if it has one, or else the least
+    // recently stored result of the set
+    collision_cache_entry_t *set = get_cache_set(owner, other);
+    size_t way = COLLISION_CACHE_WAYS - 1;
+    for (size_t i = 0; i < COLLISION_CACHE_WAYS - 1; i++) {
+        if (set[i].other == other) {
+            way = i;
+            break;
+        }
+    }
+    memmove(&set[1], &set[0], way * sizeof(collision_cache_entry_t));
+    set[0] = (collision_cache_entry_t){.other = other,
+                                       .version = owner->shape_version,
+                                       .other_version = other->shape_version,
+                                       .info = info};
+}
+
+double body_time_of_impact(body_t *body1, body_t *body2,
+                           vector_t displacement) {
+    bounding_box_t bbox1 = get_bounding_box(body1);
+    bounding_box_t swept_bbox = bounding_box_union(
+        bbox1, bounding_box_translate(bbox1, displacement));
+    if (!bounding_box_overlaps(swept_bbox, get_bounding_box(body2))) {
+        return INFINITY;
+    }
+    return find_time_of_impact(get_collision_shape(body1),
+                               get_collision_shape(body2), displacement);
 }
 
 void body_remove(body_t *body) {
@@ -266,3 +1102,152 @@ void body_remove(body_t *body) {
 bool body_is_removed(body_t *body) {
     return body->is_marked_for_removal;
 }
+
+void body_set_release_handler(body_t *body, body_release_handler_t handler,
+                              void *aux) {
+    body->release_handler = handler;
+    body->release_aux = aux;
+}
+
+void body_release(body_t *body) {
+    if (!body->release_handler) {
+        body_free(body);
+        return;
+    }
+    body_store_remove(body);
+    // Forces added in the tick the body was removed in were never applied
+    MOTION(body, net_forces) = VEC_ZERO;
+    MOTION(body, net_impulses) = VEC_ZERO;
+    body->is_marked_for_removal = false;
+    body->release_handler(body, body->release_aux);
+}
+
+void body_set_collision_layers(body_t *body, uint32_t layers) {
+    body->collision_layers = layers;
+}
+
+uint32_t body_get_collision_layers(body_t *body) {
+    return body->collision_layers;
+}
+
+void body_set_static(body_t *body, bool is_static) {
+    body->is_static = is_static;
+    if (is_static) {
+        MOTION(body, masses) = INFINITY;
+        MOTION(body, velocities) = VEC_ZERO;
+        MOTION(body, accelerations) = VEC_ZERO;
+        MOTION(body, angular_velocities) = 0;
+    }
+}
+
+bool body_is_static(body_t *body) {
+    return body->is_static;
+}
+
+void body_set_continuous(body_t *body, bool is_continuous) {
+    body->is_continuous = is_continuous;
+}
+
+bool body_is_continuous(body_t *body) {
+    return body->is_continuous;
+}
+
+void body_set_sensor(body_t *body, sensor_mode_t mode) {
+    body->sensor_mode = mode;
+    // Results remembered with the old mode no longer apply
+    body->shape_version = next_shape_version++;
+}
+
+sensor_mode_t body_get_sensor(body_t *body) {
+    return body->sensor_mode;
+}
+
+bool body_is_sensor(body_t *body) {
+    return body->sensor_mode != SENSOR_NONE;
+}
+
+void body_set_collision_method(body_t *body, collision_method_t method) {
+    body->collision_method = method;
+    // Results remembered with the old method no longer apply
+    body->shape_version = next_shape_version++;
+}
+
+collision_method_t body_get_collision_method(body_t *body) {
+    return body->collision_method;
+}
+
+void body_set_collision_proxy(body_t *body, collision_proxy_t proxy,
+                              size_t max_vertices) {
+    if (body->collision_shape) {
+        shape_prototype_release(body->collision_shape);
+    }
+    body->collision_shape = NULL;
+    forget_world_collision_shape(body);
+    body->is_round = false;
+    // Proxies are made in world space, then moved into local space
+    polygon_t *shape = body_get_shape(body);
+    polygon_t *collision_shape = NULL;
+    switch (proxy) {
+    case COLLISION_PROXY_NONE:
+        break;
+    case COLLISION_PROXY_HULL:
+        collision_shape = polygon_convex_hull(shape, max_vertices);
+        break;
+    case COLLISION_PROXY_AABB: {
+        bounding_box_t bbox = polygon_get_bounding_box(shape);
+        collision_shape = initialize_rectangle(bbox.min_x, bbox.min_y,
+                                               bbox.max_x, bbox.max_y);
+        break;
+    }
+    case COLLISION_PROXY_OBB:
+        collision_shape = polygon_oriented_bounding_box(shape);
+        break;
+    case COLLISION_PROXY_CIRCLE: {
+        // The smallest circle around the centroid containing the shape
+        vector_t centroid = MOTION(body, centroids);
+        double radius = 0;
+        for (size_t i = 0; i < shape->num_vertices; i++) {
+            vector_t *vertex = &shape->vertices[i];
+            radius = fmax(radius, vec_distance(*vertex, centroid));
+        }
+        body->is_round = true;
+        body->capsule =
+            (capsule_t){.start = centroid, .end = centroid, .radius = radius};
+        break;
+    }
+    case COLLISION_PROXY_CAPSULE: {
+        // Round off the short sides of the oriented bounding box
+        polygon_t *box = polygon_oriented_bounding_box(shape);
+        vector_t corners[4];
+        memcpy(corners, box->vertices, sizeof(corners));
+        polygon_free(box);
+        vector_t side1 = vec_subtract(corners[1], corners[0]);
+        vector_t side2 = vec_subtract(corners[2], corners[1]);
+        if (vec_magnitude(side1) < vec_magnitude(side2)) {
+            vector_t shorter = side1;
+            side1 = side2;
+            side2 = shorter;
+        }
+        vector_t center = vec_multiply(0.5, vec_add(corners[0], corners[2]));
+        double radius = vec_magnitude(side2) / 2;
+        vector_t half_segment =
+            vec_multiply((vec_magnitude(side1) / 2 - radius) /
+                             vec_magnitude(side1),
+                         side1);
+        body->is_round = true;
+        body->capsule = (capsule_t){.start = vec_subtract(center, half_segment),
+                                    .end = vec_add(center, half_segment),
+                                    .radius = radius};
+        break;
+    }
+    }
+    polygon_free(shape);
+    if (collision_shape) {
+        body->collision_shape =
+            shape_prototype_intern(collision_shape, MOTION(body, centroids),
+                                   MOTION(body, orientations));
+        forget_world_collision_shape(body);
+    }
+    update_bounding_box(body);
+    body->shape_version = next_shape_version++;
+}
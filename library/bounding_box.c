@@ -19,3 +19,69 @@ bool bounding_box_contains_point(bounding_box_t bbox, vector_t point) {
     return point.x > bbox.min_x && point.x < bbox.max_x &&
            point.y > bbox.min_y && point.y < bbox.max_y;
 }
+
+bool bounding_box_overlaps(bounding_box_t bbox1, bounding_box_t bbox2) {
+    return bbox1.min_x <= bbox2.max_x && bbox2.min_x <= bbox1.max_x &&
+           bbox1.min_y <= bbox2.max_y && bbox2.min_y <= bbox1.max_y;
+}
+
+bool bounding_box_contains(bounding_box_t outer, bounding_box_t inner) {
+    return outer.min_x <= inner.min_x && outer.min_y <= inner.min_y &&
+           inner.max_x <= outer.max_x && inner.max_y <= outer.max_y;
+}
+
+bounding_box_t bounding_box_union(bounding_box_t bbox1, bounding_box_t bbox2) {
+    return (bounding_box_t){
+        .min_x = fmin(bbox1.min_x, bbox2.min_x),
+        .min_y = fmin(bbox1.min_y, bbox2.min_y),
+        .max_x = fmax(bbox1.max_x, bbox2.max_x),
+        .max_y = fmax(bbox1.max_y, bbox2.max_y),
+    };
+}
+
+bounding_box_t bounding_box_expand(bounding_box_t bbox, double margin) {
+    return (bounding_box_t){
+        .min_x = bbox.min_x - margin,
+        .min_y = bbox.min_y - margin,
+        .max_x = bbox.max_x + margin,
+        .max_y = bbox.max_y + margin,
+    };
+}
+
+double bounding_box_perimeter(bounding_box_t bbox) {
+    return 2 * ((bbox.max_x - bbox.min_x) + (bbox.max_y - bbox.min_y));
+}
+
+/**
+ * Helper function.
+ * Clips the parameter range [t_min, t_max] of a segment to the part that lies
+ * within a slab [slab_min, slab_max] along one axis.
+ *
+ * @return false if no part of the segment is within the slab
+ */
+bool clip_segment_to_slab(double start, double delta, double slab_min,
+                          double slab_max, double *t_min, double *t_max) {
+    if (delta == 0) {
+        return slab_min <= start && start <= slab_max;
+    }
+    double t_enter = (slab_min - start) / delta;
+    double t_exit = (slab_max - start) / delta;
+    if (t_enter > t_exit) {
+        double temp = t_enter;
+        t_enter = t_exit;
+        t_exit = temp;
+    }
+    *t_min = fmax(*t_min, t_enter);
+    *t_max = fmin(*t_max, t_exit);
+    return *t_min <= *t_max;
+}
+
+bool bounding_box_intersects_segment(bounding_box_t bbox, vector_t start,
+                                     vector_t end) {
+    double t_min = 0;
+    double t_max = 1;
+    return clip_segment_to_slab(start.x, end.x - start.x, bbox.min_x,
+                                bbox.max_x, &t_min, &t_max) &&
+           clip_segment_to_slab(start.y, end.y - start.y, bbox.min_y,
+                                bbox.max_y, &t_min, &t_max);
+}
@@ -0,0 +1,613 @@
+#include "broadphase.h"
+#include "bounding_box.h"
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Bodies that cover more grid cells than this (e.g. level backgrounds) are not
+// inserted into the grid; they are tested against every other body instead.
+const size_t BROADPHASE_MAX_CELLS_PER_BODY = 64;
+const size_t BROADPHASE_INITIAL_CAPACITY = 16;
+const size_t BROADPHASE_MIN_TABLE_SIZE = 16;
+
+/**
+ * A body added to the grid.
+ * bbox: the body's bounding box when it was added
+ * min_cell_x, ..., max_cell_y: the range of grid cells the bounding box covers
+ * is_oversized: if true, the body was not inserted into the grid
+ */
+typedef struct broadphase_proxy {
+    body_t *body;
+    bounding_box_t bbox;
+    int64_t min_cell_x;
+    int64_t min_cell_y;
+    int64_t max_cell_x;
+    int64_t max_cell_y;
+    bool is_oversized;
+} broadphase_proxy_t;
+
+/**
+ * An occupied grid cell. There is one entry per cell covered by each proxy.
+ */
+typedef struct cell_entry {
+    int64_t cell_x;
+    int64_t cell_y;
+    size_t proxy_index;
+} cell_entry_t;
+
+typedef struct proxy_pair {
+    size_t index1;
+    size_t index2;
+} proxy_pair_t;
+
+/**
+ * A set of proxies and the grid cells they cover.
+ * entries: the cell entries of all proxies, in the order they were added
+ * bucketed_entries: the same entries, grouped by the hash of their cell
+ * bucket_starts: index of the first entry of each bucket in bucketed_entries
+ */
+typedef struct proxy_grid {
+    broadphase_proxy_t *proxies;
+    size_t num_proxies;
+    size_t proxies_capacity;
+    cell_entry_t *entries;
+    cell_entry_t *bucketed_entries;
+    size_t num_entries;
+    size_t entries_capacity;
+    size_t *bucket_starts;
+    size_t num_buckets;
+} proxy_grid_t;
+
+/**
+ * dynamic_grid: the bodies added since the last broadphase_find_pairs()
+ * static_grid: the static bodies, which stay in the broadphase until they are
+ *      removed. Candidates index static proxies after all dynamic proxies.
+ * is_static_grid_dirty: whether static_grid's cells need to be rebuilt
+ * candidates: overlapping proxy pairs, before they are sorted
+ * pairs: the pairs found by the last broadphase_find_pairs()
+ * old_pairs: the pairs found by the call before that, whose state is carried
+ *      over to pairs. After the pairs are found, its first num_lost_pairs
+ *      entries are the old pairs that were not found again.
+ * pair_table: open-addressing hash table from a pair of bodies to
+ *      (its index in pairs) + 1, or 0 for an empty slot
+ */
+typedef struct broadphase {
+    double cell_size;
+    proxy_grid_t dynamic_grid;
+    proxy_grid_t static_grid;
+    bool is_static_grid_dirty;
+    proxy_pair_t *candidates;
+    size_t num_candidates;
+    size_t candidates_capacity;
+    body_pair_t *pairs;
+    size_t num_pairs;
+    body_pair_t *old_pairs;
+    size_t num_lost_pairs;
+    size_t pairs_capacity;
+    size_t *pair_table;
+    size_t pair_table_size;
+} broadphase_t;
+
+/**
+ * Helper function.
+ * Makes sure that a heap array has room for at least `needed` elements,
+ * doubling its capacity as many times as necessary.
+ */
+void *reserve_array(void *data, size_t *capacity, size_t needed,
+                      size_t elem_size) {
+    if (needed <= *capacity && data) {
+        return data;
+    }
+    size_t new_capacity = *capacity ? *capacity : BROADPHASE_INITIAL_CAPACITY;
+    while (new_capacity < needed) {
+        new_capacity *= 2;
+    }
+    data = realloc(data, new_capacity * elem_size);
+    assert(data);
+    *capacity = new_capacity;
+    return data;
+}
+
+size_t hash_table_size(size_t n) {
+    size_t result = BROADPHASE_MIN_TABLE_SIZE;
+    while (result < n) {
+        result *= 2;
+    }
+    return result;
+}
+
+size_t hash_cell(int64_t cell_x, int64_t cell_y, size_t table_size) {
+    uint64_t hash =
+        ((uint64_t)cell_x * 73856093u) ^ ((uint64_t)cell_y * 19349663u);
+    return hash & (table_size - 1);
+}
+
+size_t hash_body_pair(body_t *body1, body_t *body2, size_t table_size) {
+    uint64_t hash = (uint64_t)(uintptr_t)body1 * 0x9E3779B97F4A7C15u;
+    hash ^= (uint64_t)(uintptr_t)body2 + (hash << 6) + (hash >> 2);
+    hash ^= hash >> 29;
+    return hash & (table_size - 1);
+}
+
+broadphase_t *broadphase_init(double cell_size) {
+    assert(cell_size > 0);
+    broadphase_t *broadphase = calloc(1, sizeof(broadphase_t));
+    assert(broadphase);
+    broadphase->cell_size = cell_size;
+    return broadphase;
+}
+
+/**
+ * Helper function.
+ * Releases the arrays of a grid.
+ */
+void free_proxy_grid(proxy_grid_t *grid) {
+    free(grid->proxies);
+    free(grid->entries);
+    free(grid->bucketed_entries);
+    free(grid->bucket_starts);
+}
+
+void broadphase_free(broadphase_t *broadphase) {
+    free_proxy_grid(&broadphase->dynamic_grid);
+    free_proxy_grid(&broadphase->static_grid);
+    free(broadphase->candidates);
+    free(broadphase->pairs);
+    free(broadphase->old_pairs);
+    free(broadphase->pair_table);
+    free(broadphase);
+}
+
+void broadphase_clear(broadphase_t *broadphase) {
+    broadphase->dynamic_grid.num_proxies = 0;
+    broadphase->static_grid.num_proxies = 0;
+    broadphase->is_static_grid_dirty = true;
+    broadphase->num_pairs = 0;
+    broadphase->num_lost_pairs = 0;
+    if (broadphase->pair_table) {
+        memset(broadphase->pair_table, 0,
+               sizeof(size_t) * broadphase->pair_table_size);
+    }
+}
+
+/**
+ * Helper function.
+ * Adds a proxy for a body's current bounding box to a grid. The grid's cells
+ * are only updated by fill_grid().
+ */
+void add_proxy(proxy_grid_t *grid, double cell_size, body_t *body) {
+    grid->proxies =
+        reserve_array(grid->proxies, &grid->proxies_capacity,
+                      grid->num_proxies + 1, sizeof(broadphase_proxy_t));
+    broadphase_proxy_t *proxy = &grid->proxies[grid->num_proxies];
+    grid->num_proxies++;
+
+    bounding_box_t bbox = body_get_bounding_box(body);
+    proxy->body = body;
+    proxy->bbox = bbox;
+    if (!isfinite(bbox.min_x) || !isfinite(bbox.min_y) ||
+        !isfinite(bbox.max_x) || !isfinite(bbox.max_y)) {
+        proxy->is_oversized = true;
+        return;
+    }
+    proxy->min_cell_x = (int64_t)floor(bbox.min_x / cell_size);
+    proxy->min_cell_y = (int64_t)floor(bbox.min_y / cell_size);
+    proxy->max_cell_x = (int64_t)floor(bbox.max_x / cell_size);
+    proxy->max_cell_y = (int64_t)floor(bbox.max_y / cell_size);
+    size_t num_cells = (proxy->max_cell_x - proxy->min_cell_x + 1) *
+                       (proxy->max_cell_y - proxy->min_cell_y + 1);
+    proxy->is_oversized = num_cells > BROADPHASE_MAX_CELLS_PER_BODY;
+}
+
+void broadphase_add_body(broadphase_t *broadphase, body_t *body) {
+    add_proxy(&broadphase->dynamic_grid, broadphase->cell_size, body);
+}
+
+void broadphase_add_static_body(broadphase_t *broadphase, body_t *body) {
+    add_proxy(&broadphase->static_grid, broadphase->cell_size, body);
+    broadphase->is_static_grid_dirty = true;
+}
+
+/**
+ * Helper function.
+ * Records that the proxies at the given indices overlap.
+ */
+void add_candidate(broadphase_t *broadphase, size_t index1, size_t index2) {
+    broadphase->candidates = reserve_array(
+        broadphase->candidates, &broadphase->candidates_capacity,
+        broadphase->num_candidates + 1, sizeof(proxy_pair_t));
+    proxy_pair_t *candidate =
+        &broadphase->candidates[broadphase->num_candidates];
+    broadphase->num_candidates++;
+    candidate->index1 = index1 < index2 ? index1 : index2;
+    candidate->index2 = index1 < index2 ? index2 : index1;
+}
+
+/**
+ * Helper function.
+ * Groups the cell entries of all proxies in a grid by the hash of their cell,
+ * using a counting sort so that entries in a bucket stay in the order they
+ * were added.
+ */
+void fill_grid(proxy_grid_t *grid) {
+    grid->num_entries = 0;
+    for (size_t i = 0; i < grid->num_proxies; i++) {
+        broadphase_proxy_t *proxy = &grid->proxies[i];
+        if (proxy->is_oversized) {
+            continue;
+        }
+        for (int64_t x = proxy->min_cell_x; x <= proxy->max_cell_x; x++) {
+            for (int64_t y = proxy->min_cell_y; y <= proxy->max_cell_y; y++) {
+                grid->entries = reserve_array(
+                    grid->entries, &grid->entries_capacity,
+                    grid->num_entries + 1, sizeof(cell_entry_t));
+                grid->entries[grid->num_entries] =
+                    (cell_entry_t){.cell_x = x, .cell_y = y, .proxy_index = i};
+                grid->num_entries++;
+            }
+        }
+    }
+    // bucketed_entries always has the same capacity as entries
+    size_t bucketed_capacity = grid->entries_capacity;
+    grid->bucketed_entries = realloc(
+        grid->bucketed_entries,
+        sizeof(cell_entry_t) * (bucketed_capacity ? bucketed_capacity : 1));
+    assert(grid->bucketed_entries);
+
+    size_t num_buckets = hash_table_size(grid->num_entries);
+    if (num_buckets != grid->num_buckets) {
+        grid->bucket_starts = realloc(grid->bucket_starts,
+                                      sizeof(size_t) * (num_buckets + 1));
+        assert(grid->bucket_starts);
+        grid->num_buckets = num_buckets;
+    }
+    size_t *bucket_starts = grid->bucket_starts;
+    memset(bucket_starts, 0, sizeof(size_t) * (num_buckets + 1));
+    for (size_t i = 0; i < grid->num_entries; i++) {
+        cell_entry_t *entry = &grid->entries[i];
+        bucket_starts[hash_cell(entry->cell_x, entry->cell_y, num_buckets) +
+                      1]++;
+    }
+    for (size_t i = 0; i < num_buckets; i++) {
+        bucket_starts[i + 1] += bucket_starts[i];
+    }
+    // Use the start of each bucket as its insertion cursor, then shift the
+    // starts back once every entry is placed
+    for (size_t i = 0; i < grid->num_entries; i++) {
+        cell_entry_t *entry = &grid->entries[i];
+        size_t bucket = hash_cell(entry->cell_x, entry->cell_y, num_buckets);
+        grid->bucketed_entries[bucket_starts[bucket]] = *entry;
+        bucket_starts[bucket]++;
+    }
+    for (size_t i = num_buckets; i > 0; i--) {
+        bucket_starts[i] = bucket_starts[i - 1];
+    }
+    bucket_starts[0] = 0;
+}
+
+/**
+ * Helper function.
+ * Returns whether a grid cell is the lowest cell of the intersection of the
+ * cell ranges of two proxies. Two proxies can share several cells, so a pair
+ * is only reported from this one.
+ */
+bool is_first_shared_cell(broadphase_proxy_t *proxy1,
+                          broadphase_proxy_t *proxy2, int64_t cell_x,
+                          int64_t cell_y) {
+    int64_t first_shared_x = proxy1->min_cell_x > proxy2->min_cell_x
+                                 ? proxy1->min_cell_x
+                                 : proxy2->min_cell_x;
+    int64_t first_shared_y = proxy1->min_cell_y > proxy2->min_cell_y
+                                 ? proxy1->min_cell_y
+                                 : proxy2->min_cell_y;
+    return cell_x == first_shared_x && cell_y == first_shared_y;
+}
+
+/**
+ * Helper function.
+ * Returns whether a static body can currently be part of a pair.
+ * Static bodies stay in the broadphase while they have no collision layers.
+ */
+bool is_static_proxy_active(broadphase_proxy_t *proxy) {
+    return body_get_collision_layers(proxy->body) &&
+           !body_is_removed(proxy->body);
+}
+
+/**
+ * Helper function.
+ * Finds overlapping dynamic proxies that share a grid cell.
+ */
+void find_grid_candidates(broadphase_t *broadphase) {
+    proxy_grid_t *grid = &broadphase->dynamic_grid;
+    for (size_t bucket = 0; bucket < grid->num_buckets; bucket++) {
+        size_t start = grid->bucket_starts[bucket];
+        size_t end = grid->bucket_starts[bucket + 1];
+        for (size_t i = start; i < end; i++) {
+            cell_entry_t *entry1 = &grid->bucketed_entries[i];
+            broadphase_proxy_t *proxy1 = &grid->proxies[entry1->proxy_index];
+            for (size_t j = i + 1; j < end; j++) {
+                cell_entry_t *entry2 = &grid->bucketed_entries[j];
+                if (entry1->cell_x != entry2->cell_x ||
+                    entry1->cell_y != entry2->cell_y) {
+                    continue; // different cells with the same hash
+                }
+                broadphase_proxy_t *proxy2 =
+                    &grid->proxies[entry2->proxy_index];
+                if (is_first_shared_cell(proxy1, proxy2, entry1->cell_x,
+                                         entry1->cell_y) &&
+                    bounding_box_overlaps(proxy1->bbox, proxy2->bbox)) {
+                    add_candidate(broadphase, entry1->proxy_index,
+                                  entry2->proxy_index);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Helper function.
+ * Finds the static proxies that overlap each dynamic proxy, by looking up the
+ * cells the dynamic proxy covers in the static grid.
+ */
+void find_static_grid_candidates(broadphase_t *broadphase) {
+    proxy_grid_t *dynamic_grid = &broadphase->dynamic_grid;
+    proxy_grid_t *static_grid = &broadphase->static_grid;
+    if (static_grid->num_entries == 0) {
+        return;
+    }
+    for (size_t i = 0; i < dynamic_grid->num_proxies; i++) {
+        broadphase_proxy_t *proxy1 = &dynamic_grid->proxies[i];
+        if (proxy1->is_oversized) {
+            continue;
+        }
+        for (int64_t x = proxy1->min_cell_x; x <= proxy1->max_cell_x; x++) {
+            for (int64_t y = proxy1->min_cell_y; y <= proxy1->max_cell_y;
+                 y++) {
+                size_t bucket = hash_cell(x, y, static_grid->num_buckets);
+                size_t start = static_grid->bucket_starts[bucket];
+                size_t end = static_grid->bucket_starts[bucket + 1];
+                for (size_t j = start; j < end; j++) {
+                    cell_entry_t *entry = &static_grid->bucketed_entries[j];
+                    if (entry->cell_x != x || entry->cell_y != y) {
+                        continue;
+                    }
+                    broadphase_proxy_t *proxy2 =
+                        &static_grid->proxies[entry->proxy_index];
+                    if (is_first_shared_cell(proxy1, proxy2, x, y) &&
+                        is_static_proxy_active(proxy2) &&
+                        bounding_box_overlaps(proxy1->bbox, proxy2->bbox)) {
+                        add_candidate(broadphase, i,
+                                      dynamic_grid->num_proxies +
+                                          entry->proxy_index);
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Helper function.
+ * Tests every oversized proxy against every other proxy, except that static
+ * proxies are never tested against each other.
+ */
+void find_oversized_candidates(broadphase_t *broadphase) {
+    proxy_grid_t *dynamic_grid = &broadphase->dynamic_grid;
+    proxy_grid_t *static_grid = &broadphase->static_grid;
+    size_t num_dynamic = dynamic_grid->num_proxies;
+    for (size_t i = 0; i < num_dynamic; i++) {
+        broadphase_proxy_t *proxy1 = &dynamic_grid->proxies[i];
+        if (!proxy1->is_oversized) {
+            continue;
+        }
+        for (size_t j = 0; j < num_dynamic; j++) {
+            broadphase_proxy_t *proxy2 = &dynamic_grid->proxies[j];
+            // Pairs of two oversized proxies are only tested once
+            if (i == j || (proxy2->is_oversized && j < i)) {
+                continue;
+            }
+            if (bounding_box_overlaps(proxy1->bbox, proxy2->bbox)) {
+                add_candidate(broadphase, i, j);
+            }
+        }
+        for (size_t j = 0; j < static_grid->num_proxies; j++) {
+            broadphase_proxy_t *proxy2 = &static_grid->proxies[j];
+            if (is_static_proxy_active(proxy2) &&
+                bounding_box_overlaps(proxy1->bbox, proxy2->bbox)) {
+                add_candidate(broadphase, i, num_dynamic + j);
+            }
+        }
+    }
+    for (size_t j = 0; j < static_grid->num_proxies; j++) {
+        broadphase_proxy_t *proxy2 = &static_grid->proxies[j];
+        if (!proxy2->is_oversized || !is_static_proxy_active(proxy2)) {
+            continue;
+        }
+        // Oversized dynamic proxies were already tested above
+        for (size_t i = 0; i < num_dynamic; i++) {
+            broadphase_proxy_t *proxy1 = &dynamic_grid->proxies[i];
+            if (!proxy1->is_oversized &&
+                bounding_box_overlaps(proxy1->bbox, proxy2->bbox)) {
+                add_candidate(broadphase, i, num_dynamic + j);
+            }
+        }
+    }
+}
+
+int compare_proxy_pairs(const void *a, const void *b) {
+    const proxy_pair_t *pair1 = a;
+    const proxy_pair_t *pair2 = b;
+    if (pair1->index1 != pair2->index1) {
+        return pair1->index1 < pair2->index1 ? -1 : 1;
+    }
+    if (pair1->index2 != pair2->index2) {
+        return pair1->index2 < pair2->index2 ? -1 : 1;
+    }
+    return 0;
+}
+
+/**
+ * Helper function.
+ * Gets the body of a proxy by its candidate index, where static proxies come
+ * after all dynamic proxies.
+ */
+body_t *get_candidate_body(broadphase_t *broadphase, size_t index) {
+    size_t num_dynamic = broadphase->dynamic_grid.num_proxies;
+    if (index < num_dynamic) {
+        return broadphase->dynamic_grid.proxies[index].body;
+    }
+    return broadphase->static_grid.proxies[index - num_dynamic].body;
+}
+
+/**
+ * Helper function.
+ * Looks up a pair in the array of pairs that the pair table indexes: the old
+ * pairs before the table is rebuilt for the new pairs, and the new pairs
+ * after.
+ *
+ * @return the pair, or NULL if the bodies are not a pair in the array
+ */
+body_pair_t *find_indexed_pair(broadphase_t *broadphase,
+                               body_pair_t *indexed_pairs, body_t *body1,
+                               body_t *body2) {
+    if (!broadphase->pair_table) {
+        return NULL;
+    }
+    size_t mask = broadphase->pair_table_size - 1;
+    size_t slot =
+        hash_body_pair(body1, body2, broadphase->pair_table_size);
+    while (broadphase->pair_table[slot]) {
+        body_pair_t *pair = &indexed_pairs[broadphase->pair_table[slot] - 1];
+        if (pair->body1 == body1 && pair->body2 == body2) {
+            return pair;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return NULL;
+}
+
+/**
+ * Helper function.
+ * Rebuilds the pair table so it indexes the pairs that were just found.
+ */
+void build_pair_table(broadphase_t *broadphase) {
+    size_t table_size = hash_table_size(2 * broadphase->num_pairs);
+    if (table_size != broadphase->pair_table_size) {
+        broadphase->pair_table =
+            realloc(broadphase->pair_table, sizeof(size_t) * table_size);
+        assert(broadphase->pair_table);
+        broadphase->pair_table_size = table_size;
+    }
+    memset(broadphase->pair_table, 0, sizeof(size_t) * table_size);
+    size_t mask = table_size - 1;
+    for (size_t i = 0; i < broadphase->num_pairs; i++) {
+        body_pair_t *pair = &broadphase->pairs[i];
+        size_t slot = hash_body_pair(pair->body1, pair->body2, table_size);
+        while (broadphase->pair_table[slot]) {
+            slot = (slot + 1) & mask;
+        }
+        broadphase->pair_table[slot] = i + 1;
+    }
+}
+
+size_t broadphase_find_pairs(broadphase_t *broadphase) {
+    if (broadphase->is_static_grid_dirty) {
+        fill_grid(&broadphase->static_grid);
+        broadphase->is_static_grid_dirty = false;
+    }
+    broadphase->num_candidates = 0;
+    fill_grid(&broadphase->dynamic_grid);
+    find_grid_candidates(broadphase);
+    find_static_grid_candidates(broadphase);
+    find_oversized_candidates(broadphase);
+    qsort(broadphase->candidates, broadphase->num_candidates,
+          sizeof(proxy_pair_t), compare_proxy_pairs);
+
+    // The pairs from the last call become the old pairs, which the pair table
+    // still indexes
+    body_pair_t *old_pairs = broadphase->pairs;
+    broadphase->pairs = broadphase->old_pairs;
+    broadphase->old_pairs = old_pairs;
+    size_t num_old_pairs = broadphase->num_pairs;
+    // Both buffers always have the same capacity
+    size_t old_capacity = broadphase->pairs_capacity;
+    broadphase->pairs =
+        reserve_array(broadphase->pairs, &broadphase->pairs_capacity,
+                      broadphase->num_candidates, sizeof(body_pair_t));
+    broadphase->old_pairs =
+        reserve_array(broadphase->old_pairs, &old_capacity,
+                      broadphase->pairs_capacity, sizeof(body_pair_t));
+
+    broadphase->num_pairs = broadphase->num_candidates;
+    for (size_t i = 0; i < broadphase->num_candidates; i++) {
+        proxy_pair_t *candidate = &broadphase->candidates[i];
+        body_t *body1 = get_candidate_body(broadphase, candidate->index1);
+        body_t *body2 = get_candidate_body(broadphase, candidate->index2);
+        body_pair_t *old_pair =
+            find_indexed_pair(broadphase, broadphase->old_pairs, body1, body2);
+        if (old_pair) {
+            broadphase->pairs[i] = *old_pair;
+        } else {
+            broadphase->pairs[i] = (body_pair_t){.body1 = body1,
+                                                 .body2 = body2};
+        }
+    }
+    build_pair_table(broadphase);
+
+    // Move the old pairs that weren't found again to the front
+    broadphase->num_lost_pairs = 0;
+    for (size_t i = 0; i < num_old_pairs; i++) {
+        body_pair_t *old_pair = &broadphase->old_pairs[i];
+        if (old_pair->body1 &&
+            !find_indexed_pair(broadphase, broadphase->pairs, old_pair->body1,
+                               old_pair->body2)) {
+            broadphase->old_pairs[broadphase->num_lost_pairs] = *old_pair;
+            broadphase->num_lost_pairs++;
+        }
+    }
+    broadphase->dynamic_grid.num_proxies = 0;
+    return broadphase->num_pairs;
+}
+
+body_pair_t *broadphase_get_pair(broadphase_t *broadphase, size_t index) {
+    assert(index < broadphase->num_pairs);
+    return &broadphase->pairs[index];
+}
+
+size_t broadphase_lost_pairs(broadphase_t *broadphase) {
+    return broadphase->num_lost_pairs;
+}
+
+body_pair_t *broadphase_get_lost_pair(broadphase_t *broadphase, size_t index) {
+    assert(index < broadphase->num_lost_pairs);
+    return &broadphase->old_pairs[index];
+}
+
+void broadphase_forget_removed_bodies(broadphase_t *broadphase) {
+    for (size_t i = 0; i < broadphase->num_pairs; i++) {
+        body_pair_t *pair = &broadphase->pairs[i];
+        if (!pair->body1) {
+            continue;
+        }
+        if (body_is_removed(pair->body1) || body_is_removed(pair->body2)) {
+            // The pair stays in the table, but can no longer be matched
+            pair->body1 = NULL;
+            pair->body2 = NULL;
+        }
+    }
+    // Drop removed static bodies, keeping the rest in the order they were added
+    proxy_grid_t *static_grid = &broadphase->static_grid;
+    size_t num_kept = 0;
+    for (size_t i = 0; i < static_grid->num_proxies; i++) {
+        if (!body_is_removed(static_grid->proxies[i].body)) {
+            static_grid->proxies[num_kept] = static_grid->proxies[i];
+            num_kept++;
+        }
+    }
+    if (num_kept != static_grid->num_proxies) {
+        static_grid->num_proxies = num_kept;
+        broadphase->is_static_grid_dirty = true;
+    }
+}
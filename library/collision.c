@@ -6,82 +6,708 @@
 #include <math.h>
 #include <stdlib.h>
 
-list_t *get_perpendicular_axes(list_t *shape) {
-    list_t *perpendicular_axes = list_init(list_size(shape), free);
-    for (size_t v1 = 0; v1 < list_size(shape); v1++) {
-        size_t v2 = (v1 + 1) % list_size(shape);
-        vector_t *first_vertex = list_get(shape, v1);
-        vector_t *second_vertex = list_get(shape, v2);
-        vector_t edge = vec_subtract(*second_vertex, *first_vertex);
-        vector_t *perpendicular_axis = malloc(sizeof(vector_t));
-        *perpendicular_axis = vec_direction(vec_rotate(edge, PI / 2));
-        list_add(perpendicular_axes, perpendicular_axis);
-    }
-    return perpendicular_axes;
-}
-
-double get_projection_min(list_t *shape, vector_t axis) {
-    double min = INFINITY;
-    for (size_t i = 0; i < list_size(shape); i++) {
-        double projection = vec_dot(*(vector_t *)list_get(shape, i), axis);
-        if (projection < min) {
-            min = projection;
-        }
-    }
-    return min;
-}
-
-double get_projection_max(list_t *shape, vector_t axis) {
-    double max = -INFINITY;
-    for (size_t i = 0; i < list_size(shape); i++) {
-        double projection = vec_dot(*(vector_t *)list_get(shape, i), axis);
-        if (projection > max) {
-            max = projection;
-        }
-    }
-    return max;
-}
-
-collision_info_t find_collision(list_t *shape1, list_t *shape2) {
-    list_t *perpendicular_axes1 = get_perpendicular_axes(shape1);
-    list_t *perpendicular_axes2 = get_perpendicular_axes(shape2);
-    list_t *perpendicular_axes =
-        list_append(perpendicular_axes1, perpendicular_axes2);
-    vector_t min_overlap_axis;
-    double min_overlap = INFINITY;
-    collision_status_t min_overlap_collision_status;
-    for (size_t i = 0; i < list_size(perpendicular_axes); i++) {
-        vector_t axis = *(vector_t *)list_get(perpendicular_axes, i);
-        double min_shape1 = get_projection_min(shape1, axis);
-        double max_shape1 = get_projection_max(shape1, axis);
-        double min_shape2 = get_projection_min(shape2, axis);
-        double max_shape2 = get_projection_max(shape2, axis);
-        double overlap =
-            segment_overlap(min_shape1, max_shape1, min_shape2, max_shape2);
-        if (overlap < min_overlap) {
-            // Ensure that the axis goes from shape1 to shape2
+// The number of distinct axes remembered for skipping parallel edges.
+// Shapes with more edges are still handled correctly, but later axes may be
+// tested more than once.
+#define MAX_UNIQUE_AXES 32
+
+// The largest number of vertices the EPA polytope can grow to. The polytope
+// is a subset of the Minkowski difference, which has at most as many vertices
+// as both shapes together, so only shapes with more vertices than this stop
+// early, with a slightly smaller overlap.
+#define MAX_EPA_VERTICES 128
+
+// Two unit axes whose cross product is smaller than this are parallel
+const double PARALLEL_AXIS_EPSILON = 1e-9;
+// Shapes with at least this many vertices together are checked with GJK
+// when the collision method is automatic
+const size_t GJK_MIN_VERTICES = 20;
+// The most simplex updates GJK makes before giving up and using SAT
+const size_t MAX_GJK_ITERATIONS = 64;
+// EPA stops once a new support point is this close to the closest edge
+const double EPA_TOLERANCE = 1e-9;
+
+// Each thread counts its own work, so the scene's narrowphase threads don't
+// share counters
+_Thread_local collision_stats_t collision_stats = {0};
+
+collision_stats_t *collision_get_stats(void) {
+    return &collision_stats;
+}
+
+/**
+ * Helper function.
+ * Projects every vertex of a shape onto an axis in a single pass.
+ *
+ * @param shape the shape to project
+ * @param axis the axis to project onto
+ * @param min set to the smallest projection
+ * @param max set to the largest projection
+ */
+void get_projection(polygon_t *shape, vector_t axis, double *min, double *max) {
+    *min = INFINITY;
+    *max = -INFINITY;
+    for (size_t i = 0; i < shape->num_vertices; i++) {
+        double projection = vec_dot(shape->vertices[i], axis);
+        if (projection < *min) {
+            *min = projection;
+        }
+        if (projection > *max) {
+            *max = projection;
+        }
+    }
+}
+
+/**
+ * Helper function.
+ * Returns whether an axis is parallel to one that was already tested.
+ * Projections onto parallel axes give the same overlap, so only the first
+ * of them needs to be tested.
+ */
+bool is_duplicate_axis(vector_t *axes, size_t num_axes, vector_t axis) {
+    for (size_t i = 0; i < num_axes; i++) {
+        if (fabs(vec_cross(axes[i], axis)) < PARALLEL_AXIS_EPSILON) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Helper function.
+ * Projects both shapes onto an axis, and makes it the result's axis if the
+ * shapes overlap less along it than along the axes tested before.
+ *
+ * @return true if the axis separates the shapes
+ */
+bool test_sat_axis(polygon_t *shape1, polygon_t *shape2, vector_t axis,
+                   collision_info_t *result) {
+    collision_stats.axes_projected++;
+    double min_shape1, max_shape1, min_shape2, max_shape2;
+    get_projection(shape1, axis, &min_shape1, &max_shape1);
+    get_projection(shape2, axis, &min_shape2, &max_shape2);
+    double overlap =
+        segment_overlap(min_shape1, max_shape1, min_shape2, max_shape2);
+    if (overlap < result->overlap) {
+        // Ensure that the axis goes from shape1 to shape2
+        if ((min_shape2 + max_shape2) < (min_shape1 + max_shape1)) {
+            axis = vec_negate(axis);
+        }
+        result->axis = axis;
+        result->overlap = overlap;
+
+        if (overlap == 0) {
+            // A separating axis was found
+            result->collided = NO_COLLISION;
+            return true;
+        } else if ((min_shape1 <= min_shape2 && max_shape1 >= max_shape2) ||
+                   (min_shape2 <= min_shape1 && max_shape2 >= max_shape1)) {
+            result->collided = FULL_COLLISION;
+        } else {
+            result->collided = PARTIAL_COLLISION;
+        }
+    }
+    return false;
+}
+
+/**
+ * Helper function.
+ * Tests every edge normal of both shapes, stopping at the first separating
+ * axis.
+ */
+collision_info_t find_collision_sat(polygon_t *shape1, polygon_t *shape2) {
+    collision_stats.sat_calls++;
+    vector_t unique_axes[MAX_UNIQUE_AXES];
+    size_t num_unique_axes = 0;
+    collision_info_t result = {
+        .collided = NO_COLLISION, .axis = VEC_ZERO, .overlap = INFINITY};
+    polygon_t *shapes[] = {shape1, shape2};
+    for (size_t s = 0; s < 2; s++) {
+        polygon_t *shape = shapes[s];
+        size_t num_vertices = shape->num_vertices;
+        for (size_t v1 = 0; v1 < num_vertices; v1++) {
+            size_t v2 = (v1 + 1) % num_vertices;
+            vector_t edge =
+                vec_subtract(shape->vertices[v2], shape->vertices[v1]);
+            vector_t axis = vec_direction((vector_t){.x = -edge.y, .y = edge.x});
+            // Skip degenerate edges between repeated vertices
+            if ((axis.x == 0 && axis.y == 0) ||
+                is_duplicate_axis(unique_axes, num_unique_axes, axis)) {
+                continue;
+            }
+            if (num_unique_axes < MAX_UNIQUE_AXES) {
+                unique_axes[num_unique_axes] = axis;
+                num_unique_axes++;
+            }
+            if (test_sat_axis(shape1, shape2, axis, &result)) {
+                return result;
+            }
+        }
+    }
+    return result;
+}
+
+/**
+ * Helper function.
+ * Tests precomputed edge normals of both shapes, like find_collision_sat().
+ * Each shape's normals are already free of parallel axes, so only the second
+ * shape's normals are checked against the first's.
+ */
+collision_info_t find_collision_sat_with_normals(polygon_t *shape1,
+                                                 edge_normals_t *normals1,
+                                                 polygon_t *shape2,
+                                                 edge_normals_t *normals2) {
+    collision_stats.sat_calls++;
+    collision_info_t result = {
+        .collided = NO_COLLISION, .axis = VEC_ZERO, .overlap = INFINITY};
+    for (size_t i = 0; i < normals1->num_normals; i++) {
+        if (test_sat_axis(shape1, shape2, normals1->normals[i], &result)) {
+            return result;
+        }
+    }
+    for (size_t i = 0; i < normals2->num_normals; i++) {
+        vector_t axis = normals2->normals[i];
+        if (!is_duplicate_axis(normals1->normals, normals1->num_normals,
+                               axis) &&
+            test_sat_axis(shape1, shape2, axis, &result)) {
+            return result;
+        }
+    }
+    return result;
+}
+
+void find_edge_normals(polygon_t *shape, edge_normals_t *normals) {
+    normals->num_normals = 0;
+    size_t num_vertices = shape->num_vertices;
+    for (size_t v1 = 0; v1 < num_vertices; v1++) {
+        size_t v2 = (v1 + 1) % num_vertices;
+        vector_t edge =
+            vec_subtract(shape->vertices[v2], shape->vertices[v1]);
+        vector_t axis = vec_direction((vector_t){.x = -edge.y, .y = edge.x});
+        if ((axis.x == 0 && axis.y == 0) ||
+            is_duplicate_axis(normals->normals, normals->num_normals, axis)) {
+            continue;
+        }
+        normals->normals[normals->num_normals] = axis;
+        normals->num_normals++;
+    }
+}
+
+collision_info_t find_collision(polygon_t *shape1, polygon_t *shape2) {
+    return find_collision_with_hint(shape1, shape2, NULL);
+}
+
+collision_info_t find_collision_with_hint(polygon_t *shape1, polygon_t *shape2,
+                                          vector_t *axis_hint) {
+    return find_collision_with_method(shape1, shape2, COLLISION_METHOD_SAT,
+                                      axis_hint);
+}
+
+collision_info_t find_collision_with_method(polygon_t *shape1,
+                                            polygon_t *shape2,
+                                            collision_method_t method,
+                                            vector_t *axis_hint) {
+    return find_collision_with_normals(shape1, NULL, shape2, NULL, method,
+                                       axis_hint);
+}
+
+collision_info_t find_collision_with_normals(polygon_t *shape1,
+                                             edge_normals_t *normals1,
+                                             polygon_t *shape2,
+                                             edge_normals_t *normals2,
+                                             collision_method_t method,
+                                             vector_t *axis_hint) {
+    if (axis_hint && (axis_hint->x != 0 || axis_hint->y != 0)) {
+        // Only used to exit early. The hint may not be an edge normal of the
+        // shapes anymore, so it can't be the collision axis.
+        collision_stats.axes_projected++;
+        double min_shape1, max_shape1, min_shape2, max_shape2;
+        get_projection(shape1, *axis_hint, &min_shape1, &max_shape1);
+        get_projection(shape2, *axis_hint, &min_shape2, &max_shape2);
+        if (segment_overlap(min_shape1, max_shape1, min_shape2, max_shape2) ==
+            0) {
+            vector_t axis = *axis_hint;
             if ((min_shape2 + max_shape2) < (min_shape1 + max_shape1)) {
                 axis = vec_negate(axis);
             }
+            return (collision_info_t){
+                .collided = NO_COLLISION, .axis = axis, .overlap = 0};
+        }
+    }
+    if (method == COLLISION_METHOD_AUTO) {
+        method = shape1->num_vertices + shape2->num_vertices >= GJK_MIN_VERTICES
+                     ? COLLISION_METHOD_GJK
+                     : COLLISION_METHOD_SAT;
+    }
+    collision_info_t result;
+    if (method == COLLISION_METHOD_GJK) {
+        result = find_collision_gjk(shape1, shape2);
+    } else if (normals1 && normals2) {
+        result = find_collision_sat_with_normals(shape1, normals1, shape2,
+                                                 normals2);
+    } else {
+        result = find_collision_sat(shape1, shape2);
+    }
+    if (axis_hint) {
+        *axis_hint = result.axis;
+    }
+    return result;
+}
 
-            min_overlap_axis = axis;
-            min_overlap = overlap;
+/**
+ * Helper function.
+ * Finds the point of the Minkowski difference shape1 - shape2 that is
+ * furthest in a direction.
+ */
+vector_t minkowski_support(polygon_t *shape1, polygon_t *shape2,
+                           vector_t direction) {
+    vector_t furthest1 = shape1->vertices[0];
+    double max1 = vec_dot(furthest1, direction);
+    for (size_t i = 1; i < shape1->num_vertices; i++) {
+        vector_t vertex = shape1->vertices[i];
+        double projection = vec_dot(vertex, direction);
+        if (projection > max1) {
+            furthest1 = vertex;
+            max1 = projection;
+        }
+    }
+    vector_t furthest2 = shape2->vertices[0];
+    double min2 = vec_dot(furthest2, direction);
+    for (size_t i = 1; i < shape2->num_vertices; i++) {
+        vector_t vertex = shape2->vertices[i];
+        double projection = vec_dot(vertex, direction);
+        if (projection < min2) {
+            furthest2 = vertex;
+            min2 = projection;
+        }
+    }
+    return vec_subtract(furthest1, furthest2);
+}
 
-            if (min_overlap == 0) {
-                min_overlap_collision_status = NO_COLLISION;
-                break;
-            } else if ((min_shape1 <= min_shape2 && max_shape1 >= max_shape2) ||
-                       (min_shape2 <= min_shape1 && max_shape2 >= max_shape1)) {
-                min_overlap_collision_status = FULL_COLLISION;
+/**
+ * Helper function.
+ * Returns a vector perpendicular to an edge, on the side of a point.
+ */
+vector_t perpendicular_towards(vector_t edge, vector_t point) {
+    vector_t perpendicular = {.x = -edge.y, .y = edge.x};
+    return vec_dot(perpendicular, point) < 0 ? vec_negate(perpendicular)
+                                             : perpendicular;
+}
+
+/**
+ * Helper function.
+ * Runs GJK on the Minkowski difference of two shapes, which contains the
+ * origin exactly when the shapes overlap.
+ *
+ * @param simplex set to a triangle of the difference containing the origin,
+ *   if the shapes overlap
+ * @param separating_axis set to an axis from shape1 towards shape2 that
+ *   separates them, if they don't
+ * @return 1 if the shapes overlap, 0 if they don't, and -1 if GJK didn't
+ *   converge
+ */
+int gjk_intersect(polygon_t *shape1, polygon_t *shape2, vector_t simplex[3],
+                  vector_t *separating_axis) {
+    vector_t direction =
+        vec_subtract(shape2->vertices[0], shape1->vertices[0]);
+    if (direction.x == 0 && direction.y == 0) {
+        direction = (vector_t){1, 0};
+    }
+    // Search towards the origin, which is opposite shape2 - shape1
+    direction = vec_negate(direction);
+    simplex[0] = minkowski_support(shape1, shape2, direction);
+    direction = vec_negate(simplex[0]);
+    size_t num_points = 1;
+    for (size_t i = 0; i < MAX_GJK_ITERATIONS; i++) {
+        if (direction.x == 0 && direction.y == 0) {
+            // The origin is a point of the simplex, so the shapes only touch
+            *separating_axis = vec_direction(vec_negate(simplex[0]));
+            return 0;
+        }
+        vector_t newest = minkowski_support(shape1, shape2, direction);
+        if (vec_dot(newest, direction) <= 0) {
+            // No point of the difference is past the origin in this direction
+            *separating_axis = vec_direction(direction);
+            return 0;
+        }
+        simplex[num_points] = newest;
+        num_points++;
+        vector_t to_origin = vec_negate(newest);
+        if (num_points == 2) {
+            vector_t edge = vec_subtract(simplex[0], newest);
+            if (vec_dot(edge, to_origin) > 0) {
+                direction = perpendicular_towards(edge, to_origin);
             } else {
-                min_overlap_collision_status = PARTIAL_COLLISION;
+                simplex[0] = newest;
+                num_points = 1;
+                direction = to_origin;
+            }
+            continue;
+        }
+        vector_t edge1 = vec_subtract(simplex[1], newest);
+        vector_t edge0 = vec_subtract(simplex[0], newest);
+        vector_t normal1 = vec_negate(perpendicular_towards(edge1, edge0));
+        vector_t normal0 = vec_negate(perpendicular_towards(edge0, edge1));
+        if (vec_dot(normal1, to_origin) > 0) {
+            // The origin is outside the edge to simplex[1]
+            simplex[0] = simplex[1];
+            simplex[1] = newest;
+            num_points = 2;
+            direction = normal1;
+        } else if (vec_dot(normal0, to_origin) > 0) {
+            simplex[1] = newest;
+            num_points = 2;
+            direction = normal0;
+        } else {
+            simplex[2] = newest;
+            return 1;
+        }
+    }
+    return -1;
+}
+
+collision_info_t find_collision_gjk(polygon_t *shape1, polygon_t *shape2) {
+    collision_stats.gjk_calls++;
+    vector_t simplex[3];
+    vector_t separating_axis;
+    int intersect = gjk_intersect(shape1, shape2, simplex, &separating_axis);
+    if (intersect == 0) {
+        return (collision_info_t){
+            .collided = NO_COLLISION, .axis = separating_axis, .overlap = 0};
+    }
+    double winding = vec_cross(vec_subtract(simplex[1], simplex[0]),
+                               vec_subtract(simplex[2], simplex[0]));
+    if (intersect < 0 || winding == 0) {
+        // Degenerate shapes are left to SAT
+        return find_collision_sat(shape1, shape2);
+    }
+
+    // Expand the triangle (EPA) until its closest edge to the origin is an
+    // edge of the difference
+    vector_t polytope[MAX_EPA_VERTICES];
+    polytope[0] = simplex[0];
+    // Keep the polytope counterclockwise, so edge normals point outwards
+    polytope[1] = winding > 0 ? simplex[1] : simplex[2];
+    polytope[2] = winding > 0 ? simplex[2] : simplex[1];
+    size_t num_vertices = 3;
+    vector_t axis = VEC_ZERO;
+    double overlap = INFINITY;
+    while (true) {
+        size_t closest = 0;
+        overlap = INFINITY;
+        for (size_t i = 0; i < num_vertices; i++) {
+            vector_t edge = vec_subtract(polytope[(i + 1) % num_vertices],
+                                         polytope[i]);
+            vector_t normal = vec_direction((vector_t){edge.y, -edge.x});
+            double distance = vec_dot(normal, polytope[i]);
+            if (distance < overlap) {
+                closest = i;
+                overlap = distance;
+                axis = normal;
             }
         }
+        vector_t support = minkowski_support(shape1, shape2, axis);
+        if (vec_dot(support, axis) - overlap < EPA_TOLERANCE ||
+            num_vertices == MAX_EPA_VERTICES) {
+            break;
+        }
+        for (size_t i = num_vertices; i > closest + 1; i--) {
+            polytope[i] = polytope[i - 1];
+        }
+        polytope[closest + 1] = support;
+        num_vertices++;
+    }
+    if (overlap <= 0) {
+        // The origin is on the boundary, so the shapes only touch
+        return (collision_info_t){
+            .collided = NO_COLLISION, .axis = axis, .overlap = 0};
+    }
+
+    // Measure the collision along the axis like SAT does. When neither
+    // projection contains the other, this is the same as the depth EPA found.
+    double min_shape1, max_shape1, min_shape2, max_shape2;
+    get_projection(shape1, axis, &min_shape1, &max_shape1);
+    get_projection(shape2, axis, &min_shape2, &max_shape2);
+    bool is_full = (min_shape1 <= min_shape2 && max_shape1 >= max_shape2) ||
+                   (min_shape2 <= min_shape1 && max_shape2 >= max_shape1);
+    return (collision_info_t){
+        .collided = is_full ? FULL_COLLISION : PARTIAL_COLLISION,
+        .axis = axis,
+        .overlap =
+            segment_overlap(min_shape1, max_shape1, min_shape2, max_shape2)};
+}
+
+/**
+ * Helper function.
+ * Projects a capsule onto an axis.
+ */
+void get_capsule_projection(capsule_t capsule, vector_t axis, double *min,
+                            double *max) {
+    double start = vec_dot(capsule.start, axis);
+    double end = vec_dot(capsule.end, axis);
+    *min = fmin(start, end) - capsule.radius;
+    *max = fmax(start, end) + capsule.radius;
+}
+
+/**
+ * Helper function.
+ * Builds the result of a collision along an axis from the projections of the
+ * two shapes onto it, the same way SAT does.
+ * The axis is flipped if needed so that it points from shape1 to shape2.
+ */
+collision_info_t measure_collision(vector_t axis, double min_shape1,
+                                   double max_shape1, double min_shape2,
+                                   double max_shape2) {
+    if ((min_shape2 + max_shape2) < (min_shape1 + max_shape1)) {
+        axis = vec_negate(axis);
+    }
+    double overlap =
+        segment_overlap(min_shape1, max_shape1, min_shape2, max_shape2);
+    collision_status_t collided = PARTIAL_COLLISION;
+    if (overlap == 0) {
+        collided = NO_COLLISION;
+    } else if ((min_shape1 <= min_shape2 && max_shape1 >= max_shape2) ||
+               (min_shape2 <= min_shape1 && max_shape2 >= max_shape1)) {
+        collided = FULL_COLLISION;
+    }
+    return (collision_info_t){
+        .collided = collided, .axis = axis, .overlap = overlap};
+}
+
+/**
+ * Helper function.
+ * Finds the closest points of two line segments, p1-q1 and p2-q2
+ * (see Ericson, Real-Time Collision Detection, 5.1.9).
+ *
+ * @param closest1 set to the closest point on the first segment
+ * @param closest2 set to the closest point on the second segment
+ * @return the distance between the segments
+ */
+double closest_points_on_segments(vector_t p1, vector_t q1, vector_t p2,
+                                  vector_t q2, vector_t *closest1,
+                                  vector_t *closest2) {
+    vector_t d1 = vec_subtract(q1, p1);
+    vector_t d2 = vec_subtract(q2, p2);
+    vector_t r = vec_subtract(p1, p2);
+    double a = vec_dot(d1, d1);
+    double e = vec_dot(d2, d2);
+    double f = vec_dot(d2, r);
+    double s = 0;
+    double t = 0;
+    if (a == 0 && e == 0) {
+        // Both segments are points
+    } else if (a == 0) {
+        t = fmin(fmax(f / e, 0), 1);
+    } else {
+        double c = vec_dot(d1, r);
+        if (e == 0) {
+            s = fmin(fmax(-c / a, 0), 1);
+        } else {
+            double b = vec_dot(d1, d2);
+            double denom = a * e - b * b;
+            // Parallel segments can use any s
+            if (denom != 0) {
+                s = fmin(fmax((b * f - c * e) / denom, 0), 1);
+            }
+            t = (b * s + f) / e;
+            if (t < 0) {
+                t = 0;
+                s = fmin(fmax(-c / a, 0), 1);
+            } else if (t > 1) {
+                t = 1;
+                s = fmin(fmax((b - c) / a, 0), 1);
+            }
+        }
+    }
+    *closest1 = vec_add(p1, vec_multiply(s, d1));
+    *closest2 = vec_add(p2, vec_multiply(t, d2));
+    return vec_distance(*closest1, *closest2);
+}
+
+/**
+ * Helper function.
+ * Returns whether a point is inside or on a convex polygon,
+ * in either winding direction.
+ */
+bool polygon_contains(polygon_t *polygon, vector_t point) {
+    size_t num_vertices = polygon->num_vertices;
+    bool has_left = false;
+    bool has_right = false;
+    for (size_t i = 0; i < num_vertices; i++) {
+        vector_t v1 = polygon->vertices[i];
+        vector_t v2 = polygon->vertices[(i + 1) % num_vertices];
+        double turn = vec_cross(vec_subtract(v2, v1), vec_subtract(point, v1));
+        has_left |= turn > 0;
+        has_right |= turn < 0;
+    }
+    return !(has_left && has_right);
+}
+
+collision_info_t find_collision_capsules(capsule_t capsule1,
+                                         capsule_t capsule2) {
+    vector_t closest1, closest2;
+    double distance =
+        closest_points_on_segments(capsule1.start, capsule1.end, capsule2.start,
+                                   capsule2.end, &closest1, &closest2);
+    vector_t axis;
+    if (distance > 0) {
+        axis = vec_multiply(1 / distance, vec_subtract(closest2, closest1));
+    } else {
+        // The segments cross, so separate them sideways
+        vector_t direction = vec_subtract(capsule1.end, capsule1.start);
+        if (direction.x == 0 && direction.y == 0) {
+            direction = vec_subtract(capsule2.end, capsule2.start);
+        }
+        axis = (direction.x == 0 && direction.y == 0)
+                   ? (vector_t){1, 0}
+                   : vec_direction((vector_t){-direction.y, direction.x});
+    }
+    double min1, max1, min2, max2;
+    get_capsule_projection(capsule1, axis, &min1, &max1);
+    get_capsule_projection(capsule2, axis, &min2, &max2);
+    return measure_collision(axis, min1, max1, min2, max2);
+}
+
+collision_info_t find_collision_capsule_polygon(capsule_t capsule,
+                                                polygon_t *polygon) {
+    size_t num_vertices = polygon->num_vertices;
+    if (!polygon_contains(polygon, capsule.start)) {
+        // Find how far the capsule's segment is from the polygon's boundary
+        double distance = INFINITY;
+        vector_t closest_capsule = VEC_ZERO, closest_polygon = VEC_ZERO;
+        for (size_t i = 0; i < num_vertices; i++) {
+            vector_t v1 = polygon->vertices[i];
+            vector_t v2 =
+                polygon->vertices[(i + 1) % num_vertices];
+            vector_t on_capsule, on_polygon;
+            double edge_distance = closest_points_on_segments(
+                capsule.start, capsule.end, v1, v2, &on_capsule, &on_polygon);
+            if (edge_distance < distance) {
+                distance = edge_distance;
+                closest_capsule = on_capsule;
+                closest_polygon = on_polygon;
+            }
+        }
+        if (distance >= capsule.radius) {
+            vector_t axis = vec_direction(
+                vec_subtract(closest_polygon, closest_capsule));
+            return (collision_info_t){
+                .collided = NO_COLLISION, .axis = axis, .overlap = 0};
+        }
+        if (distance > 0) {
+            // Only the rounded part of the capsule overlaps the polygon
+            vector_t axis = vec_multiply(
+                1 / distance, vec_subtract(closest_polygon, closest_capsule));
+            double min1, max1, min2, max2;
+            get_capsule_projection(capsule, axis, &min1, &max1);
+            get_projection(polygon, axis, &min2, &max2);
+            return measure_collision(axis, min1, max1, min2, max2);
+        }
+    }
+
+    // The segment reaches into the polygon, so the axis of least overlap is
+    // one of the polygon's edge normals or the capsule's own normal
+    collision_info_t result = {
+        .collided = NO_COLLISION, .axis = VEC_ZERO, .overlap = INFINITY};
+    vector_t direction = vec_subtract(capsule.end, capsule.start);
+    for (size_t i = 0; i <= num_vertices; i++) {
+        vector_t edge = direction;
+        if (i < num_vertices) {
+            edge = vec_subtract(
+                polygon->vertices[(i + 1) % num_vertices],
+                polygon->vertices[i]);
+        }
+        if (edge.x == 0 && edge.y == 0) {
+            continue;
+        }
+        vector_t axis = vec_direction((vector_t){-edge.y, edge.x});
+        double min1, max1, min2, max2;
+        get_capsule_projection(capsule, axis, &min1, &max1);
+        get_projection(polygon, axis, &min2, &max2);
+        collision_info_t info = measure_collision(axis, min1, max1, min2, max2);
+        if (info.overlap < result.overlap) {
+            result = info;
+        }
     }
-    list_free(perpendicular_axes1);
-    list_free(perpendicular_axes2);
-    list_free(perpendicular_axes);
-    collision_info_t result = {.collided = min_overlap_collision_status,
-                               .axis = min_overlap_axis, .overlap = min_overlap};
     return result;
 }
+
+/**
+ * Helper function.
+ * Narrows the interval of time [*t_first, *t_last] to when the projections of
+ * two shapes onto an axis overlap, as shape1 moves by `speed` along the axis.
+ *
+ * @return false if the projections never overlap during the movement
+ */
+bool clip_time_of_impact(double min_shape1, double max_shape1,
+                         double min_shape2, double max_shape2, double speed,
+                         double *t_first, double *t_last) {
+    double t_enter, t_leave;
+    if (max_shape1 < min_shape2) {
+        if (speed <= 0) {
+            return false;
+        }
+        t_enter = (min_shape2 - max_shape1) / speed;
+        t_leave = (max_shape2 - min_shape1) / speed;
+    } else if (max_shape2 < min_shape1) {
+        if (speed >= 0) {
+            return false;
+        }
+        t_enter = (max_shape2 - min_shape1) / speed;
+        t_leave = (min_shape2 - max_shape1) / speed;
+    } else {
+        // Already overlapping along this axis
+        t_enter = 0;
+        if (speed > 0) {
+            t_leave = (max_shape2 - min_shape1) / speed;
+        } else if (speed < 0) {
+            t_leave = (min_shape2 - max_shape1) / speed;
+        } else {
+            t_leave = INFINITY;
+        }
+    }
+    if (t_enter > *t_first) {
+        *t_first = t_enter;
+    }
+    if (t_leave < *t_last) {
+        *t_last = t_leave;
+    }
+    return *t_first <= *t_last;
+}
+
+double find_time_of_impact(polygon_t *shape1, polygon_t *shape2,
+                           vector_t displacement) {
+    vector_t unique_axes[MAX_UNIQUE_AXES];
+    size_t num_unique_axes = 0;
+    double t_first = 0;
+    double t_last = 1;
+    polygon_t *shapes[] = {shape1, shape2};
+    for (size_t s = 0; s < 2; s++) {
+        polygon_t *shape = shapes[s];
+        size_t num_vertices = shape->num_vertices;
+        for (size_t v1 = 0; v1 < num_vertices; v1++) {
+            size_t v2 = (v1 + 1) % num_vertices;
+            vector_t edge =
+                vec_subtract(shape->vertices[v2], shape->vertices[v1]);
+            vector_t axis = vec_direction((vector_t){.x = -edge.y, .y = edge.x});
+            if ((axis.x == 0 && axis.y == 0) ||
+                is_duplicate_axis(unique_axes, num_unique_axes, axis)) {
+                continue;
+            }
+            if (num_unique_axes < MAX_UNIQUE_AXES) {
+                unique_axes[num_unique_axes] = axis;
+                num_unique_axes++;
+            }
+
+            double min_shape1, max_shape1, min_shape2, max_shape2;
+            get_projection(shape1, axis, &min_shape1, &max_shape1);
+            get_projection(shape2, axis, &min_shape2, &max_shape2);
+            if (!clip_time_of_impact(min_shape1, max_shape1, min_shape2,
+                                     max_shape2, vec_dot(displacement, axis),
+                                     &t_first, &t_last)) {
+                return INFINITY;
+            }
+        }
+    }
+    return t_first;
+}
@@ -38,6 +38,7 @@ typedef struct physical_constraint_force_params {
  * collided in the last frame.
  * is_full_collision - if true, the handler is only applied if the collision is
  * full - that is, the bodies fully overlap
+ * separating_axis - the axis to test first in the next collision check
  * aux - parameters passed to collision_handler
  * freer - a function to free aux
  */
@@ -48,6 +49,7 @@ typedef struct collision_force_params {
     bool collided_in_last_frame;
     bool is_contact_collision;
     bool is_full_collision;
+    vector_t separating_axis;
     void *aux;
     free_func_t freer;
 } collision_force_params_t;
@@ -60,19 +62,23 @@ typedef struct special_interaction_force_params {
     free_func_t freer;
 } special_interaction_force_params_t;
 
-one_body_force_params_t *one_body_force_params_init(double force_constant,
+one_body_force_params_t *one_body_force_params_init(scene_t *scene,
+                                                    double force_constant,
                                                     body_t *body) {
-    one_body_force_params_t *result = malloc(sizeof(one_body_force_params_t));
+    one_body_force_params_t *result =
+        scene_alloc(scene, sizeof(one_body_force_params_t));
     result->force_constant = force_constant;
     result->body = body;
     return result;
 }
 
-two_body_force_params_t *two_body_force_params_init(double force_constant,
+two_body_force_params_t *two_body_force_params_init(scene_t *scene,
+                                                    double force_constant,
                                                     body_t *body1,
                                                     body_t *body2) {
 
-    two_body_force_params_t *result = malloc(sizeof(two_body_force_params_t));
+    two_body_force_params_t *result =
+        scene_alloc(scene, sizeof(two_body_force_params_t));
     result->force_constant = force_constant;
     result->body1 = body1;
     result->body2 = body2;
@@ -80,10 +86,10 @@ two_body_force_params_t *two_body_force_params_init(double force_constant,
 }
 
 physical_constraint_force_params_t *
-physical_constraint_force_params_init(vector_t displacement, body_t *body1,
-                                      body_t *body2) {
+physical_constraint_force_params_init(scene_t *scene, vector_t displacement,
+                                      body_t *body1, body_t *body2) {
     physical_constraint_force_params_t *result =
-        malloc(sizeof(physical_constraint_force_params_t));
+        scene_alloc(scene, sizeof(physical_constraint_force_params_t));
     result->displacement = displacement;
     result->body1 = body1;
     result->body2 = body2;
@@ -91,28 +97,31 @@ physical_constraint_force_params_init(vector_t displacement, body_t *body1,
 }
 
 collision_force_params_t *
-collision_force_params_init(body_t *body1, body_t *body2,
+collision_force_params_init(scene_t *scene, body_t *body1, body_t *body2,
                             collision_handler_t collision_handler,
                             bool is_contact_collision, bool is_full_collision,
                             void *aux, free_func_t freer) {
-    collision_force_params_t *result = malloc(sizeof(collision_force_params_t));
+    collision_force_params_t *result =
+        scene_alloc(scene, sizeof(collision_force_params_t));
     result->body1 = body1;
     result->body2 = body2;
     result->collision_handler = collision_handler;
     result->is_contact_collision = is_contact_collision;
     result->is_full_collision = is_full_collision;
     result->collided_in_last_frame = false;
+    result->separating_axis = VEC_ZERO;
     result->aux = aux;
     result->freer = freer;
     return result;
 }
 
 special_interaction_force_params_t *
-special_interaction_force_params_init(body_t *body1, body_t *body2,
+special_interaction_force_params_init(scene_t *scene, body_t *body1,
+                                      body_t *body2,
                                       special_interaction_handler_t handler,
                                       void *aux, free_func_t freer) {
     special_interaction_force_params_t *result =
-        malloc(sizeof(special_interaction_force_params_t));
+        scene_alloc(scene, sizeof(special_interaction_force_params_t));
     result->body1 = body1;
     result->body2 = body2;
     result->handler = handler;
@@ -121,11 +130,11 @@ special_interaction_force_params_init(body_t *body1, body_t *body2,
     return result;
 }
 
+// The parameters themselves are allocated with scene_alloc()
 void collision_force_params_free(collision_force_params_t *params) {
     if (params->freer) {
         params->freer(params->aux);
     }
-    free(params);
 }
 
 void special_iteraction_force_params_free(
@@ -133,7 +142,6 @@ void special_iteraction_force_params_free(
     if (params->freer) {
         params->freer(params->aux);
     }
-    free(params);
 }
 
 void newtonian_gravity_force_creator(two_body_force_params_t *gravity_params) {
@@ -157,12 +165,10 @@ void newtonian_gravity_force_creator(two_body_force_params_t *gravity_params) {
 
 void create_newtonian_gravity(scene_t *scene, double G, body_t *body1,
                               body_t *body2) {
-    list_t *bodies = list_init(2, NULL);
-    list_add(bodies, body1);
-    list_add(bodies, body2);
-    scene_add_bodies_force_creator(
-        scene, (force_creator_t)newtonian_gravity_force_creator,
-        two_body_force_params_init(G, body1, body2), bodies, free);
+    body_t *bodies[] = {body1, body2};
+    scene_add_body_array_force_creator(
+        scene, (force_creator_t)newtonian_gravity_force_creator, false,
+        two_body_force_params_init(scene, G, body1, body2), bodies, 2, NULL);
 }
 
 void global_gravity_force_creator(one_body_force_params_t *gravity_params) {
@@ -173,11 +179,10 @@ void global_gravity_force_creator(one_body_force_params_t *gravity_params) {
 }
 
 void create_global_gravity(scene_t *scene, double g, body_t *body) {
-    list_t *bodies = list_init(1, NULL);
-    list_add(bodies, body);
-    scene_add_bodies_force_creator(
-        scene, (force_creator_t)global_gravity_force_creator,
-        one_body_force_params_init(g, body), bodies, free);
+    body_t *bodies[] = {body};
+    scene_add_body_array_force_creator(
+        scene, (force_creator_t)global_gravity_force_creator, false,
+        one_body_force_params_init(scene, g, body), bodies, 1, NULL);
 }
 
 void spring_force_creator(two_body_force_params_t *spring_params) {
@@ -194,12 +199,10 @@ void spring_force_creator(two_body_force_params_t *spring_params) {
 }
 
 void create_spring(scene_t *scene, double k, body_t *body1, body_t *body2) {
-    list_t *bodies = list_init(2, NULL);
-    list_add(bodies, body1);
-    list_add(bodies, body2);
-    scene_add_bodies_force_creator(scene, (force_creator_t)spring_force_creator,
-                                   two_body_force_params_init(k, body1, body2),
-                                   bodies, free);
+    body_t *bodies[] = {body1, body2};
+    scene_add_body_array_force_creator(
+        scene, (force_creator_t)spring_force_creator, false,
+        two_body_force_params_init(scene, k, body1, body2), bodies, 2, NULL);
 }
 
 void drag_force_creator(one_body_force_params_t *drag_params) {
@@ -209,15 +212,17 @@ void drag_force_creator(one_body_force_params_t *drag_params) {
 }
 
 void create_drag(scene_t *scene, double gamma, body_t *body) {
-    list_t *bodies = list_init(2, NULL);
-    list_add(bodies, body);
-    scene_add_bodies_force_creator(scene, (force_creator_t)drag_force_creator,
-                                   one_body_force_params_init(gamma, body),
-                                   bodies, free);
+    body_t *bodies[] = {body};
+    scene_add_body_array_force_creator(
+        scene, (force_creator_t)drag_force_creator, false,
+        one_body_force_params_init(scene, gamma, body), bodies, 1, NULL);
 }
 
 void friction_collision_handler(body_t *body1, body_t *body2,
                                 vector_t collision_axis, double *mu) {
+    if (body_is_sensor(body1) || body_is_sensor(body2)) {
+        return;
+    }
     vector_t parallel_axis = vec_rotate(collision_axis, PI / 2);
     vector_t relative_velocity =
         vec_subtract(body_get_velocity(body1), body_get_velocity(body2));
@@ -231,11 +236,25 @@ void friction_collision_handler(body_t *body1, body_t *body2,
 }
 
 void create_friction(scene_t *scene, double mu, body_t *body1, body_t *body2) {
-    double *mu_aux = malloc(sizeof(double));
+    double *mu_aux = scene_alloc(scene, sizeof(double));
     *mu_aux = mu;
     create_contact_collision(scene, body1, body2,
                              (collision_handler_t)friction_collision_handler,
-                             mu_aux, free);
+                             mu_aux, NULL);
+}
+
+void create_friction_rule(scene_t *scene, double mu, uint32_t layer1,
+                          uint32_t layer2) {
+    double *mu_aux = scene_alloc(scene, sizeof(double));
+    *mu_aux = mu;
+    collision_rule_t rule = {
+        .layer1 = layer1,
+        .layer2 = layer2,
+        .handler = (collision_handler_t)friction_collision_handler,
+        .is_post_tick = false,
+        .is_contact_collision = true,
+        .is_full_collision = false};
+    scene_add_collision_rule(scene, rule, mu_aux, NULL);
 }
 
 void physical_rigid_constraint_force_creator(
@@ -262,19 +281,19 @@ void physical_rigid_constraint_force_creator(
 
 void create_physical_rigid_constraint(scene_t *scene, body_t *body1,
                                       body_t *body2) {
-    list_t *bodies = list_init(2, NULL);
-    list_add(bodies, body1);
-    list_add(bodies, body2);
+    body_t *bodies[] = {body1, body2};
     vector_t displacement =
         vec_subtract(body_get_centroid(body1), body_get_centroid(body2));
-    scene_add_bodies_generic_force_creator(
+    scene_add_body_array_force_creator(
         scene, (force_creator_t)physical_rigid_constraint_force_creator, true,
-        physical_constraint_force_params_init(displacement, body1, body2),
-        bodies, free);
+        physical_constraint_force_params_init(scene, displacement, body1,
+                                              body2),
+        bodies, 2, NULL);
 }
 
 void generic_collision_force_creator(collision_force_params_t *params) {
-    collision_info_t info = detect_body_collision(params->body1, params->body2);
+    collision_info_t info = detect_body_collision_with_hint(
+        params->body1, params->body2, &params->separating_axis);
     if (info.collided) {
         // If contact collision, allow collision in last frame to activate.
         // If full collision, only activate on full collisions.
@@ -297,17 +316,16 @@ void create_generic_collision(scene_t *scene, body_t *body1, body_t *body2,
                               collision_handler_t handler, bool is_post_tick,
                               bool is_contact_collision, bool is_full_collision,
                               void *aux, free_func_t freer) {
-    list_t *bodies = list_init(2, NULL);
-    list_add(bodies, body1);
-    list_add(bodies, body2);
+    body_t *bodies[] = {body1, body2};
 
     collision_force_params_t *collision_force_params =
-        collision_force_params_init(body1, body2, handler, is_contact_collision,
-                                    is_full_collision, aux, freer);
+        collision_force_params_init(scene, body1, body2, handler,
+                                    is_contact_collision, is_full_collision,
+                                    aux, freer);
 
-    scene_add_bodies_generic_force_creator(
+    scene_add_body_array_force_creator(
         scene, (force_creator_t)generic_collision_force_creator, is_post_tick,
-        collision_force_params, bodies,
+        collision_force_params, bodies, 2,
         (free_func_t)collision_force_params_free);
 }
 
@@ -377,6 +395,9 @@ vector_t get_physics_collision_impulse(body_t *body1, body_t *body2,
 
 void physics_collision_handler(body_t *body1, body_t *body2, vector_t axis,
                                double *elasticity) {
+    if (body_is_sensor(body1) || body_is_sensor(body2)) {
+        return;
+    }
     vector_t impulse1 =
         get_physics_collision_impulse(body1, body2, axis, *elasticity);
     vector_t impulse2 = vec_negate(impulse1);
@@ -386,28 +407,39 @@ void physics_collision_handler(body_t *body1, body_t *body2, vector_t axis,
 
 void create_physics_collision(scene_t *scene, double elasticity, body_t *body1,
                               body_t *body2) {
-    double *elasticity_aux = malloc(sizeof(double));
+    double *elasticity_aux = scene_alloc(scene, sizeof(double));
     *elasticity_aux = elasticity;
     create_collision(scene, body1, body2,
                      (collision_handler_t)physics_collision_handler,
-                     elasticity_aux, free);
+                     elasticity_aux, NULL);
 }
 
 void create_physics_contact_collision(scene_t *scene, double elasticity,
                                       body_t *body1, body_t *body2) {
-    double *elasticity_aux = malloc(sizeof(double));
+    double *elasticity_aux = scene_alloc(scene, sizeof(double));
     *elasticity_aux = elasticity;
     create_contact_collision(scene, body1, body2,
                              (collision_handler_t)physics_collision_handler,
-                             elasticity_aux, free);
+                             elasticity_aux, NULL);
 }
 
 void instant_resolution_collision_handler(body_t *body1, body_t *body2,
                                           vector_t axis, void *aux) {
+    if (body_is_sensor(body1) || body_is_sensor(body2)) {
+        return;
+    }
+    // The scene already detected this collision, so this is a cache hit,
+    // unless a handler moved the bodies since then
+    collision_info_t info = detect_body_collision(body1, body2);
+    // Resolving another collision may have separated the bodies already
+    if (info.collided == NO_COLLISION) {
+        return;
+    }
     // If it's a full collision, we can't do anything - give up
-    if (detect_body_collision(body1, body2).collided == FULL_COLLISION) {
+    if (info.collided == FULL_COLLISION) {
         return;
     }
+    axis = info.axis;
     double m1 = body_get_mass(body1);
     double m2 = body_get_mass(body2);
     if (m1 == INFINITY && m2 == INFINITY) {
@@ -416,7 +448,7 @@ void instant_resolution_collision_handler(body_t *body1, body_t *body2,
     double reduced_mass = (m1 == INFINITY)   ? m2
                           : (m2 == INFINITY) ? m1
                                              : ((m1 * m2) / (m1 + m2));
-    double overlap = detect_body_collision(body1, body2).overlap;
+    double overlap = info.overlap;
     double translation_body1 =
         -reduced_mass / m1 * (overlap + INSTANT_COLLISION_RESOLUTION_EPSILON);
     double translation_body2 =
@@ -442,6 +474,18 @@ void create_instant_resolution_collision(scene_t *scene, body_t *body1,
     }
 }
 
+void create_instant_resolution_collision_rule(scene_t *scene, uint32_t layer1,
+                                              uint32_t layer2) {
+    collision_rule_t rule = {
+        .layer1 = layer1,
+        .layer2 = layer2,
+        .handler = (collision_handler_t)instant_resolution_collision_handler,
+        .is_post_tick = true,
+        .is_contact_collision = true,
+        .is_full_collision = false};
+    scene_add_collision_rule(scene, rule, NULL, NULL);
+}
+
 void special_interaction_force_creator(
     special_interaction_force_params_t *params) {
     params->handler(params->body1, params->body2, params->aux);
@@ -451,16 +495,14 @@ void create_special_interaction(scene_t *scene, body_t *body1, body_t *body2,
                                 special_interaction_handler_t handler,
                                 bool is_post_tick, void *aux,
                                 free_func_t freer) {
-    list_t *bodies = list_init(2, NULL);
-    list_add(bodies, body1);
-    list_add(bodies, body2);
+    body_t *bodies[] = {body1, body2};
 
     special_interaction_force_params_t *interaction_force_params =
-        special_interaction_force_params_init(body1, body2, handler, aux,
-                                              freer);
+        special_interaction_force_params_init(scene, body1, body2, handler,
+                                              aux, freer);
 
-    scene_add_bodies_generic_force_creator(
+    scene_add_body_array_force_creator(
         scene, (force_creator_t)special_interaction_force_creator, is_post_tick,
-        interaction_force_params, bodies,
+        interaction_force_params, bodies, 2,
         (free_func_t)special_iteraction_force_params_free);
 }
@@ -21,13 +21,13 @@ list_t *list_init(size_t initial_capacity, free_func_t freer) {
     list_t *list = malloc(sizeof(list_t));
     assert(list);
     list->size = 0;
-    assert(list->data);
     if (initial_capacity <= 0) {
         list->capacity = 1;
     } else {
         list->capacity = initial_capacity;
     }
     list->data = malloc(sizeof(void *) * list->capacity);
+    assert(list->data);
     list->freer = freer;
     return list;
 }
@@ -4,16 +4,45 @@
 #include <assert.h>
 #include <float.h>
 #include <math.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
-bounding_box_t polygon_get_bounding_box(list_t *polygon) {
+polygon_t *polygon_init(size_t num_vertices) {
+    polygon_t *polygon =
+        malloc(sizeof(polygon_t) + num_vertices * sizeof(vector_t));
+    assert(polygon);
+    polygon->num_vertices = num_vertices;
+    return polygon;
+}
+
+polygon_t *polygon_from_list(list_t *vertices) {
+    polygon_t *polygon = polygon_init(list_size(vertices));
+    for (size_t i = 0; i < polygon->num_vertices; i++) {
+        polygon->vertices[i] = *(vector_t *)list_get(vertices, i);
+    }
+    return polygon;
+}
+
+polygon_t *polygon_copy(const polygon_t *polygon) {
+    polygon_t *result = polygon_init(polygon->num_vertices);
+    memcpy(result->vertices, polygon->vertices,
+           polygon->num_vertices * sizeof(vector_t));
+    return result;
+}
+
+void polygon_free(polygon_t *polygon) {
+    free(polygon);
+}
+
+bounding_box_t polygon_get_bounding_box(const polygon_t *polygon) {
     double min_x = INFINITY;
     double min_y = INFINITY;
     double max_x = -INFINITY;
     double max_y = -INFINITY;
-    for (size_t i = 0; i < list_size(polygon); i++) {
-        vector_t *vertex = list_get(polygon, i);
+    for (size_t i = 0; i < polygon->num_vertices; i++) {
+        const vector_t *vertex = &polygon->vertices[i];
         if (vertex->x < min_x) {
             min_x = vertex->x;
         }
@@ -32,25 +61,25 @@ bounding_box_t polygon_get_bounding_box(list_t *polygon) {
     return bounding_box;
 }
 
-double polygon_area(list_t *polygon) {
+double polygon_area(const polygon_t *polygon) {
     double area = 0;
-    size_t num_verts = list_size(polygon);
+    size_t num_verts = polygon->num_vertices;
     for (size_t i = 0; i < num_verts; i++) {
-        vector_t *vec1 = list_get(polygon, i);
-        vector_t *vec2 = list_get(polygon, (i + 1) % num_verts);
+        const vector_t *vec1 = &polygon->vertices[i];
+        const vector_t *vec2 = &polygon->vertices[(i + 1) % num_verts];
         area += vec_cross(*vec1, *vec2) / 2;
     }
     return area;
 }
 
-vector_t polygon_centroid(list_t *polygon) {
+vector_t polygon_centroid(const polygon_t *polygon) {
     double centroid_x = 0;
     double centroid_y = 0;
-    size_t num_verts = list_size(polygon);
+    size_t num_verts = polygon->num_vertices;
     double area = polygon_area(polygon);
     for (size_t i = 0; i < num_verts; i++) {
-        vector_t *vec1 = list_get(polygon, i);
-        vector_t *vec2 = list_get(polygon, (i + 1) % num_verts);
+        const vector_t *vec1 = &polygon->vertices[i];
+        const vector_t *vec2 = &polygon->vertices[(i + 1) % num_verts];
         centroid_x += (vec1->x + vec2->x) * vec_cross(*vec1, *vec2);
         centroid_y += (vec1->y + vec2->y) * vec_cross(*vec1, *vec2);
     }
@@ -60,25 +89,94 @@ vector_t polygon_centroid(list_t *polygon) {
     return result;
 }
 
-void polygon_translate(list_t *polygon, vector_t translation) {
-    size_t num_verts = list_size(polygon);
+void polygon_translate(polygon_t *polygon, vector_t translation) {
+    size_t num_verts = polygon->num_vertices;
     for (size_t i = 0; i < num_verts; i++) {
-        vector_t *vec = list_get(polygon, i);
+        vector_t *vec = &polygon->vertices[i];
         *vec = vec_add(*vec, translation);
     }
 }
 
-void polygon_rotate(list_t *polygon, double angle, vector_t point) {
-    size_t num_verts = list_size(polygon);
+void polygon_rotate(polygon_t *polygon, double angle, vector_t point) {
+    size_t num_verts = polygon->num_vertices;
     polygon_translate(polygon, vec_negate(point));
     for (size_t i = 0; i < num_verts; i++) {
-        vector_t *vec = list_get(polygon, i);
+        vector_t *vec = &polygon->vertices[i];
         *vec = vec_rotate(*vec, angle);
     }
     polygon_translate(polygon, point);
 }
 
-void move_anchor_to_current_center(list_t *polygon, anchor_option_t anchor) {
+/**
+ * Helper function.
+ * Returns 1 if a convex polygon's vertices are counterclockwise, -1 if they
+ * are clockwise, and 0 if the polygon has no area.
+ */
+double polygon_winding(const polygon_t *polygon) {
+    size_t num_verts = polygon->num_vertices;
+    for (size_t i = 0; i < num_verts; i++) {
+        const vector_t *v0 = &polygon->vertices[i];
+        const vector_t *v1 = &polygon->vertices[(i + 1) % num_verts];
+        const vector_t *v2 = &polygon->vertices[(i + 2) % num_verts];
+        double turn =
+            vec_cross(vec_subtract(*v1, *v0), vec_subtract(*v2, *v1));
+        if (turn != 0) {
+            return turn > 0 ? 1 : -1;
+        }
+    }
+    return 0;
+}
+
+bool polygon_segment_intersect(const polygon_t *polygon, vector_t start,
+                               vector_t end, double *t_enter, double *t_exit) {
+    double winding = polygon_winding(polygon);
+    if (winding == 0) {
+        return false;
+    }
+    vector_t direction = vec_subtract(end, start);
+    double enter = 0;
+    double exit = 1;
+    size_t num_verts = polygon->num_vertices;
+    for (size_t i = 0; i < num_verts; i++) {
+        const vector_t *v1 = &polygon->vertices[i];
+        const vector_t *v2 = &polygon->vertices[(i + 1) % num_verts];
+        vector_t edge = vec_subtract(*v2, *v1);
+        vector_t outward_normal =
+            vec_multiply(winding, (vector_t){.x = edge.y, .y = -edge.x});
+        // How far start is inside this edge, and how fast the segment
+        // moves out of it
+        double depth = vec_dot(outward_normal, vec_subtract(*v1, start));
+        double speed = vec_dot(outward_normal, direction);
+        if (speed == 0) {
+            // Parallel to the edge, so it is either always or never inside
+            if (depth < 0) {
+                return false;
+            }
+            continue;
+        }
+        double t = depth / speed;
+        if (speed < 0) {
+            if (t > enter) {
+                enter = t;
+            }
+        } else if (t < exit) {
+            exit = t;
+        }
+        if (enter > exit) {
+            return false;
+        }
+    }
+    if (t_enter) {
+        *t_enter = enter;
+    }
+    if (t_exit) {
+        *t_exit = exit;
+    }
+    return true;
+}
+
+void move_anchor_to_current_center(polygon_t *polygon,
+                                   anchor_option_t anchor) {
     bounding_box_t bbox = polygon_get_bounding_box(polygon);
     vector_t centroid = polygon_centroid(polygon);
     double x_translation = 0;
@@ -101,66 +199,187 @@ void move_anchor_to_current_center(list_t *polygon, anchor_option_t anchor) {
     polygon_translate(polygon, translation);
 }
 
-list_t *initialize_star(vector_t center, size_t num_arms, double circumradius,
-                        double inradius) {
+/**
+ * Helper function.
+ * Orders points by x, then by y, for qsort().
+ */
+int compare_points(const void *point1, const void *point2) {
+    const vector_t *v1 = point1;
+    const vector_t *v2 = point2;
+    if (v1->x != v2->x) {
+        return v1->x < v2->x ? -1 : 1;
+    }
+    return v1->y < v2->y ? -1 : v1->y > v2->y;
+}
+
+/**
+ * Helper function.
+ * Returns twice the signed area of the triangle (a, b, c), which is positive
+ * if the vertices are counterclockwise.
+ */
+double triangle_turn(vector_t a, vector_t b, vector_t c) {
+    return vec_cross(vec_subtract(b, a), vec_subtract(c, a));
+}
+
+polygon_t *polygon_convex_hull(polygon_t *polygon, size_t max_vertices) {
+    assert(max_vertices >= 3);
+    size_t num_verts = polygon->num_vertices;
+    vector_t points[num_verts];
+    memcpy(points, polygon->vertices, num_verts * sizeof(vector_t));
+    qsort(points, num_verts, sizeof(vector_t), compare_points);
+
+    // Andrew's monotone chain: the lower hull, then the upper hull
+    vector_t hull[2 * num_verts];
+    size_t hull_size = 0;
+    for (size_t pass = 0; pass < 2; pass++) {
+        size_t start_size = hull_size;
+        for (size_t j = 0; j < num_verts; j++) {
+            vector_t point = points[pass == 0 ? j : num_verts - 1 - j];
+            while (hull_size >= start_size + 2 &&
+                   triangle_turn(hull[hull_size - 2], hull[hull_size - 1],
+                                 point) <= 0) {
+                hull_size--;
+            }
+            hull[hull_size] = point;
+            hull_size++;
+        }
+        // The last point is the first point of the other half
+        hull_size--;
+    }
+
+    // Drop the vertices that add the least area until the budget is met
+    while (hull_size > max_vertices) {
+        size_t flattest = 0;
+        double min_area = INFINITY;
+        for (size_t j = 0; j < hull_size; j++) {
+            double area = triangle_turn(hull[(j + hull_size - 1) % hull_size],
+                                        hull[j], hull[(j + 1) % hull_size]);
+            if (area < min_area) {
+                flattest = j;
+                min_area = area;
+            }
+        }
+        for (size_t j = flattest; j + 1 < hull_size; j++) {
+            hull[j] = hull[j + 1];
+        }
+        hull_size--;
+    }
+
+    polygon_t *result = polygon_init(hull_size);
+    memcpy(result->vertices, hull, hull_size * sizeof(vector_t));
+    return result;
+}
+
+polygon_t *polygon_oriented_bounding_box(polygon_t *polygon) {
+    // The smallest box has a side along an edge of the convex hull
+    polygon_t *hull = polygon_convex_hull(polygon, SIZE_MAX);
+    size_t hull_size = hull->num_vertices;
+    double min_area = INFINITY;
+    vector_t best_axis = {1, 0};
+    double best_min_u = 0, best_max_u = 0, best_min_v = 0, best_max_v = 0;
+    for (size_t i = 0; i < hull_size; i++) {
+        vector_t *vertex1 = &hull->vertices[i];
+        vector_t *vertex2 = &hull->vertices[(i + 1) % hull_size];
+        vector_t edge = vec_subtract(*vertex2, *vertex1);
+        if (edge.x == 0 && edge.y == 0) {
+            continue;
+        }
+        vector_t u = vec_direction(edge);
+        vector_t v = {.x = -u.y, .y = u.x};
+        double min_u = INFINITY, max_u = -INFINITY;
+        double min_v = INFINITY, max_v = -INFINITY;
+        for (size_t j = 0; j < hull_size; j++) {
+            vector_t vertex = hull->vertices[j];
+            min_u = fmin(min_u, vec_dot(vertex, u));
+            max_u = fmax(max_u, vec_dot(vertex, u));
+            min_v = fmin(min_v, vec_dot(vertex, v));
+            max_v = fmax(max_v, vec_dot(vertex, v));
+        }
+        double area = (max_u - min_u) * (max_v - min_v);
+        if (area < min_area) {
+            min_area = area;
+            best_axis = u;
+            best_min_u = min_u;
+            best_max_u = max_u;
+            best_min_v = min_v;
+            best_max_v = max_v;
+        }
+    }
+    polygon_free(hull);
+
+    vector_t u = best_axis;
+    vector_t v = {.x = -u.y, .y = u.x};
+    double corners[4][2] = {{best_min_u, best_min_v},
+                            {best_max_u, best_min_v},
+                            {best_max_u, best_max_v},
+                            {best_min_u, best_max_v}};
+    polygon_t *result = polygon_init(4);
+    for (size_t i = 0; i < 4; i++) {
+        result->vertices[i] = vec_add(vec_multiply(corners[i][0], u),
+                                      vec_multiply(corners[i][1], v));
+    }
+    return result;
+}
+
+polygon_t *initialize_star(vector_t center, size_t num_arms,
+                           double circumradius, double inradius) {
     assert(circumradius >= inradius);
     size_t num_verts = num_arms * 2;
-    list_t *star = list_init(num_verts, free);
+    polygon_t *star = polygon_init(num_verts);
     for (size_t i = 0; i < num_verts; i++) {
         double theta = (2 * PI / num_verts) * i;
         double radius = (i % 2 == 0) ? circumradius : inradius;
-        vector_t *vertex = vec_init(radius * cos(theta), radius * sin(theta));
-        list_add(star, vertex);
+        star->vertices[i] =
+            (vector_t){radius * cos(theta), radius * sin(theta)};
     }
     polygon_translate(star, center);
     return star;
 }
 
-list_t *initialize_star_anchored(anchor_option_t anchor, vector_t pos,
-                                 size_t num_arms, double circumradius,
-                                 double inradius) {
-    list_t *result = initialize_star(pos, num_arms, circumradius, inradius);
+polygon_t *initialize_star_anchored(anchor_option_t anchor, vector_t pos,
+                                    size_t num_arms, double circumradius,
+                                    double inradius) {
+    polygon_t *result = initialize_star(pos, num_arms, circumradius, inradius);
     move_anchor_to_current_center(result, anchor);
     return result;
 }
 
-list_t *initialize_regular_polygon(vector_t center, double circumradius,
-                                   size_t num_verts) {
+polygon_t *initialize_regular_polygon(vector_t center, double circumradius,
+                                      size_t num_verts) {
     assert(circumradius > 0);
-    list_t *shape = list_init(num_verts, free);
+    polygon_t *shape = polygon_init(num_verts);
     for (size_t i = 0; i < num_verts; i++) {
         double theta = (2 * PI / num_verts) * i;
-        vector_t *vertex =
-            vec_init(circumradius * cos(theta), circumradius * sin(theta));
-        list_add(shape, vertex);
+        shape->vertices[i] =
+            (vector_t){circumradius * cos(theta), circumradius * sin(theta)};
     }
     polygon_translate(shape, center);
     return shape;
 }
 
-list_t *initialize_regular_polygon_anchored(anchor_option_t anchor,
-                                            vector_t pos, double circumradius,
-                                            size_t num_verts) {
-    list_t *result = initialize_regular_polygon(pos, num_verts, circumradius);
+polygon_t *initialize_regular_polygon_anchored(anchor_option_t anchor,
+                                               vector_t pos,
+                                               double circumradius,
+                                               size_t num_verts) {
+    polygon_t *result =
+        initialize_regular_polygon(pos, num_verts, circumradius);
     move_anchor_to_current_center(result, anchor);
     return result;
 }
 
-list_t *initialize_pacman(vector_t center, double mouth_angle,
-                          double face_radius, size_t num_segments_pacman_back) {
+polygon_t *initialize_pacman(vector_t center, double mouth_angle,
+                             double face_radius,
+                             size_t num_segments_pacman_back) {
     assert(face_radius > 0);
-    list_t *shape = list_init(num_segments_pacman_back + 2, free);
+    polygon_t *shape = polygon_init(num_segments_pacman_back + 2);
     double initial_angle = mouth_angle / 2;
     // vertex at center of mouth
-    vector_t *mouth_center = malloc(sizeof(vector_t));
-    *(mouth_center) = VEC_ZERO;
-    list_add(shape, mouth_center);
+    shape->vertices[0] = VEC_ZERO;
     for (size_t i = 0; i <= num_segments_pacman_back; i++) {
         double theta = initial_angle +
                        i * ((2 * PI - mouth_angle) / num_segments_pacman_back);
-        vector_t *vertex =
-            vec_init(face_radius * cos(theta), face_radius * sin(theta));
-        list_add(shape, vertex);
+        shape->vertices[i + 1] =
+            (vector_t){face_radius * cos(theta), face_radius * sin(theta)};
     }
     /**
      * we want the centroid of the pacman (not the center of the circle used to
@@ -171,19 +390,19 @@ list_t *initialize_pacman(vector_t center, double mouth_angle,
     return shape;
 }
 
-list_t *initialize_rectangle(double min_x, double min_y, double max_x,
-                             double max_y) {
+polygon_t *initialize_rectangle(double min_x, double min_y, double max_x,
+                                double max_y) {
     assert(min_x <= max_x && min_y <= max_y);
-    list_t *shape = list_init(4, free);
-    list_add(shape, vec_init(min_x, min_y));
-    list_add(shape, vec_init(max_x, min_y));
-    list_add(shape, vec_init(max_x, max_y));
-    list_add(shape, vec_init(min_x, max_y));
+    polygon_t *shape = polygon_init(4);
+    shape->vertices[0] = (vector_t){min_x, min_y};
+    shape->vertices[1] = (vector_t){max_x, min_y};
+    shape->vertices[2] = (vector_t){max_x, max_y};
+    shape->vertices[3] = (vector_t){min_x, max_y};
     return shape;
 }
 
-list_t *initialize_rectangle_centered(vector_t center, double width,
-                                      double height) {
+polygon_t *initialize_rectangle_centered(vector_t center, double width,
+                                         double height) {
     assert(width >= 0 && height >= 0);
     double min_x = center.x - width / 2;
     double max_x = center.x + width / 2;
@@ -192,19 +411,19 @@ list_t *initialize_rectangle_centered(vector_t center, double width,
     return initialize_rectangle(min_x, min_y, max_x, max_y);
 }
 
-list_t *initialize_rectangle_anchored(anchor_option_t anchor, vector_t pos,
-                                      double width, double height) {
-    list_t *result = initialize_rectangle_centered(pos, width, height);
+polygon_t *initialize_rectangle_anchored(anchor_option_t anchor, vector_t pos,
+                                         double width, double height) {
+    polygon_t *result = initialize_rectangle_centered(pos, width, height);
     move_anchor_to_current_center(result, anchor);
     return result;
 }
 
-list_t *initialize_rectangle_rotated(vector_t pos1, vector_t pos2,
-                                     double width) {
+polygon_t *initialize_rectangle_rotated(vector_t pos1, vector_t pos2,
+                                        double width) {
     vector_t res = vec_subtract(pos2, pos1);
     double res_magnitude = vec_magnitude(res);
     // create rectangle that lies along x-axis and has left endpoint at origin
-    list_t *shape =
+    polygon_t *shape =
         initialize_rectangle(0, -width / 2, res_magnitude, width / 2);
 
     // rotate that rectangle along the x-axis
@@ -216,24 +435,24 @@ list_t *initialize_rectangle_rotated(vector_t pos1, vector_t pos2,
     return shape;
 }
 
-list_t *initialize_ellipse(vector_t center, double width, double height,
-                           size_t num_verts) {
+polygon_t *initialize_ellipse(vector_t center, double width, double height,
+                              size_t num_verts) {
     assert(width > 0 && height > 0);
-    list_t *shape = list_init(num_verts, free);
+    polygon_t *shape = polygon_init(num_verts);
     for (size_t i = 0; i < num_verts; i++) {
         double theta = (2 * PI / num_verts) * i;
         double x = (width / 2) * cos(theta);
         double y = (height / 2) * sin(theta);
-        list_add(shape, vec_init(x, y));
+        shape->vertices[i] = (vector_t){x, y};
     }
     polygon_translate(shape, center);
     return shape;
 }
 
-list_t *initialize_ellipse_anchored(anchor_option_t anchor, vector_t pos,
-                                    double width, double height,
-                                    size_t num_verts) {
-    list_t *result = initialize_rectangle_centered(pos, width, height);
+polygon_t *initialize_ellipse_anchored(anchor_option_t anchor, vector_t pos,
+                                       double width, double height,
+                                       size_t num_verts) {
+    polygon_t *result = initialize_ellipse(pos, width, height, num_verts);
     move_anchor_to_current_center(result, anchor);
     return result;
 }
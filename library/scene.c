@@ -1,10 +1,16 @@
 #include "scene.h"
+#include "aabb_tree.h"
+#include "arena.h"
+#include "array.h"
+#include "broadphase.h"
 #include "polygon.h"
+#include "thread_pool.h"
 #include "utils.h"
 #include <assert.h>
 #include <float.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 // The initial capacity of the list that stores the bodies in the scene
 const size_t DEFAULT_BODY_CAPACITY = 10;
@@ -14,69 +20,297 @@ const size_t DEFAULT_FORCE_CAPACITY = 15;
 // that it is impossible for the body to go anywhere
 const size_t DETECT_COLLISION_NUM_TRIES = 4;
 
-const double BODY_SEGMENT_WIDTH = 0.01;
+// The number of bits in a body's collision layers
+#define NUM_COLLISION_LAYERS 32
 
+// The side length of a broadphase grid cell. A bit larger than the player.
+const double BROADPHASE_CELL_SIZE = 64;
+
+// How far a body can move before it has to be moved in the spatial index
+const double SPATIAL_INDEX_MARGIN = 8;
+
+// How far past the time of impact a continuous body is moved, so that it
+// overlaps the body it hit and the collision rules see the collision
+const double CONTINUOUS_CONTACT_DEPTH = 0.1;
+
+// The size of the blocks of memory that the scene's arena allocates. A level's
+// force creators, collision rules and proxies fit in a few of them.
+const size_t SCENE_ARENA_CHUNK_SIZE = 16384;
+
+// Phases with fewer candidate pairs than this are checked on one thread, since
+// waking the workers would cost more than it saves
+const size_t PARALLEL_NARROWPHASE_MIN_PAIRS = 256;
+
+/**
+ * bodies - the bodies the force creator depends on, allocated from the
+ *      scene's arena along with the wrapper
+ */
 typedef struct force_creator_wrapper {
     force_creator_t forcer;
     void *aux;
     free_func_t freer;
-    list_t *bodies;
+    body_t **bodies;
+    size_t num_bodies;
     bool is_post_tick;
 } force_creator_wrapper_t;
 
+DEFINE_ARRAY(force_array, force_creator_wrapper_t *)
+
+/**
+ * The entry of a body in the scene's spatial index.
+ * leaf - the id of the body's leaf in the tree
+ * order - increases with every body added, so sorting by it gives the bodies
+ *      in the same order as the scene's list of bodies
+ */
+typedef struct body_proxy {
+    body_t *body;
+    size_t leaf;
+    size_t order;
+} body_proxy_t;
+
+DEFINE_ARRAY(proxy_array, body_proxy_t *)
+
+/**
+ * A change in whether a candidate pair of bodies is touching, found once per
+ * pair in each phase of a tick and then passed to every rule that matches the
+ * pair. Going from not touching to touching begins a contact, touching in
+ * both persists it, and going back to not touching ends it.
+ * axis - the collision axis, or the separating axis if the contact ended,
+ *      pointing from body1 to body2
+ * previous - the status of the pair the last time it was checked
+ * current - the status of the pair now
+ */
+typedef struct contact_event {
+    body_t *body1;
+    body_t *body2;
+    vector_t axis;
+    collision_status_t previous;
+    collision_status_t current;
+} contact_event_t;
+
+/**
+ * The result of checking one candidate pair of a phase for a collision.
+ * is_checked - false if no rule can match the pair, so it wasn't checked
+ * work - the collision work done to check the pair
+ */
+typedef struct narrowphase_result {
+    bool is_checked;
+    collision_info_t info;
+    collision_stats_t work;
+} narrowphase_result_t;
+
+typedef struct collision_rule_wrapper {
+    collision_rule_t rule;
+    void *aux;
+    free_func_t freer;
+} collision_rule_wrapper_t;
+
+DEFINE_ARRAY(rule_array, collision_rule_wrapper_t *)
+
+/**
+ * collision_rules - the rules added with scene_add_collision_rule()
+ * layer_rules - for the pre-tick ([0]) and post-tick ([1]) rules, the bitmask
+ *      of the rules (by index) that mention each layer bit in either of their
+ *      layers. A pair of bodies can only match the rules in both of their
+ *      masks.
+ * pre_tick_broadphase, post_tick_broadphase - find the candidate pairs for the
+ *      pre-tick and post-tick rules. Each phase has its own broadphase so that
+ *      the state of a pair is carried over from the same phase of the last tick.
+ * contact_events - the contact events of the phase being applied, reused by
+ *      every phase
+ * clear_count - the number of times the scene has been cleared, used to notice
+ *      when a collision handler clears the scene
+ * tree - spatial index over the bounding boxes of the bodies, updated when
+ *      bodies are added and at the end of every tick
+ * body_proxies - the entry of each body in the tree, at the same index as the
+ *      body in bodies
+ * free_proxies - the entries of the bodies removed since the scene was last
+ *      cleared, which are reused for the next bodies added
+ * dynamic_proxies - the entries of the bodies that aren't static, in the same
+ *      order. Only these bodies are ticked, moved in the tree, and added to
+ *      the broadphases every tick; static bodies stay in the broadphases.
+ * body_store - the motion state of the bodies that aren't static, so that
+ *      they can all be integrated in one pass every tick
+ * query_results - reused by queries to collect the entries found in the tree
+ * narrowphase_pool - the threads that check the candidate pairs of large
+ *      phases, started the first time a phase is large enough
+ * narrowphase_results - the result for each candidate pair of the phase being
+ *      checked, reused by every phase
+ * stats - the collision work done since the start of the current or last tick
+ * arena - the memory that lives until the scene is cleared: the wrappers of
+ *      the force creators and collision rules, the bodies the force creators
+ *      depend on, the body proxies, and whatever is allocated with
+ *      scene_alloc()
+ */
 typedef struct scene {
-    list_t *bodies;
-    list_t *forces;
+    body_array_t *bodies;
+    force_array_t *forces;
+    rule_array_t *collision_rules;
+    uint32_t layer_rules[2][NUM_COLLISION_LAYERS];
+    broadphase_t *pre_tick_broadphase;
+    broadphase_t *post_tick_broadphase;
+    contact_event_t *contact_events;
+    size_t num_contact_events;
+    size_t contact_events_capacity;
+    size_t clear_count;
+    aabb_tree_t *tree;
+    proxy_array_t *body_proxies;
+    proxy_array_t *free_proxies;
+    proxy_array_t *dynamic_proxies;
+    body_store_t *body_store;
+    size_t next_body_order;
+    body_proxy_t **query_results;
+    size_t num_query_results;
+    size_t query_results_capacity;
+    thread_pool_t *narrowphase_pool;
+    narrowphase_result_t *narrowphase_results;
+    size_t narrowphase_results_capacity;
+    scene_stats_t stats;
+    arena_t *arena;
 } scene_t;
 
 void force_creator_wrapper_free(force_creator_wrapper_t *wrapper) {
     if (wrapper->freer) {
         wrapper->freer(wrapper->aux);
     }
-    list_free(wrapper->bodies);
-    free(wrapper);
+}
+
+void collision_rule_wrapper_free(collision_rule_wrapper_t *wrapper) {
+    if (wrapper->freer) {
+        wrapper->freer(wrapper->aux);
+    }
 }
 
 scene_t *scene_init(void) {
     scene_t *scene = malloc(sizeof(scene_t));
     assert(scene);
-    scene->bodies = list_init(DEFAULT_BODY_CAPACITY, (free_func_t)body_free);
-    scene->forces = list_init(DEFAULT_FORCE_CAPACITY,
-                              (free_func_t)force_creator_wrapper_free);
+    scene->bodies = body_array_init(DEFAULT_BODY_CAPACITY);
+    scene->forces = force_array_init(DEFAULT_FORCE_CAPACITY);
+    scene->collision_rules = rule_array_init(MAX_COLLISION_RULES);
+    memset(scene->layer_rules, 0, sizeof(scene->layer_rules));
+    scene->pre_tick_broadphase = broadphase_init(BROADPHASE_CELL_SIZE);
+    scene->post_tick_broadphase = broadphase_init(BROADPHASE_CELL_SIZE);
+    scene->contact_events = NULL;
+    scene->num_contact_events = 0;
+    scene->contact_events_capacity = 0;
+    scene->clear_count = 0;
+    scene->tree = aabb_tree_init(SPATIAL_INDEX_MARGIN);
+    scene->body_proxies = proxy_array_init(DEFAULT_BODY_CAPACITY);
+    scene->free_proxies = proxy_array_init(DEFAULT_BODY_CAPACITY);
+    scene->dynamic_proxies = proxy_array_init(DEFAULT_BODY_CAPACITY);
+    scene->body_store = body_store_init();
+    scene->next_body_order = 0;
+    scene->query_results = NULL;
+    scene->num_query_results = 0;
+    scene->query_results_capacity = 0;
+    scene->narrowphase_pool = NULL;
+    scene->narrowphase_results = NULL;
+    scene->narrowphase_results_capacity = 0;
+    scene->stats = (scene_stats_t){0};
+    scene->arena = arena_init(SCENE_ARENA_CHUNK_SIZE);
     return scene;
 }
 
+/**
+ * Helper function.
+ * Releases the bodies of a scene (see body_release()) and frees its force
+ * creators and collision rules, leaving their arrays empty.
+ */
+void scene_free_contents(scene_t *scene) {
+    for (size_t i = 0; i < body_array_size(scene->bodies); i++) {
+        body_release(body_array_get(scene->bodies, i));
+    }
+    body_array_clear(scene->bodies);
+    for (size_t i = 0; i < force_array_size(scene->forces); i++) {
+        force_creator_wrapper_free(force_array_get(scene->forces, i));
+    }
+    force_array_clear(scene->forces);
+    for (size_t i = 0; i < rule_array_size(scene->collision_rules); i++) {
+        collision_rule_wrapper_free(rule_array_get(scene->collision_rules, i));
+    }
+    rule_array_clear(scene->collision_rules);
+}
+
 void scene_free(scene_t *scene) {
-    list_free(scene->bodies);
-    list_free(scene->forces);
+    scene_free_contents(scene);
+    body_array_free(scene->bodies);
+    force_array_free(scene->forces);
+    rule_array_free(scene->collision_rules);
+    broadphase_free(scene->pre_tick_broadphase);
+    broadphase_free(scene->post_tick_broadphase);
+    free(scene->contact_events);
+    aabb_tree_free(scene->tree);
+    proxy_array_free(scene->body_proxies);
+    proxy_array_free(scene->free_proxies);
+    proxy_array_free(scene->dynamic_proxies);
+    // after the bodies, which leave the store when they are freed
+    body_store_free(scene->body_store);
+    free(scene->query_results);
+    if (scene->narrowphase_pool) {
+        thread_pool_free(scene->narrowphase_pool);
+    }
+    free(scene->narrowphase_results);
+    // after the force creators and collision rules, which are stored in it
+    arena_free(scene->arena);
     free(scene);
 }
 
 size_t scene_bodies(scene_t *scene) {
-    return list_size(scene->bodies);
+    return body_array_size(scene->bodies);
 }
 
 body_t *scene_get_body(scene_t *scene, size_t index) {
-    return list_get(scene->bodies, index);
+    return body_array_get(scene->bodies, index);
 }
 
 void scene_add_body(scene_t *scene, body_t *body) {
-    list_add(scene->bodies, body);
+    body_array_add(scene->bodies, body);
+    size_t num_free_proxies = proxy_array_size(scene->free_proxies);
+    body_proxy_t *proxy =
+        num_free_proxies > 0
+            ? proxy_array_swap_remove(scene->free_proxies, num_free_proxies - 1)
+            : scene_alloc(scene, sizeof(body_proxy_t));
+    proxy->body = body;
+    proxy->order = scene->next_body_order;
+    scene->next_body_order++;
+    proxy->leaf =
+        aabb_tree_insert(scene->tree, body_get_bounding_box(body), proxy);
+    proxy_array_add(scene->body_proxies, proxy);
+    if (body_is_static(body)) {
+        broadphase_add_static_body(scene->pre_tick_broadphase, body);
+        broadphase_add_static_body(scene->post_tick_broadphase, body);
+    } else {
+        proxy_array_add(scene->dynamic_proxies, proxy);
+        body_store_add(scene->body_store, body);
+    }
 }
 
 void scene_remove_body(scene_t *scene, size_t index) {
-    body_remove(list_get(scene->bodies, index));
+    body_remove(body_array_get(scene->bodies, index));
 }
 
 void scene_clear(scene_t *scene) {
-    list_clear(scene->bodies);
-    list_clear(scene->forces);
+    scene_free_contents(scene);
+    memset(scene->layer_rules, 0, sizeof(scene->layer_rules));
+    broadphase_clear(scene->pre_tick_broadphase);
+    broadphase_clear(scene->post_tick_broadphase);
+    scene->num_contact_events = 0;
+    aabb_tree_clear(scene->tree);
+    proxy_array_clear(scene->body_proxies);
+    proxy_array_clear(scene->free_proxies);
+    proxy_array_clear(scene->dynamic_proxies);
+    arena_reset(scene->arena);
+    scene->clear_count++;
+}
+
+void *scene_alloc(scene_t *scene, size_t size) {
+    return arena_alloc(scene->arena, size);
 }
 
 void scene_add_force_creator(scene_t *scene, force_creator_t forcer, void *aux,
                              free_func_t freer) {
-    list_t *bodies = list_init(0, NULL);
-    scene_add_bodies_force_creator(scene, forcer, aux, bodies, freer);
+    scene_add_body_array_force_creator(scene, forcer, false, aux, NULL, 0,
+                                       freer);
 }
 
 void scene_add_bodies_force_creator(scene_t *scene, force_creator_t forcer,
@@ -90,78 +324,707 @@ void scene_add_bodies_generic_force_creator(scene_t *scene,
                                             force_creator_t forcer,
                                             bool is_post_tick, void *aux,
                                             list_t *bodies, free_func_t freer) {
-    force_creator_wrapper_t *wrapper = malloc(sizeof(force_creator_wrapper_t));
+    size_t num_bodies = list_size(bodies);
+    body_t *body_array[num_bodies > 0 ? num_bodies : 1];
+    for (size_t i = 0; i < num_bodies; i++) {
+        body_array[i] = list_get(bodies, i);
+    }
+    list_free(bodies);
+    scene_add_body_array_force_creator(scene, forcer, is_post_tick, aux,
+                                       body_array, num_bodies, freer);
+}
+
+void scene_add_body_array_force_creator(scene_t *scene, force_creator_t forcer,
+                                        bool is_post_tick, void *aux,
+                                        body_t **bodies, size_t num_bodies,
+                                        free_func_t freer) {
+    force_creator_wrapper_t *wrapper =
+        scene_alloc(scene, sizeof(force_creator_wrapper_t));
     wrapper->forcer = forcer;
     wrapper->aux = aux;
     wrapper->freer = freer;
-    wrapper->bodies = bodies;
+    wrapper->bodies = NULL;
+    if (num_bodies > 0) {
+        wrapper->bodies = scene_alloc(scene, num_bodies * sizeof(body_t *));
+        memcpy(wrapper->bodies, bodies, num_bodies * sizeof(body_t *));
+    }
+    wrapper->num_bodies = num_bodies;
     wrapper->is_post_tick = is_post_tick;
-    list_add(scene->forces, wrapper);
+    force_array_add(scene->forces, wrapper);
+}
+
+void scene_add_collision_rule(scene_t *scene, collision_rule_t rule, void *aux,
+                              free_func_t freer) {
+    // The state of each pair keeps one bit per rule
+    assert(rule_array_size(scene->collision_rules) < MAX_COLLISION_RULES);
+    assert(rule.handler || rule.end_handler);
+    collision_rule_wrapper_t *wrapper =
+        scene_alloc(scene, sizeof(collision_rule_wrapper_t));
+    wrapper->rule = rule;
+    wrapper->aux = aux;
+    wrapper->freer = freer;
+    uint32_t rule_bit = (uint32_t)1 << rule_array_size(scene->collision_rules);
+    uint32_t layers = rule.layer1 | rule.layer2;
+    for (size_t i = 0; i < NUM_COLLISION_LAYERS; i++) {
+        if (layers & ((uint32_t)1 << i)) {
+            scene->layer_rules[rule.is_post_tick][i] |= rule_bit;
+        }
+    }
+    rule_array_add(scene->collision_rules, wrapper);
+}
+
+/**
+ * Helper function.
+ * Returns the bitmask of the rules of one phase that mention any of the given
+ * layers.
+ */
+uint32_t get_layer_rules(scene_t *scene, bool is_post_tick, uint32_t layers) {
+    uint32_t rules = 0;
+    for (size_t i = 0; layers; i++) {
+        if (layers & 1) {
+            rules |= scene->layer_rules[is_post_tick][i];
+        }
+        layers >>= 1;
+    }
+    return rules;
+}
+
+/**
+ * Helper function.
+ * Records a change in whether a candidate pair is touching.
+ */
+void add_contact_event(scene_t *scene, contact_event_t event) {
+    if (scene->num_contact_events == scene->contact_events_capacity) {
+        scene->contact_events_capacity =
+            scene->contact_events_capacity ? scene->contact_events_capacity * 2
+                                           : DEFAULT_BODY_CAPACITY;
+        scene->contact_events =
+            realloc(scene->contact_events,
+                    sizeof(contact_event_t) * scene->contact_events_capacity);
+        assert(scene->contact_events);
+    }
+    scene->contact_events[scene->num_contact_events] = event;
+    scene->num_contact_events++;
+}
+
+/**
+ * The candidate pairs of a phase, split between the threads of the
+ * narrowphase pool.
+ */
+typedef struct narrowphase_query {
+    scene_t *scene;
+    broadphase_t *broadphase;
+    bool is_post_tick;
+} narrowphase_query_t;
+
+/**
+ * Helper function.
+ * Checks a range of the candidate pairs of a phase for collisions, skipping
+ * pairs that no rule of the phase could match. Only writes the results and
+ * separating axes of its own pairs, so ranges can be checked at the same time.
+ */
+void check_candidate_pairs(narrowphase_query_t *query, size_t start,
+                           size_t end) {
+    scene_t *scene = query->scene;
+    for (size_t i = start; i < end; i++) {
+        body_pair_t *pair = broadphase_get_pair(query->broadphase, i);
+        narrowphase_result_t *result = &scene->narrowphase_results[i];
+        uint32_t layers1 = body_get_collision_layers(pair->body1);
+        uint32_t layers2 = body_get_collision_layers(pair->body2);
+        // Only the rules that mention both bodies' layers can match the pair.
+        // Sensors only overlap bodies that move into them.
+        result->is_checked =
+            (get_layer_rules(scene, query->is_post_tick, layers1) &
+             get_layer_rules(scene, query->is_post_tick, layers2)) &&
+            !(body_is_sensor(pair->body1) && body_is_static(pair->body2)) &&
+            !(body_is_sensor(pair->body2) && body_is_static(pair->body1));
+        if (result->is_checked) {
+            collision_stats_t before = *collision_get_stats();
+            result->info = detect_body_collision_readonly(
+                pair->body1, pair->body2, &pair->separating_axis);
+            collision_stats_t *after = collision_get_stats();
+            result->work = (collision_stats_t){
+                .bounding_box_rejects =
+                    after->bounding_box_rejects - before.bounding_box_rejects,
+                .sat_calls = after->sat_calls - before.sat_calls,
+                .gjk_calls = after->gjk_calls - before.gjk_calls,
+                .axes_projected =
+                    after->axes_projected - before.axes_projected};
+        }
+    }
+}
+
+/**
+ * Helper function.
+ * Checks every candidate pair that a rule of the phase could match for a
+ * collision, once, and records an event for each pair that is touching or
+ * stopped touching. Pairs that the broadphase lost were touching at most
+ * until they were lost.
+ * Large phases are checked on the narrowphase pool, but the events are still
+ * recorded in the order of the pairs.
+ */
+void scene_find_contact_events(scene_t *scene, broadphase_t *broadphase,
+                               bool is_post_tick) {
+    scene->num_contact_events = 0;
+    size_t num_pairs = broadphase_find_pairs(broadphase);
+    if (num_pairs > scene->narrowphase_results_capacity) {
+        scene->narrowphase_results_capacity = num_pairs;
+        free(scene->narrowphase_results);
+        scene->narrowphase_results =
+            malloc(sizeof(narrowphase_result_t) * num_pairs);
+        assert(scene->narrowphase_results);
+    }
+    narrowphase_query_t query = {
+        .scene = scene, .broadphase = broadphase, .is_post_tick = is_post_tick};
+    if (num_pairs >= PARALLEL_NARROWPHASE_MIN_PAIRS) {
+        if (!scene->narrowphase_pool) {
+            scene->narrowphase_pool =
+                thread_pool_init(thread_pool_default_workers());
+        }
+        // Bodies place their vertices the first time they are used after
+        // moving, which must not happen on several threads at once
+        for (size_t i = 0; i < num_pairs; i++) {
+            body_pair_t *pair = broadphase_get_pair(broadphase, i);
+            body_update_shape(pair->body1);
+            body_update_shape(pair->body2);
+        }
+        thread_pool_run(scene->narrowphase_pool, num_pairs,
+                        (thread_pool_func_t)check_candidate_pairs, &query);
+    } else {
+        check_candidate_pairs(&query, 0, num_pairs);
+    }
+
+    scene_stats_t *stats = &scene->stats;
+    stats->candidate_pairs += num_pairs;
+    for (size_t i = 0; i < num_pairs; i++) {
+        body_pair_t *pair = broadphase_get_pair(broadphase, i);
+        narrowphase_result_t *result = &scene->narrowphase_results[i];
+        if (!result->is_checked) {
+            pair->status = NO_COLLISION;
+            continue;
+        }
+        stats->pairs_checked++;
+        stats->bounding_box_rejects += result->work.bounding_box_rejects;
+        stats->sat_calls += result->work.sat_calls;
+        stats->gjk_calls += result->work.gjk_calls;
+        stats->axes_projected += result->work.axes_projected;
+        collision_info_t info = result->info;
+        if (info.collided) {
+            stats->contacts++;
+        }
+        body_remember_collision(pair->body1, pair->body2, info);
+        if (info.collided || pair->status) {
+            add_contact_event(scene, (contact_event_t){.body1 = pair->body1,
+                                                       .body2 = pair->body2,
+                                                       .axis = info.axis,
+                                                       .previous = pair->status,
+                                                       .current = info.collided});
+        }
+        pair->status = info.collided;
+    }
+    for (size_t i = 0; i < broadphase_lost_pairs(broadphase); i++) {
+        body_pair_t *pair = broadphase_get_lost_pair(broadphase, i);
+        if (pair->status) {
+            add_contact_event(scene,
+                              (contact_event_t){.body1 = pair->body1,
+                                                .body2 = pair->body2,
+                                                .axis = pair->separating_axis,
+                                                .previous = pair->status,
+                                                .current = NO_COLLISION});
+        }
+    }
+}
+
+/**
+ * Helper function.
+ * Calls the handlers of a rule that matches a contact event.
+ * body1 is the body matching the rule's layer1.
+ *
+ * @return whether a handler was called
+ */
+bool apply_collision_rule(collision_rule_wrapper_t *wrapper, body_t *body1,
+                          body_t *body2, vector_t axis,
+                          collision_status_t previous,
+                          collision_status_t current) {
+    collision_rule_t *rule = &wrapper->rule;
+    // For full collision rules, only full collisions count as touching
+    collision_status_t touching =
+        rule->is_full_collision ? FULL_COLLISION : PARTIAL_COLLISION;
+    bool was_touching = previous >= touching;
+    bool is_touching = current >= touching;
+    if (is_touching && (!was_touching || rule->is_contact_collision)) {
+        if (rule->handler) {
+            rule->handler(body1, body2, axis, wrapper->aux);
+            return true;
+        }
+    } else if (was_touching && !is_touching && rule->end_handler) {
+        rule->end_handler(body1, body2, axis, wrapper->aux);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Helper function.
+ * Applies the collision rules of one phase of the tick to every candidate pair.
+ * Each pair is checked for a collision once, and the resulting contact event
+ * is passed to every rule that matches the pair's layers, pair by pair.
+ * Stops early if a handler clears the scene.
+ */
+void scene_apply_collision_rules(scene_t *scene, bool is_post_tick) {
+    bool has_rules = false;
+    for (size_t i = 0; i < rule_array_size(scene->collision_rules); i++) {
+        collision_rule_wrapper_t *wrapper =
+            rule_array_get(scene->collision_rules, i);
+        has_rules |= wrapper->rule.is_post_tick == is_post_tick;
+    }
+    if (!has_rules) {
+        return;
+    }
+    broadphase_t *broadphase = is_post_tick ? scene->post_tick_broadphase
+                                            : scene->pre_tick_broadphase;
+    // Static bodies are already in the broadphase. Bodies that no rule
+    // mentions can't collide with anything.
+    for (size_t i = 0; i < proxy_array_size(scene->dynamic_proxies); i++) {
+        body_proxy_t *proxy = proxy_array_get(scene->dynamic_proxies, i);
+        uint32_t layers = body_get_collision_layers(proxy->body);
+        if (get_layer_rules(scene, is_post_tick, layers) &&
+            !body_is_removed(proxy->body)) {
+            broadphase_add_body(broadphase, proxy->body);
+        }
+    }
+    scene_find_contact_events(scene, broadphase, is_post_tick);
+
+    size_t clear_count = scene->clear_count;
+    for (size_t i = 0; i < scene->num_contact_events; i++) {
+        contact_event_t *event = &scene->contact_events[i];
+        uint32_t layers1 = body_get_collision_layers(event->body1);
+        uint32_t layers2 = body_get_collision_layers(event->body2);
+        uint32_t pair_rules = get_layer_rules(scene, is_post_tick, layers1) &
+                              get_layer_rules(scene, is_post_tick, layers2);
+        size_t num_rules = rule_array_size(scene->collision_rules);
+        for (size_t j = 0; j < num_rules && (pair_rules >> j); j++) {
+            if (!(pair_rules & ((uint32_t)1 << j))) {
+                continue;
+            }
+            // A handler may have removed one of the bodies
+            if (body_is_removed(event->body1) ||
+                body_is_removed(event->body2)) {
+                break;
+            }
+            collision_rule_wrapper_t *wrapper =
+                rule_array_get(scene->collision_rules, j);
+            collision_rule_t *rule = &wrapper->rule;
+            bool is_called;
+            if ((layers1 & rule->layer1) && (layers2 & rule->layer2)) {
+                is_called = apply_collision_rule(
+                    wrapper, event->body1, event->body2, event->axis,
+                    event->previous, event->current);
+            } else if ((layers2 & rule->layer1) && (layers1 & rule->layer2)) {
+                is_called = apply_collision_rule(
+                    wrapper, event->body2, event->body1,
+                    vec_negate(event->axis), event->previous, event->current);
+            } else {
+                continue;
+            }
+            scene->stats.handler_calls += is_called;
+            if (scene->clear_count != clear_count) {
+                return;
+            }
+        }
+    }
+}
+
+/**
+ * Helper function.
+ * Collects an entry found in the tree, to be filtered and sorted afterwards.
+ */
+bool collect_query_result(body_proxy_t *proxy, scene_t *scene) {
+    if (scene->num_query_results == scene->query_results_capacity) {
+        scene->query_results_capacity = scene->query_results_capacity
+                                            ? scene->query_results_capacity * 2
+                                            : DEFAULT_BODY_CAPACITY;
+        scene->query_results =
+            realloc(scene->query_results,
+                    sizeof(body_proxy_t *) * scene->query_results_capacity);
+        assert(scene->query_results);
+    }
+    scene->query_results[scene->num_query_results] = proxy;
+    scene->num_query_results++;
+    return true;
+}
+
+int compare_body_proxy_order(const void *a, const void *b) {
+    const body_proxy_t *proxy1 = *(body_proxy_t *const *)a;
+    const body_proxy_t *proxy2 = *(body_proxy_t *const *)b;
+    return (proxy1->order > proxy2->order) - (proxy1->order < proxy2->order);
+}
+
+typedef enum { QUERY_REGION, QUERY_POINT, QUERY_SEGMENT } query_kind_t;
+
+/**
+ * Helper function.
+ * The leaves of the tree have fat bounding boxes, so the collected entries are
+ * only candidates. Adds the bodies that really match the query to a list,
+ * in the order they are in the scene.
+ *
+ * @param scene the scene that was queried
+ * @param region, point, start, end the query. Only the fields that match the
+ *      query_kind are used.
+ * @param bodies the list to add the bodies to
+ * @return the number of bodies added
+ */
+size_t add_query_results(scene_t *scene, query_kind_t query_kind,
+                         bounding_box_t region, vector_t start, vector_t end,
+                         list_t *bodies) {
+    qsort(scene->query_results, scene->num_query_results,
+          sizeof(body_proxy_t *), compare_body_proxy_order);
+    size_t num_added = 0;
+    for (size_t i = 0; i < scene->num_query_results; i++) {
+        body_t *body = scene->query_results[i]->body;
+        if (body_is_removed(body)) {
+            continue;
+        }
+        bounding_box_t bbox = body_get_bounding_box(body);
+        bool matches = false;
+        switch (query_kind) {
+            case QUERY_REGION:
+                matches = bounding_box_overlaps(bbox, region);
+                break;
+            case QUERY_POINT:
+                matches = bounding_box_contains_point(bbox, start);
+                break;
+            case QUERY_SEGMENT:
+                matches = bounding_box_intersects_segment(bbox, start, end);
+                break;
+        }
+        if (matches) {
+            list_add(bodies, body);
+            num_added++;
+        }
+    }
+    scene->num_query_results = 0;
+    return num_added;
+}
+
+size_t scene_query_region(scene_t *scene, bounding_box_t region,
+                          list_t *bodies) {
+    aabb_tree_query_region(scene->tree, region,
+                           (aabb_tree_query_callback_t)collect_query_result,
+                           scene);
+    return add_query_results(scene, QUERY_REGION, region, VEC_ZERO, VEC_ZERO,
+                             bodies);
+}
+
+size_t scene_query_point(scene_t *scene, vector_t point, list_t *bodies) {
+    aabb_tree_query_point(scene->tree, point,
+                          (aabb_tree_query_callback_t)collect_query_result,
+                          scene);
+    return add_query_results(scene, QUERY_POINT, INFINITE_BBOX, point,
+                             VEC_ZERO, bodies);
+}
+
+size_t scene_query_segment(scene_t *scene, vector_t start, vector_t end,
+                           list_t *bodies) {
+    aabb_tree_query_segment(scene->tree, start, end,
+                            (aabb_tree_query_callback_t)collect_query_result,
+                            scene);
+    return add_query_results(scene, QUERY_SEGMENT, INFINITE_BBOX, start, end,
+                             bodies);
+}
+
+/**
+ * Helper function.
+ * Moves the bodies that left their fat bounding boxes in the tree.
+ * Static bodies never move, so they are skipped.
+ */
+void scene_update_tree(scene_t *scene) {
+    for (size_t i = 0; i < proxy_array_size(scene->dynamic_proxies); i++) {
+        body_proxy_t *proxy = proxy_array_get(scene->dynamic_proxies, i);
+        aabb_tree_move(scene->tree, proxy->leaf,
+                       body_get_bounding_box(proxy->body));
+    }
+}
+
+/**
+ * The state of a raycast while the tree is being searched.
+ * closest - the closest hit so far, or NULL
+ * closest_t - where along the ray the closest hit is, from 0 to 1
+ * stop_at_first_hit - whether to stop searching once anything is hit
+ */
+typedef struct raycast_query {
+    vector_t start;
+    vector_t end;
+    raycast_filter_t filter;
+    void *aux;
+    body_proxy_t *closest;
+    double closest_t;
+    bool stop_at_first_hit;
+} raycast_query_t;
+
+/**
+ * Helper function.
+ * Clips the ray against a body found in the tree.
+ */
+bool raycast_body(body_proxy_t *proxy, raycast_query_t *query) {
+    body_t *body = proxy->body;
+    if (body_is_removed(body) ||
+        !bounding_box_intersects_segment(body_get_bounding_box(body),
+                                         query->start, query->end) ||
+        (query->filter && !query->filter(body, query->aux))) {
+        return true;
+    }
+    double t;
+    const polygon_t *shape = body_borrow_collision_shape(body);
+    bool is_hit =
+        polygon_segment_intersect(shape, query->start, query->end, &t, NULL);
+    if (!is_hit) {
+        return true;
+    }
+    if (!query->closest || t < query->closest_t ||
+        (t == query->closest_t && proxy->order < query->closest->order)) {
+        query->closest = proxy;
+        query->closest_t = t;
+    }
+    return !query->stop_at_first_hit;
+}
+
+bool scene_raycast(scene_t *scene, vector_t start, vector_t end,
+                   raycast_filter_t filter, void *aux, raycast_hit_t *hit) {
+    raycast_query_t query = {.start = start,
+                             .end = end,
+                             .filter = filter,
+                             .aux = aux,
+                             .closest = NULL,
+                             .closest_t = INFINITY,
+                             .stop_at_first_hit = !hit};
+    aabb_tree_query_segment(scene->tree, start, end,
+                            (aabb_tree_query_callback_t)raycast_body, &query);
+    if (!query.closest) {
+        return false;
+    }
+    if (hit) {
+        vector_t direction = vec_subtract(end, start);
+        hit->body = query.closest->body;
+        hit->distance = query.closest_t * vec_magnitude(direction);
+        hit->point = vec_add(start, vec_multiply(query.closest_t, direction));
+    }
+    return true;
+}
+
+/**
+ * The bodies that a line of sight runs between, which can't block it.
+ */
+typedef struct line_of_sight_aux {
+    body_t *body1;
+    body_t *body2;
+    body_predicate_t opaqueness_predicate;
+} line_of_sight_aux_t;
+
+/**
+ * Helper function.
+ * Returns whether a body can block a line of sight.
+ */
+bool is_line_of_sight_blocker(body_t *body, line_of_sight_aux_t *aux) {
+    return body != aux->body1 && body != aux->body2 &&
+           (!aux->opaqueness_predicate || aux->opaqueness_predicate(body));
 }
 
 bool scene_detect_line_of_sight(scene_t *scene, body_t *body1, body_t *body2, body_predicate_t opaqueness_predicate) {
-    /**
-     * Initializes a line segment body that extends from `body2` to `body1`.
-     * The line segment has an infinitesimal width to ensure that the collision
-     * axis is detected as parallel to the segment instead of perpendicular.
-     */
-    vector_t c1 = body_get_centroid(body1);
-    vector_t c2 = body_get_centroid(body2);
-    list_t *shape = initialize_rectangle_rotated(c1, c2, BODY_SEGMENT_WIDTH);
-    body_t *body_segment = body_init(shape, 0, COLOR_WHITE);
-
-    for (size_t i = 0; i < scene_bodies(scene); i++) {
-        body_t *middle_body = scene_get_body(scene, i);
-        if ((middle_body == body1) || (middle_body == body2)) {
+    line_of_sight_aux_t aux = {.body1 = body1,
+                               .body2 = body2,
+                               .opaqueness_predicate = opaqueness_predicate};
+    return !scene_raycast(scene, body_get_centroid(body1),
+                          body_get_centroid(body2),
+                          (raycast_filter_t)is_line_of_sight_blocker, &aux,
+                          NULL);
+}
+
+/**
+ * The state of the sweep of a continuous body while the tree is searched.
+ * obstacle_layers - the layers of the bodies it has a continuous collision
+ *      rule with
+ * closest - the first body it hits so far, or NULL
+ * closest_t - when it hits closest, as a fraction of displacement
+ */
+typedef struct sweep_query {
+    body_proxy_t *proxy;
+    vector_t displacement;
+    uint32_t obstacle_layers;
+    body_proxy_t *closest;
+    double closest_t;
+} sweep_query_t;
+
+/**
+ * Helper function.
+ * Returns the layers that the continuous collision rules pair with any of the
+ * given layers.
+ */
+uint32_t get_obstacle_layers(scene_t *scene, uint32_t layers) {
+    uint32_t obstacle_layers = 0;
+    for (size_t i = 0; i < rule_array_size(scene->collision_rules); i++) {
+        collision_rule_wrapper_t *wrapper =
+            rule_array_get(scene->collision_rules, i);
+        if (!wrapper->rule.is_continuous) {
             continue;
         }
-        if ((!opaqueness_predicate || opaqueness_predicate(middle_body)) && detect_body_collision(body_segment, middle_body).collided) {
-            body_free(body_segment);
-            return false;
+        if (layers & wrapper->rule.layer1) {
+            obstacle_layers |= wrapper->rule.layer2;
         }
+        if (layers & wrapper->rule.layer2) {
+            obstacle_layers |= wrapper->rule.layer1;
+        }
+    }
+    return obstacle_layers;
+}
+
+/**
+ * Helper function.
+ * Finds when the swept body hits a body found in the tree.
+ */
+bool sweep_body(body_proxy_t *proxy, sweep_query_t *query) {
+    body_t *body = proxy->body;
+    if (proxy == query->proxy || body_is_removed(body) ||
+        body_is_sensor(body) ||
+        !(body_get_collision_layers(body) & query->obstacle_layers)) {
+        return true;
+    }
+    double t = body_time_of_impact(query->proxy->body, body,
+                                   query->displacement);
+    // Bodies that already overlap are left to the collision rules
+    if (t == 0 || t == INFINITY) {
+        return true;
+    }
+    if (!query->closest || t < query->closest_t ||
+        (t == query->closest_t && proxy->order < query->closest->order)) {
+        query->closest = proxy;
+        query->closest_t = t;
     }
-    body_free(body_segment);
     return true;
 }
 
+/**
+ * Helper function.
+ * Moves a continuous body back along the straight line it moved this tick,
+ * to just inside the first body it would have hit on the way.
+ * The other bodies are tested where they are now.
+ *
+ * @param scene the scene the body is in
+ * @param proxy the body's entry in the tree
+ * @param start the body's centroid before it was ticked
+ */
+void scene_sweep_continuous_body(scene_t *scene, body_proxy_t *proxy,
+                                 vector_t start) {
+    body_t *body = proxy->body;
+    vector_t displacement = vec_subtract(body_get_centroid(body), start);
+    double distance = vec_magnitude(displacement);
+    uint32_t obstacle_layers =
+        get_obstacle_layers(scene, body_get_collision_layers(body));
+    if (distance == 0 || !obstacle_layers) {
+        return;
+    }
+    bounding_box_t end_bbox = body_get_bounding_box(body);
+    body_translate(body, vec_negate(displacement));
+    bounding_box_t swept_bbox =
+        bounding_box_union(body_get_bounding_box(body), end_bbox);
+    sweep_query_t query = {.proxy = proxy,
+                           .displacement = displacement,
+                           .obstacle_layers = obstacle_layers,
+                           .closest = NULL,
+                           .closest_t = INFINITY};
+    aabb_tree_query_region(scene->tree, swept_bbox,
+                           (aabb_tree_query_callback_t)sweep_body, &query);
+    double t = 1;
+    if (query.closest) {
+        t = fmin(1, query.closest_t + CONTINUOUS_CONTACT_DEPTH / distance);
+    }
+    body_translate(body, vec_multiply(t, displacement));
+}
+
+scene_stats_t scene_get_stats(scene_t *scene) {
+    return scene->stats;
+}
+
 void scene_tick(scene_t *scene, double dt) {
+    scene->stats = (scene_stats_t){0};
     // force application (pre-tick)
-    for (size_t i = 0; i < list_size(scene->forces); i++) {
-        force_creator_wrapper_t *wrapper = list_get(scene->forces, i);
+    for (size_t i = 0; i < force_array_size(scene->forces); i++) {
+        force_creator_wrapper_t *wrapper = force_array_get(scene->forces, i);
         if (!wrapper->is_post_tick) {
             wrapper->forcer(wrapper->aux);
         }
     }
+    scene_apply_collision_rules(scene, false);
     // force removal. Note that this has to be in a separate loop since
-    // force application could mark some bodies for removal.
-    for (size_t i = 0; i < list_size(scene->forces); i++) {
-        force_creator_wrapper_t *wrapper = list_get(scene->forces, i);
-        for (size_t j = 0; j < list_size(wrapper->bodies); j++) {
-            body_t *body = list_get(wrapper->bodies, j);
-            if (body_is_removed(body)) {
-                list_remove(scene->forces, i);
-                force_creator_wrapper_free(wrapper);
-                i--;
+    // force application could mark some bodies for removal. The force
+    // creators and bodies that are kept are moved forward in one pass, so
+    // that they keep their order.
+    size_t num_kept = 0;
+    for (size_t i = 0; i < force_array_size(scene->forces); i++) {
+        force_creator_wrapper_t *wrapper = force_array_get(scene->forces, i);
+        bool is_removed = false;
+        for (size_t j = 0; j < wrapper->num_bodies; j++) {
+            if (body_is_removed(wrapper->bodies[j])) {
+                is_removed = true;
                 break;
             }
         }
+        if (is_removed) {
+            force_creator_wrapper_free(wrapper);
+        } else {
+            force_array_set(scene->forces, num_kept, wrapper);
+            num_kept++;
+        }
     }
-    // body tick and body removal
-    for (size_t i = 0; i < list_size(scene->bodies); i++) {
-        body_t *body = list_get(scene->bodies, i);
+    force_array_truncate(scene->forces, num_kept);
+    // pairs remember their bodies, which are about to be freed
+    broadphase_forget_removed_bodies(scene->pre_tick_broadphase);
+    broadphase_forget_removed_bodies(scene->post_tick_broadphase);
+    // body removal. The entries in dynamic_proxies are owned by
+    // body_proxies, so they are dropped before being freed.
+    num_kept = 0;
+    for (size_t i = 0; i < proxy_array_size(scene->dynamic_proxies); i++) {
+        body_proxy_t *proxy = proxy_array_get(scene->dynamic_proxies, i);
+        if (!body_is_removed(proxy->body)) {
+            proxy_array_set(scene->dynamic_proxies, num_kept, proxy);
+            num_kept++;
+        }
+    }
+    proxy_array_truncate(scene->dynamic_proxies, num_kept);
+    num_kept = 0;
+    for (size_t i = 0; i < body_array_size(scene->bodies); i++) {
+        body_t *body = body_array_get(scene->bodies, i);
+        body_proxy_t *proxy = proxy_array_get(scene->body_proxies, i);
         if (body_is_removed(body)) {
-            body_t *removed = list_remove(scene->bodies, i);
-            body_free(removed);
-            i--;
+            aabb_tree_remove(scene->tree, proxy->leaf);
+            proxy_array_add(scene->free_proxies, proxy);
+            body_release(body);
         } else {
-            body_tick(body, dt);
+            body_array_set(scene->bodies, num_kept, body);
+            proxy_array_set(scene->body_proxies, num_kept, proxy);
+            num_kept++;
+        }
+    }
+    body_array_truncate(scene->bodies, num_kept);
+    proxy_array_truncate(scene->body_proxies, num_kept);
+    // body tick, which static bodies skip. Every body in the store is
+    // integrated at once, then moved.
+    body_store_integrate(scene->body_store, dt);
+    for (size_t i = 0; i < proxy_array_size(scene->dynamic_proxies); i++) {
+        body_proxy_t *proxy = proxy_array_get(scene->dynamic_proxies, i);
+        vector_t start = body_get_centroid(proxy->body);
+        body_apply_integration(proxy->body);
+        if (body_is_continuous(proxy->body)) {
+            scene_sweep_continuous_body(scene, proxy, start);
         }
     }
     // force application (post-tick)
-    for (size_t i = 0; i < list_size(scene->forces); i++) {
-        force_creator_wrapper_t *wrapper = list_get(scene->forces, i);
+    for (size_t i = 0; i < force_array_size(scene->forces); i++) {
+        force_creator_wrapper_t *wrapper = force_array_get(scene->forces, i);
         if (wrapper->is_post_tick) {
             wrapper->forcer(wrapper->aux);
         }
     }
+    scene_apply_collision_rules(scene, true);
+    scene_update_tree(scene);
 }
@@ -51,6 +51,18 @@ uint32_t key_start_timestamp;
  * Initially 0.
  */
 clock_t last_clock = 0;
+/**
+ * The bodies found on screen by sdl_render_scene().
+ * Kept between frames so it doesn't need to be reallocated.
+ */
+list_t *visible_bodies = NULL;
+/**
+ * The window coordinates of the polygon being drawn by sdl_draw_polygon(),
+ * and how many vertices they have room for.
+ * Kept between calls and only grown, so drawing doesn't allocate memory.
+ */
+int16_t *x_points = NULL, *y_points = NULL;
+size_t points_capacity = 0;
 
 // used to initialize SDL_mixer
 int mixer_frequency = 22050;
@@ -180,13 +192,9 @@ void sdl_set_zoom(double new_zoom) {
 
 /** Computes the center of the window in pixel coordinates */
 vector_t get_window_center(void) {
-    int *width = malloc(sizeof(*width)), *height = malloc(sizeof(*height));
-    assert(width != NULL);
-    assert(height != NULL);
-    SDL_GetWindowSize(window, width, height);
-    vector_t dimensions = {.x = *width, .y = *height};
-    free(width);
-    free(height);
+    int width, height;
+    SDL_GetWindowSize(window, &width, &height);
+    vector_t dimensions = {.x = width, .y = height};
     return vec_multiply(0.5, dimensions);
 }
 
@@ -419,10 +427,10 @@ void sdl_draw_text_texture(texture_wrapper_t *texture_wrapper,
                      texture_wrapper->text_texture);
 }
 
-void sdl_draw_polygon(list_t *points, rgba_color_t color,
+void sdl_draw_polygon(const polygon_t *points, rgba_color_t color,
                       texture_wrapper_t *texture_wrapper) {
     // Check parameters
-    size_t n = list_size(points);
+    size_t n = points->num_vertices;
     assert(n >= 3);
     assert(0 <= color.r && color.r <= 1);
     assert(0 <= color.g && color.g <= 1);
@@ -430,13 +438,15 @@ void sdl_draw_polygon(list_t *points, rgba_color_t color,
     assert(0 <= color.a && color.a <= 1);
 
     // Convert each vertex to a point on screen
-    int16_t *x_points = malloc(sizeof(*x_points) * n),
-            *y_points = malloc(sizeof(*y_points) * n);
-    assert(x_points != NULL);
-    assert(y_points != NULL);
+    if (n > points_capacity) {
+        points_capacity = n;
+        x_points = realloc(x_points, sizeof(*x_points) * points_capacity);
+        y_points = realloc(y_points, sizeof(*y_points) * points_capacity);
+        assert(x_points != NULL);
+        assert(y_points != NULL);
+    }
     for (size_t i = 0; i < n; i++) {
-        vector_t *vertex = list_get(points, i);
-        vector_t pixel = get_window_position(*vertex);
+        vector_t pixel = get_window_position(points->vertices[i]);
         x_points[i] = pixel.x;
         y_points[i] = pixel.y;
     }
@@ -471,8 +481,6 @@ void sdl_draw_polygon(list_t *points, rgba_color_t color,
                                  color.g * 255, color.b * 255,
                                  color.a * 255) == 0);
     }
-    free(x_points);
-    free(y_points);
 }
 
 void sdl_play_sound_effect(const char *filepath, bool halt_music) {
@@ -526,14 +534,27 @@ void sdl_show(void) {
     SDL_RenderPresent(renderer);
 }
 
+/** Computes the region of the scene that is visible in the window */
+bounding_box_t get_visible_region(void) {
+    vector_t half_size = vec_multiply(1 / zoom, get_window_center());
+    return (bounding_box_t){.min_x = camera_pos.x - half_size.x,
+                            .min_y = camera_pos.y - half_size.y,
+                            .max_x = camera_pos.x + half_size.x,
+                            .max_y = camera_pos.y + half_size.y};
+}
+
 void sdl_render_scene(scene_t *scene) {
-    size_t body_count = scene_bodies(scene);
+    if (!visible_bodies) {
+        visible_bodies = list_init(1, NULL);
+    }
+    // Only draw the bodies that are on screen
+    list_clear(visible_bodies);
+    size_t body_count =
+        scene_query_region(scene, get_visible_region(), visible_bodies);
     for (size_t i = 0; i < body_count; i++) {
-        body_t *body = scene_get_body(scene, i);
-        list_t *shape = body_get_shape(body);
-        sdl_draw_polygon(shape, body_get_color(body), body_get_texture(body));
-        sdl_draw_polygon(shape, body_get_color(body), body_get_texture(body));
-        list_free(shape);
+        body_t *body = list_get(visible_bodies, i);
+        sdl_draw_polygon(body_borrow_shape(body), body_get_color(body),
+                         body_get_texture(body));
     }
     sdl_show();
 }
@@ -0,0 +1,207 @@
+#include "thread_pool.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+// Emscripten only has threads when the game is built with -pthread
+#if defined __EMSCRIPTEN__ && !defined __EMSCRIPTEN_PTHREADS__
+#define THREAD_POOL_SERIAL
+#endif
+
+#ifndef THREAD_POOL_SERIAL
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+// Extra threads stop paying off long before this for the loops in a scene
+const size_t THREAD_POOL_MAX_DEFAULT_WORKERS = 7;
+
+#ifdef THREAD_POOL_SERIAL
+
+struct thread_pool {
+    size_t num_workers;
+};
+
+thread_pool_t *thread_pool_init(size_t num_workers) {
+    thread_pool_t *pool = malloc(sizeof(thread_pool_t));
+    assert(pool);
+    pool->num_workers = 0;
+    return pool;
+}
+
+void thread_pool_free(thread_pool_t *pool) {
+    free(pool);
+}
+
+size_t thread_pool_default_workers(void) {
+    return 0;
+}
+
+void thread_pool_run(thread_pool_t *pool, size_t count,
+                     thread_pool_func_t func, void *aux) {
+    if (count > 0) {
+        func(aux, 0, count);
+    }
+}
+
+#else
+
+/**
+ * A worker thread.
+ * index - which range of each loop the worker processes, starting at 1
+ */
+typedef struct worker {
+    thread_pool_t *pool;
+    size_t index;
+    pthread_t thread;
+} worker_t;
+
+/**
+ * The workers wait on work_ready until the generation changes, which means
+ * that there is a new loop to process, or until is_stopping is set.
+ * num_busy counts the workers still processing the current loop.
+ */
+struct thread_pool {
+    size_t num_workers;
+    worker_t *workers;
+    pthread_mutex_t lock;
+    pthread_cond_t work_ready;
+    pthread_cond_t work_done;
+    size_t generation;
+    size_t num_busy;
+    bool is_stopping;
+    thread_pool_func_t func;
+    void *aux;
+    size_t count;
+};
+
+/**
+ * Helper function.
+ * Processes one of the ranges that the current loop is split into.
+ */
+void run_range(thread_pool_t *pool, size_t index) {
+    size_t num_ranges = pool->num_workers + 1;
+    size_t start = pool->count * index / num_ranges;
+    size_t end = pool->count * (index + 1) / num_ranges;
+    if (start < end) {
+        pool->func(pool->aux, start, end);
+    }
+}
+
+/**
+ * Helper function.
+ * The main loop of a worker thread.
+ */
+void *worker_main(void *arg) {
+    worker_t *worker = arg;
+    thread_pool_t *pool = worker->pool;
+    // Workers are started before the first loop, which may be handed out
+    // before this thread first takes the lock
+    size_t generation = 0;
+    pthread_mutex_lock(&pool->lock);
+    while (true) {
+        while (pool->generation == generation && !pool->is_stopping) {
+            pthread_cond_wait(&pool->work_ready, &pool->lock);
+        }
+        if (pool->is_stopping) {
+            break;
+        }
+        generation = pool->generation;
+        // The loop doesn't change until every worker is done with it
+        pthread_mutex_unlock(&pool->lock);
+        run_range(pool, worker->index);
+        pthread_mutex_lock(&pool->lock);
+        pool->num_busy--;
+        if (pool->num_busy == 0) {
+            pthread_cond_signal(&pool->work_done);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+thread_pool_t *thread_pool_init(size_t num_workers) {
+    thread_pool_t *pool = malloc(sizeof(thread_pool_t));
+    assert(pool);
+    *pool = (thread_pool_t){.num_workers = 0,
+                            .workers = NULL,
+                            .generation = 0,
+                            .num_busy = 0,
+                            .is_stopping = false};
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work_ready, NULL);
+    pthread_cond_init(&pool->work_done, NULL);
+    if (num_workers == 0) {
+        return pool;
+    }
+    pool->workers = malloc(sizeof(worker_t) * num_workers);
+    assert(pool->workers);
+    for (size_t i = 0; i < num_workers; i++) {
+        worker_t *worker = &pool->workers[i];
+        worker->pool = pool;
+        worker->index = i + 1;
+        if (pthread_create(&worker->thread, NULL, worker_main, worker)) {
+            break;
+        }
+        pool->num_workers++;
+    }
+    return pool;
+}
+
+void thread_pool_free(thread_pool_t *pool) {
+    pthread_mutex_lock(&pool->lock);
+    pool->is_stopping = true;
+    pthread_cond_broadcast(&pool->work_ready);
+    pthread_mutex_unlock(&pool->lock);
+    for (size_t i = 0; i < pool->num_workers; i++) {
+        pthread_join(pool->workers[i].thread, NULL);
+    }
+    pthread_cond_destroy(&pool->work_done);
+    pthread_cond_destroy(&pool->work_ready);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->workers);
+    free(pool);
+}
+
+size_t thread_pool_default_workers(void) {
+    long num_processors = sysconf(_SC_NPROCESSORS_ONLN);
+    if (num_processors <= 1) {
+        return 0;
+    }
+    size_t num_workers = (size_t)num_processors - 1;
+    return num_workers < THREAD_POOL_MAX_DEFAULT_WORKERS
+               ? num_workers
+               : THREAD_POOL_MAX_DEFAULT_WORKERS;
+}
+
+void thread_pool_run(thread_pool_t *pool, size_t count,
+                     thread_pool_func_t func, void *aux) {
+    if (count == 0) {
+        return;
+    } else if (pool->num_workers == 0 || count == 1) {
+        func(aux, 0, count);
+        return;
+    }
+    pthread_mutex_lock(&pool->lock);
+    pool->func = func;
+    pool->aux = aux;
+    pool->count = count;
+    pool->num_busy = pool->num_workers;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->work_ready);
+    pthread_mutex_unlock(&pool->lock);
+
+    run_range(pool, 0);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->num_busy > 0) {
+        pthread_cond_wait(&pool->work_done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+#endif // #ifdef THREAD_POOL_SERIAL
+
+size_t thread_pool_workers(thread_pool_t *pool) {
+    return pool->num_workers;
+}
@@ -0,0 +1,161 @@
+#include "collision.h"
+#include "polygon.h"
+#include "utils.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/*
+    Benchmarks find_collision() against the implementation it replaced,
+    which allocated a list of axes for each shape on every call, and against
+    find_collision_gjk() on the shapes polygon.c can generate.
+    Run with 'make NO_ASAN=true bench' so the numbers aren't dominated by
+    the address sanitizer.
+*/
+
+const size_t BENCH_CALLS = 1000000;
+
+list_t *before_get_perpendicular_axes(polygon_t *shape) {
+    list_t *perpendicular_axes = list_init(shape->num_vertices, free);
+    for (size_t v1 = 0; v1 < shape->num_vertices; v1++) {
+        size_t v2 = (v1 + 1) % shape->num_vertices;
+        vector_t *first_vertex = &shape->vertices[v1];
+        vector_t *second_vertex = &shape->vertices[v2];
+        vector_t edge = vec_subtract(*second_vertex, *first_vertex);
+        vector_t *perpendicular_axis = malloc(sizeof(vector_t));
+        *perpendicular_axis = vec_direction(vec_rotate(edge, PI / 2));
+        list_add(perpendicular_axes, perpendicular_axis);
+    }
+    return perpendicular_axes;
+}
+
+double before_get_projection_min(polygon_t *shape, vector_t axis) {
+    double min = INFINITY;
+    for (size_t i = 0; i < shape->num_vertices; i++) {
+        double projection = vec_dot(shape->vertices[i], axis);
+        if (projection < min) {
+            min = projection;
+        }
+    }
+    return min;
+}
+
+double before_get_projection_max(polygon_t *shape, vector_t axis) {
+    double max = -INFINITY;
+    for (size_t i = 0; i < shape->num_vertices; i++) {
+        double projection = vec_dot(shape->vertices[i], axis);
+        if (projection > max) {
+            max = projection;
+        }
+    }
+    return max;
+}
+
+collision_info_t before_find_collision(polygon_t *shape1,
+                                       polygon_t *shape2) {
+    list_t *perpendicular_axes1 = before_get_perpendicular_axes(shape1);
+    list_t *perpendicular_axes2 = before_get_perpendicular_axes(shape2);
+    list_t *perpendicular_axes =
+        list_append(perpendicular_axes1, perpendicular_axes2);
+    vector_t min_overlap_axis = VEC_ZERO;
+    double min_overlap = INFINITY;
+    collision_status_t min_overlap_collision_status = NO_COLLISION;
+    for (size_t i = 0; i < list_size(perpendicular_axes); i++) {
+        vector_t axis = *(vector_t *)list_get(perpendicular_axes, i);
+        double min_shape1 = before_get_projection_min(shape1, axis);
+        double max_shape1 = before_get_projection_max(shape1, axis);
+        double min_shape2 = before_get_projection_min(shape2, axis);
+        double max_shape2 = before_get_projection_max(shape2, axis);
+        double overlap =
+            segment_overlap(min_shape1, max_shape1, min_shape2, max_shape2);
+        if (overlap < min_overlap) {
+            if ((min_shape2 + max_shape2) < (min_shape1 + max_shape1)) {
+                axis = vec_negate(axis);
+            }
+            min_overlap_axis = axis;
+            min_overlap = overlap;
+            if (min_overlap == 0) {
+                min_overlap_collision_status = NO_COLLISION;
+                break;
+            } else if ((min_shape1 <= min_shape2 && max_shape1 >= max_shape2) ||
+                       (min_shape2 <= min_shape1 && max_shape2 >= max_shape1)) {
+                min_overlap_collision_status = FULL_COLLISION;
+            } else {
+                min_overlap_collision_status = PARTIAL_COLLISION;
+            }
+        }
+    }
+    list_free(perpendicular_axes1);
+    list_free(perpendicular_axes2);
+    list_free(perpendicular_axes);
+    collision_info_t result = {.collided = min_overlap_collision_status,
+                               .axis = min_overlap_axis,
+                               .overlap = min_overlap};
+    return result;
+}
+
+typedef collision_info_t (*collision_finder_t)(polygon_t *shape1,
+                                               polygon_t *shape2);
+
+/**
+ * Calls a collision finder on a pair of shapes many times.
+ *
+ * @return the number of calls per second
+ */
+double bench(collision_finder_t finder, polygon_t *shape1,
+             polygon_t *shape2) {
+    // Keep the compiler from dropping the calls
+    volatile double total_overlap = 0;
+    clock_t start = clock();
+    for (size_t i = 0; i < BENCH_CALLS; i++) {
+        total_overlap += finder(shape1, shape2).overlap;
+    }
+    double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+    return BENCH_CALLS / seconds;
+}
+
+void bench_case(const char *name, polygon_t *shape1, polygon_t *shape2) {
+    double before = bench(before_find_collision, shape1, shape2);
+    double after = bench(find_collision, shape1, shape2);
+    double gjk = bench(find_collision_gjk, shape1, shape2);
+    printf("%-28s before: %10.0f calls/s  after: %10.0f calls/s  (%.2fx)  "
+           "gjk: %10.0f calls/s  (%.2fx)\n",
+           name, before, after, after / before, gjk, gjk / after);
+    polygon_free(shape1);
+    polygon_free(shape2);
+}
+
+int main(int argc, char *argv[]) {
+    // Player (30x30) overlapping a wall
+    bench_case("rectangles, overlapping",
+               initialize_rectangle_centered((vector_t){0, 0}, 30, 30),
+               initialize_rectangle(10, -200, 30, 200));
+    // Player near, but not touching, a wall
+    bench_case("rectangles, separate",
+               initialize_rectangle_centered((vector_t){0, 0}, 30, 30),
+               initialize_rectangle(20, -200, 40, 200));
+    polygon_t *rotated =
+        initialize_rectangle_centered((vector_t){0, 0}, 30, 30);
+    polygon_rotate(rotated, PI / 6, VEC_ZERO);
+    bench_case("rotated rectangles", rotated,
+               initialize_rectangle(10, -200, 30, 200));
+    bench_case("octagons, overlapping",
+               initialize_regular_polygon((vector_t){0, 0}, 20, 8),
+               initialize_regular_polygon((vector_t){15, 5}, 20, 8));
+    bench_case("ellipse, 20 vertices",
+               initialize_ellipse((vector_t){0, 0}, 60, 40, 20),
+               initialize_rectangle(20, -200, 40, 200));
+    bench_case("ellipses, 40 vertices",
+               initialize_ellipse((vector_t){0, 0}, 60, 40, 40),
+               initialize_ellipse((vector_t){45, 10}, 60, 40, 40));
+    bench_case("ellipses, 40 vertices, apart",
+               initialize_ellipse((vector_t){0, 0}, 60, 40, 40),
+               initialize_ellipse((vector_t){70, 10}, 60, 40, 40));
+    bench_case("star against wall",
+               initialize_star((vector_t){0, 0}, 8, 30, 15),
+               initialize_rectangle(20, -200, 40, 200));
+    bench_case("pacman against wall",
+               initialize_pacman((vector_t){0, 0}, PI / 3, 30, 30),
+               initialize_rectangle(20, -200, 40, 200));
+}
@@ -0,0 +1,130 @@
+#include "aabb_tree.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#define NUM_BOXES 300
+
+const double MARGIN = 2;
+
+typedef struct {
+    bool found[NUM_BOXES];
+    size_t num_found;
+    size_t stop_after;
+} found_aux_t;
+
+bool record_found(void *data, void *aux) {
+    found_aux_t *found_aux = aux;
+    size_t index = (size_t)data;
+    // Every leaf is reported at most once
+    assert(!found_aux->found[index]);
+    found_aux->found[index] = true;
+    found_aux->num_found++;
+    return found_aux->num_found != found_aux->stop_after;
+}
+
+bounding_box_t random_box() {
+    double x = rand() % 1000;
+    double y = rand() % 1000;
+    return (bounding_box_t){.min_x = x,
+                            .min_y = y,
+                            .max_x = x + 1 + rand() % 40,
+                            .max_y = y + 1 + rand() % 40};
+}
+
+void test_empty_tree() {
+    aabb_tree_t *tree = aabb_tree_init(MARGIN);
+    found_aux_t aux = {0};
+    aabb_tree_query_region(tree, INFINITE_BBOX, record_found, &aux);
+    assert(aux.num_found == 0);
+    assert(aabb_tree_get_height(tree) == 0);
+    aabb_tree_free(tree);
+}
+
+void test_queries_match_brute_force() {
+    srand(5);
+    aabb_tree_t *tree = aabb_tree_init(MARGIN);
+    size_t leaves[NUM_BOXES];
+    for (size_t i = 0; i < NUM_BOXES; i++) {
+        leaves[i] = aabb_tree_insert(tree, random_box(), (void *)i);
+    }
+    // Move every box, some far enough to be reinserted
+    for (size_t i = 0; i < NUM_BOXES; i++) {
+        bounding_box_t fat = aabb_tree_get_fat_bounding_box(tree, leaves[i]);
+        bounding_box_t bbox = bounding_box_expand(fat, -MARGIN);
+        vector_t translation = {.x = i % 3 == 0 ? 1 : 50, .y = -1};
+        bool reinserted = aabb_tree_move(tree, leaves[i],
+                                         bounding_box_translate(bbox, translation));
+        assert(reinserted == (i % 3 != 0));
+    }
+    // Remove some boxes
+    for (size_t i = 0; i < NUM_BOXES; i += 7) {
+        aabb_tree_remove(tree, leaves[i]);
+    }
+    // Balanced trees are much shorter than the number of leaves
+    assert(aabb_tree_get_height(tree) < 20);
+
+    for (size_t q = 0; q < 20; q++) {
+        bounding_box_t region = random_box();
+        vector_t point = {.x = rand() % 1000, .y = rand() % 1000};
+        vector_t end = {.x = rand() % 1000, .y = rand() % 1000};
+        found_aux_t region_aux = {0}, point_aux = {0}, segment_aux = {0};
+        aabb_tree_query_region(tree, region, record_found, &region_aux);
+        aabb_tree_query_point(tree, point, record_found, &point_aux);
+        aabb_tree_query_segment(tree, point, end, record_found, &segment_aux);
+        for (size_t i = 0; i < NUM_BOXES; i++) {
+            if (i % 7 == 0) {
+                assert(!region_aux.found[i] && !point_aux.found[i] &&
+                       !segment_aux.found[i]);
+                continue;
+            }
+            bounding_box_t fat =
+                aabb_tree_get_fat_bounding_box(tree, leaves[i]);
+            assert(region_aux.found[i] == bounding_box_overlaps(fat, region));
+            assert(point_aux.found[i] ==
+                   (fat.min_x <= point.x && point.x <= fat.max_x &&
+                    fat.min_y <= point.y && point.y <= fat.max_y));
+            assert(segment_aux.found[i] ==
+                   bounding_box_intersects_segment(fat, point, end));
+        }
+    }
+
+    // Queries stop when the callback returns false
+    found_aux_t stop_aux = {.stop_after = 3};
+    aabb_tree_query_region(tree, INFINITE_BBOX, record_found, &stop_aux);
+    assert(stop_aux.num_found == 3);
+
+    aabb_tree_clear(tree);
+    found_aux_t cleared_aux = {0};
+    aabb_tree_query_region(tree, INFINITE_BBOX, record_found, &cleared_aux);
+    assert(cleared_aux.num_found == 0);
+    aabb_tree_free(tree);
+}
+
+void test_sorted_inserts_stay_balanced() {
+    // Inserting boxes in a line is the worst case without rotations
+    aabb_tree_t *tree = aabb_tree_init(0);
+    for (size_t i = 0; i < 1024; i++) {
+        aabb_tree_insert(tree, (bounding_box_t){i, 0, i + 1, 1}, NULL);
+    }
+    assert(aabb_tree_get_height(tree) <= 20);
+    aabb_tree_free(tree);
+}
+
+int main(int argc, char *argv[]) {
+    // Run all tests if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests) {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_empty_tree)
+    DO_TEST(test_queries_match_brute_force)
+    DO_TEST(test_sorted_inserts_stay_balanced)
+
+    puts("aabb_tree_test PASS");
+}
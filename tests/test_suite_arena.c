@@ -0,0 +1,81 @@
+#include "arena.h"
+#include "test_util.h"
+#include <assert.h>
+#include <stdalign.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+const size_t TEST_CHUNK_SIZE = 256;
+
+void test_alloc() {
+    arena_t *arena = arena_init(TEST_CHUNK_SIZE);
+    assert(arena_bytes_used(arena) == 0);
+    assert(arena_bytes_reserved(arena) == 0);
+    // Objects are aligned, don't overlap, and keep their values
+    unsigned char *objects[100];
+    for (size_t i = 0; i < 100; i++) {
+        size_t size = i % 7 + 1;
+        objects[i] = arena_alloc(arena, size);
+        assert((uintptr_t)objects[i] % alignof(max_align_t) == 0);
+        memset(objects[i], (int)i, size);
+    }
+    for (size_t i = 0; i < 100; i++) {
+        for (size_t j = 0; j < i % 7 + 1; j++) {
+            assert(objects[i][j] == i);
+        }
+    }
+    assert(arena_bytes_used(arena) >= 100);
+    assert(arena_bytes_reserved(arena) >= arena_bytes_used(arena));
+
+    // Objects larger than a chunk get one of their own
+    char *large = arena_alloc(arena, 10 * TEST_CHUNK_SIZE);
+    memset(large, 1, 10 * TEST_CHUNK_SIZE);
+    assert(arena_bytes_reserved(arena) >= 11 * TEST_CHUNK_SIZE);
+    assert(objects[0][0] == 0);
+    arena_free(arena);
+}
+
+void test_reset() {
+    arena_t *arena = arena_init(TEST_CHUNK_SIZE);
+    void *first = arena_alloc(arena, 8);
+    for (size_t i = 0; i < 50; i++) {
+        arena_alloc(arena, 40);
+    }
+    arena_alloc(arena, 3 * TEST_CHUNK_SIZE);
+    size_t reserved = arena_bytes_reserved(arena);
+    size_t used = arena_bytes_used(arena);
+
+    // Allocating the same objects again reuses the same memory
+    for (size_t run = 0; run < 5; run++) {
+        arena_reset(arena);
+        assert(arena_bytes_used(arena) == 0);
+        assert(arena_alloc(arena, 8) == first);
+        for (size_t i = 0; i < 50; i++) {
+            arena_alloc(arena, 40);
+        }
+        arena_alloc(arena, 3 * TEST_CHUNK_SIZE);
+        assert(arena_bytes_reserved(arena) == reserved);
+        assert(arena_bytes_used(arena) == used);
+    }
+
+    // The chunk kept for a large object can't hold a larger one
+    arena_reset(arena);
+    char *larger = arena_alloc(arena, 5 * TEST_CHUNK_SIZE);
+    memset(larger, 1, 5 * TEST_CHUNK_SIZE);
+    assert(arena_bytes_reserved(arena) > reserved);
+    arena_free(arena);
+}
+
+int main(int argc, char *argv[]) {
+    // Run all tests if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests) {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_alloc)
+    DO_TEST(test_reset)
+}
@@ -1,4 +1,5 @@
 #include "body.h"
+#include "polygon.h"
 #include "test_util.h"
 #include <assert.h>
 #include <math.h>
@@ -7,20 +8,18 @@
 void test_body_init() {
     vector_t v[] = {{1, 1}, {2, 1}, {2, 2}, {1, 2}};
     const size_t VERTICES = sizeof(v) / sizeof(*v);
-    list_t *shape = list_init(0, free);
+    polygon_t *shape = polygon_init(VERTICES);
     for (size_t i = 0; i < VERTICES; i++) {
-        vector_t *list_v = malloc(sizeof(*list_v));
-        *list_v = v[i];
-        list_add(shape, list_v);
+        shape->vertices[i] = v[i];
     }
     rgba_color_t color = {0, 0.5, 1};
     body_t *body = body_init(shape, 3, color);
-    list_t *shape2 = body_get_shape(body);
-    assert(list_size(shape2) == VERTICES);
+    polygon_t *shape2 = body_get_shape(body);
+    assert(shape2->num_vertices == VERTICES);
     for (size_t i = 0; i < VERTICES; i++) {
-        assert(vec_isclose(*(vector_t *)list_get(shape2, i), v[i]));
+        assert(vec_isclose(shape2->vertices[i], v[i]));
     }
-    list_free(shape2);
+    polygon_free(shape2);
     assert(vec_isclose(body_get_centroid(body), (vector_t){1.5, 1.5}));
     assert(vec_equal(body_get_velocity(body), VEC_ZERO));
     assert(body_get_color(body).r == color.r);
@@ -31,16 +30,10 @@ void test_body_init() {
 }
 
 void test_body_setters() {
-    list_t *shape = list_init(3, free);
-    vector_t *v = malloc(sizeof(*v));
-    *v = (vector_t){+1, 0};
-    list_add(shape, v);
-    v = malloc(sizeof(*v));
-    *v = (vector_t){0, +1};
-    list_add(shape, v);
-    v = malloc(sizeof(*v));
-    *v = (vector_t){-1, 0};
-    list_add(shape, v);
+    polygon_t *shape = polygon_init(3);
+    shape->vertices[0] = (vector_t){+1, 0};
+    shape->vertices[1] = (vector_t){0, +1};
+    shape->vertices[2] = (vector_t){-1, 0};
     body_t *body = body_init(shape, 1, (rgba_color_t){0, 0, 0});
     body_set_velocity(body, (vector_t){+5, -5});
     assert(vec_equal(body_get_velocity(body), (vector_t){+5, -5}));
@@ -48,36 +41,27 @@ void test_body_setters() {
     body_set_centroid(body, (vector_t){1, 2});
     assert(vec_isclose(body_get_centroid(body), (vector_t){1, 2}));
     shape = body_get_shape(body);
-    assert(list_size(shape) == 3);
-    assert(
-        vec_isclose(*(vector_t *)list_get(shape, 0), (vector_t){2, 5.0 / 3.0}));
-    assert(
-        vec_isclose(*(vector_t *)list_get(shape, 1), (vector_t){1, 8.0 / 3.0}));
-    assert(
-        vec_isclose(*(vector_t *)list_get(shape, 2), (vector_t){0, 5.0 / 3.0}));
-    list_free(shape);
-    body_set_rotation(body, M_PI / 2);
+    assert(shape->num_vertices == 3);
+    assert(vec_isclose(shape->vertices[0], (vector_t){2, 5.0 / 3.0}));
+    assert(vec_isclose(shape->vertices[1], (vector_t){1, 8.0 / 3.0}));
+    assert(vec_isclose(shape->vertices[2], (vector_t){0, 5.0 / 3.0}));
+    polygon_free(shape);
+    body_set_rotation(body, PI / 2);
     assert(vec_isclose(body_get_centroid(body), (vector_t){1, 2}));
     shape = body_get_shape(body);
-    assert(list_size(shape) == 3);
-    assert(
-        vec_isclose(*(vector_t *)list_get(shape, 0), (vector_t){4.0 / 3.0, 3}));
-    assert(
-        vec_isclose(*(vector_t *)list_get(shape, 1), (vector_t){1.0 / 3.0, 2}));
-    assert(
-        vec_isclose(*(vector_t *)list_get(shape, 2), (vector_t){4.0 / 3.0, 1}));
-    list_free(shape);
+    assert(shape->num_vertices == 3);
+    assert(vec_isclose(shape->vertices[0], (vector_t){4.0 / 3.0, 3}));
+    assert(vec_isclose(shape->vertices[1], (vector_t){1.0 / 3.0, 2}));
+    assert(vec_isclose(shape->vertices[2], (vector_t){4.0 / 3.0, 1}));
+    polygon_free(shape);
     body_set_centroid(body, (vector_t){3, 4});
     assert(vec_isclose(body_get_centroid(body), (vector_t){3, 4}));
     shape = body_get_shape(body);
-    assert(list_size(shape) == 3);
-    assert(vec_isclose(*(vector_t *)list_get(shape, 0),
-                       (vector_t){10.0 / 3.0, 5}));
-    assert(
-        vec_isclose(*(vector_t *)list_get(shape, 1), (vector_t){7.0 / 3.0, 4}));
-    assert(vec_isclose(*(vector_t *)list_get(shape, 2),
-                       (vector_t){10.0 / 3.0, 3}));
-    list_free(shape);
+    assert(shape->num_vertices == 3);
+    assert(vec_isclose(shape->vertices[0], (vector_t){10.0 / 3.0, 5}));
+    assert(vec_isclose(shape->vertices[1], (vector_t){7.0 / 3.0, 4}));
+    assert(vec_isclose(shape->vertices[2], (vector_t){10.0 / 3.0, 3}));
+    polygon_free(shape);
     body_free(body);
 }
 
@@ -85,19 +69,11 @@ void test_body_tick() {
     const vector_t A = {1, 2};
     const double DT = 1e-6;
     const int STEPS = 1000000;
-    list_t *shape = list_init(4, free);
-    vector_t *v = malloc(sizeof(*v));
-    v->x = v->y = -1;
-    list_add(shape, v);
-    v = malloc(sizeof(*v));
-    *v = (vector_t){+1, -1};
-    list_add(shape, v);
-    v = malloc(sizeof(*v));
-    v->x = v->y = +1;
-    list_add(shape, v);
-    v = malloc(sizeof(*v));
-    *v = (vector_t){-1, +1};
-    list_add(shape, v);
+    polygon_t *shape = polygon_init(4);
+    shape->vertices[0] = (vector_t){-1, -1};
+    shape->vertices[1] = (vector_t){+1, -1};
+    shape->vertices[2] = (vector_t){+1, +1};
+    shape->vertices[3] = (vector_t){-1, +1};
     body_t *body = body_init(shape, 1, (rgba_color_t){0, 0, 0});
 
     // Apply constant acceleration and ensure position is (a / 2) * t ** 2
@@ -111,32 +87,20 @@ void test_body_tick() {
     double t = STEPS * DT;
     vector_t new_x = vec_multiply(t * t / 2, A);
     shape = body_get_shape(body);
-    assert(vec_isclose(*(vector_t *)list_get(shape, 0),
-                       vec_add((vector_t){-1, -1}, new_x)));
-    assert(vec_isclose(*(vector_t *)list_get(shape, 1),
-                       vec_add((vector_t){+1, -1}, new_x)));
-    assert(vec_isclose(*(vector_t *)list_get(shape, 2),
-                       vec_add((vector_t){+1, +1}, new_x)));
-    assert(vec_isclose(*(vector_t *)list_get(shape, 3),
-                       vec_add((vector_t){-1, +1}, new_x)));
-    list_free(shape);
+    assert(vec_isclose(shape->vertices[0], vec_add((vector_t){-1, -1}, new_x)));
+    assert(vec_isclose(shape->vertices[1], vec_add((vector_t){+1, -1}, new_x)));
+    assert(vec_isclose(shape->vertices[2], vec_add((vector_t){+1, +1}, new_x)));
+    assert(vec_isclose(shape->vertices[3], vec_add((vector_t){-1, +1}, new_x)));
+    polygon_free(shape);
     body_free(body);
 }
 
 void test_infinite_mass() {
-    list_t *shape = list_init(10, free);
-    vector_t *v = malloc(sizeof(*v));
-    *v = VEC_ZERO;
-    list_add(shape, v);
-    v = malloc(sizeof(*v));
-    *v = (vector_t){+1, 0};
-    list_add(shape, v);
-    v = malloc(sizeof(*v));
-    *v = (vector_t){+1, +1};
-    list_add(shape, v);
-    v = malloc(sizeof(*v));
-    *v = (vector_t){0, +1};
-    list_add(shape, v);
+    polygon_t *shape = polygon_init(4);
+    shape->vertices[0] = VEC_ZERO;
+    shape->vertices[1] = (vector_t){+1, 0};
+    shape->vertices[2] = (vector_t){+1, +1};
+    shape->vertices[3] = (vector_t){0, +1};
     body_t *body = body_init(shape, INFINITY, (rgba_color_t){0, 0, 0});
     body_set_velocity(body, (vector_t){2, 3});
     assert(body_get_mass(body) == INFINITY);
@@ -150,16 +114,10 @@ void test_infinite_mass() {
 void test_forces() {
     const double MASS = 10;
     const double DT = 0.1;
-    list_t *shape = list_init(3, free);
-    vector_t *v = malloc(sizeof(*v));
-    *v = (vector_t){+1, 0};
-    list_add(shape, v);
-    v = malloc(sizeof(*v));
-    *v = (vector_t){0, +1};
-    list_add(shape, v);
-    v = malloc(sizeof(*v));
-    *v = (vector_t){-1, 0};
-    list_add(shape, v);
+    polygon_t *shape = polygon_init(3);
+    shape->vertices[0] = (vector_t){+1, 0};
+    shape->vertices[1] = (vector_t){0, +1};
+    shape->vertices[2] = (vector_t){-1, 0};
     body_t *body = body_init(shape, MASS, (rgba_color_t){0, 0, 0});
     body_set_centroid(body, VEC_ZERO);
     vector_t old_velocity = {1, -2};
@@ -181,16 +139,10 @@ void test_forces() {
 }
 
 void test_body_remove() {
-    list_t *shape = list_init(3, free);
-    vector_t *v = malloc(sizeof(*v));
-    *v = (vector_t){+1, 0};
-    list_add(shape, v);
-    v = malloc(sizeof(*v));
-    *v = (vector_t){0, +1};
-    list_add(shape, v);
-    v = malloc(sizeof(*v));
-    *v = (vector_t){-1, 0};
-    list_add(shape, v);
+    polygon_t *shape = polygon_init(3);
+    shape->vertices[0] = (vector_t){+1, 0};
+    shape->vertices[1] = (vector_t){0, +1};
+    shape->vertices[2] = (vector_t){-1, 0};
     body_t *body = body_init(shape, 1, (rgba_color_t){0, 0, 0});
     assert(!body_is_removed(body));
     body_remove(body);
@@ -201,16 +153,10 @@ void test_body_remove() {
 }
 
 void test_body_info() {
-    list_t *shape = list_init(3, free);
-    vector_t *v = malloc(sizeof(*v));
-    *v = (vector_t){+1, 0};
-    list_add(shape, v);
-    v = malloc(sizeof(*v));
-    *v = (vector_t){0, +1};
-    list_add(shape, v);
-    v = malloc(sizeof(*v));
-    *v = (vector_t){-1, 0};
-    list_add(shape, v);
+    polygon_t *shape = polygon_init(3);
+    shape->vertices[0] = (vector_t){+1, 0};
+    shape->vertices[1] = (vector_t){0, +1};
+    shape->vertices[2] = (vector_t){-1, 0};
     int *info = malloc(sizeof(*info));
     *info = 123;
     body_t *body =
@@ -221,16 +167,10 @@ void test_body_info() {
 }
 
 void test_body_info_freer() {
-    list_t *shape = list_init(3, free);
-    vector_t *v = malloc(sizeof(*v));
-    *v = (vector_t){+1, 0};
-    list_add(shape, v);
-    v = malloc(sizeof(*v));
-    *v = (vector_t){0, +1};
-    list_add(shape, v);
-    v = malloc(sizeof(*v));
-    *v = (vector_t){-1, 0};
-    list_add(shape, v);
+    polygon_t *shape = polygon_init(3);
+    shape->vertices[0] = (vector_t){+1, 0};
+    shape->vertices[1] = (vector_t){0, +1};
+    shape->vertices[2] = (vector_t){-1, 0};
     list_t *info = list_init(3, free);
     int *info_elem = malloc(sizeof(*info_elem));
     *info_elem = 10;
@@ -249,6 +189,368 @@ void test_body_info_freer() {
     body_free(body);
 }
 
+bool bounding_box_isclose(bounding_box_t bbox1, bounding_box_t bbox2) {
+    return isclose(bbox1.min_x, bbox2.min_x) &&
+           isclose(bbox1.min_y, bbox2.min_y) &&
+           isclose(bbox1.max_x, bbox2.max_x) && isclose(bbox1.max_y, bbox2.max_y);
+}
+
+void test_body_bounding_box() {
+    body_t *body = body_init(initialize_rectangle(0, 0, 4, 2), 1,
+                             (rgba_color_t){0, 0, 0});
+    assert(bounding_box_isclose(body_get_bounding_box(body),
+                                (bounding_box_t){0, 0, 4, 2}));
+    body_translate(body, (vector_t){1, -1});
+    assert(bounding_box_isclose(body_get_bounding_box(body),
+                                (bounding_box_t){1, -1, 5, 1}));
+    body_set_rotation(body, PI / 2);
+    assert(bounding_box_isclose(body_get_bounding_box(body),
+                                (bounding_box_t){2, -2, 4, 2}));
+    body_set_velocity(body, (vector_t){1, 0});
+    body_tick(body, 1);
+    polygon_t *shape = body_get_shape(body);
+    assert(bounding_box_isclose(body_get_bounding_box(body),
+                                polygon_get_bounding_box(shape)));
+    polygon_free(shape);
+
+    // Far apart bodies are rejected with an axis from body1 to body2
+    body_t *other = body_init(initialize_rectangle(10, -2, 12, 2), 1,
+                              (rgba_color_t){0, 0, 0});
+    collision_info_t info = detect_body_collision(body, other);
+    assert(info.collided == NO_COLLISION);
+    assert(vec_isclose(info.axis, (vector_t){1, 0}));
+    body_free(other);
+    body_free(body);
+}
+
+void test_static_body() {
+    body_t *body = body_init(initialize_rectangle(0, 0, 1, 1), 5,
+                             (rgba_color_t){0, 0, 0});
+    body_set_velocity(body, (vector_t){2, 3});
+    assert(!body_is_static(body));
+    body_set_static(body, true);
+    assert(body_is_static(body));
+    assert(body_get_mass(body) == INFINITY);
+    assert(vec_equal(body_get_velocity(body), VEC_ZERO));
+    // Ticking doesn't move the body, even with a velocity
+    body_set_velocity(body, (vector_t){2, 3});
+    body_add_force(body, (vector_t){1, 1});
+    body_tick(body, 1.0);
+    assert(vec_isclose(body_get_centroid(body), (vector_t){0.5, 0.5}));
+    body_t *copy = body_copy(body);
+    assert(body_is_static(copy));
+    body_free(copy);
+    body_free(body);
+}
+
+void test_collision_cache() {
+    body_t *body1 = body_init(initialize_rectangle(0, 0, 2, 2), 1,
+                              (rgba_color_t){0, 0, 0});
+    body_t *body2 = body_init(initialize_rectangle(1, 0, 3, 2), 1,
+                              (rgba_color_t){0, 0, 0});
+    collision_info_t info = detect_body_collision(body1, body2);
+    assert(info.collided == PARTIAL_COLLISION);
+    assert(isclose(info.overlap, 1));
+    assert(vec_isclose(info.axis, (vector_t){1, 0}));
+    // The remembered result is the same in either order
+    collision_info_t again = detect_body_collision(body1, body2);
+    assert(again.collided == info.collided && again.overlap == info.overlap);
+    collision_info_t swapped = detect_body_collision(body2, body1);
+    assert(swapped.collided == info.collided && swapped.overlap == info.overlap);
+    assert(vec_isclose(swapped.axis, vec_negate(info.axis)));
+
+    // Moving either body forgets the result
+    body_translate(body2, (vector_t){0.5, 0});
+    assert(isclose(detect_body_collision(body1, body2).overlap, 0.5));
+    body_set_rotation(body1, PI / 2);
+    body_translate(body1, (vector_t){-5, 0});
+    assert(detect_body_collision(body2, body1).collided == NO_COLLISION);
+    // And so does replacing a body with a new one
+    body_free(body1);
+    body1 = body_init(initialize_rectangle(0, 0, 2, 2), 1,
+                      (rgba_color_t){0, 0, 0});
+    assert(detect_body_collision(body2, body1).collided == PARTIAL_COLLISION);
+    body_free(body1);
+    body_free(body2);
+}
+
+void test_edge_normals() {
+    // The cached normals stay in step with the shape as a body spins, and
+    // keep their rotation while it only moves
+    body_t *star = body_init(initialize_star((vector_t){0, 0}, 5, 4, 2), 1,
+                             (rgba_color_t){0, 0, 0});
+    body_t *box = body_init(initialize_rectangle(2, -1, 5, 1), 1,
+                            (rgba_color_t){0, 0, 0});
+    body_rotate(box, 0.3);
+    for (size_t i = 0; i < 100; i++) {
+        if (i % 3 == 0) {
+            body_rotate(star, 0.1);
+        } else {
+            body_translate(star, (vector_t){0.005, 0});
+        }
+        body_translate(box, (vector_t){0.01, 0});
+        body_t *copy = i % 10 == 0 ? body_copy(star) : NULL;
+        polygon_t *star_shape = body_get_shape(star);
+        polygon_t *box_shape = body_get_shape(box);
+        collision_info_t expected = find_collision(star_shape, box_shape);
+        collision_info_t info = detect_body_collision(copy ? copy : star, box);
+        assert(info.collided == expected.collided);
+        assert(isclose(info.overlap, expected.overlap));
+        assert(vec_isclose(info.axis, expected.axis));
+        polygon_free(star_shape);
+        polygon_free(box_shape);
+        if (copy) {
+            body_free(copy);
+        }
+    }
+    body_free(star);
+    body_free(box);
+}
+
+void test_body_store() {
+    // Bodies in a store move exactly like bodies ticked on their own,
+    // including after others are removed from the store around them
+    const size_t NUM_BODIES = 40;
+    const double DT = 0.01;
+    body_store_t *store = body_store_init();
+    body_t *stored[NUM_BODIES], *alone[NUM_BODIES];
+    for (size_t i = 0; i < NUM_BODIES; i++) {
+        for (size_t copy = 0; copy < 2; copy++) {
+            body_t *body = body_init(initialize_rectangle(i, 0, i + 1, 2),
+                                     i % 5 == 0 ? INFINITY : i + 1,
+                                     (rgba_color_t){0, 0, 0});
+            body_set_velocity(body, (vector_t){i, -1});
+            body_set_angular_velocity(body, 0.1 * i);
+            if (copy) {
+                body_store_add(store, body);
+                stored[i] = body;
+            } else {
+                alone[i] = body;
+            }
+        }
+    }
+    assert(body_store_size(store) == NUM_BODIES);
+    for (size_t tick = 0; tick < 30; tick++) {
+        if (tick % 10 == 5) {
+            // Remove one body from the middle of the store
+            size_t i = tick;
+            body_free(stored[i]);
+            body_free(alone[i]);
+            stored[i] = alone[i] = NULL;
+        }
+        for (size_t i = 0; i < NUM_BODIES; i++) {
+            if (stored[i]) {
+                vector_t force = {tick, i};
+                body_add_force(stored[i], force);
+                body_add_force(alone[i], force);
+                body_add_impulse(stored[i], (vector_t){1, 0});
+                body_add_impulse(alone[i], (vector_t){1, 0});
+            }
+        }
+        body_store_integrate(store, DT);
+        for (size_t i = 0; i < NUM_BODIES; i++) {
+            if (stored[i]) {
+                body_apply_integration(stored[i]);
+                body_tick(alone[i], DT);
+                assert(vec_isclose(body_get_centroid(stored[i]),
+                                   body_get_centroid(alone[i])));
+                assert(vec_isclose(body_get_velocity(stored[i]),
+                                   body_get_velocity(alone[i])));
+                assert(vec_isclose(body_get_acceleration(stored[i]),
+                                   body_get_acceleration(alone[i])));
+                polygon_t *stored_shape = body_get_shape(stored[i]);
+                polygon_t *alone_shape = body_get_shape(alone[i]);
+                assert(vec_isclose(stored_shape->vertices[0],
+                                   alone_shape->vertices[0]));
+                polygon_free(stored_shape);
+                polygon_free(alone_shape);
+            }
+        }
+    }
+    assert(body_store_size(store) == NUM_BODIES - 3);
+    // Bodies keep their state when the store goes away
+    vector_t velocity = body_get_velocity(stored[0]);
+    body_store_free(store);
+    assert(vec_equal(body_get_velocity(stored[0]), velocity));
+    for (size_t i = 0; i < NUM_BODIES; i++) {
+        if (stored[i]) {
+            body_free(stored[i]);
+            body_free(alone[i]);
+        }
+    }
+}
+
+void test_shape_prototypes() {
+    size_t num_prototypes = body_shape_prototypes();
+    // Identical shapes at different positions share one prototype
+    body_t *walls[10];
+    for (size_t i = 0; i < 10; i++) {
+        walls[i] = body_init(initialize_rectangle(10 * i, 5, 10 * i + 4, 7),
+                             INFINITY, (rgba_color_t){0, 0, 0});
+    }
+    assert(body_shape_prototypes() == num_prototypes + 1);
+    body_t *copy = body_copy(walls[0]);
+    body_t *tall = body_init(initialize_rectangle(0, 0, 4, 20), 1,
+                             (rgba_color_t){0, 0, 0});
+    assert(body_shape_prototypes() == num_prototypes + 2);
+
+    // The shape a body is placed at matches moving its polygon directly
+    polygon_t *expected = initialize_rectangle(0, 0, 4, 20);
+    for (size_t i = 0; i < 50; i++) {
+        vector_t translation = {0.5, -0.25 * i};
+        body_translate(tall, translation);
+        polygon_translate(expected, translation);
+        if (i % 3 == 0) {
+            body_rotate(tall, 0.2);
+            polygon_rotate(expected, 0.2, polygon_centroid(expected));
+        }
+        if (i % 7 == 0) {
+            polygon_t *shape = body_get_shape(tall);
+            for (size_t v = 0; v < shape->num_vertices; v++) {
+                assert(vec_isclose(shape->vertices[v], expected->vertices[v]));
+            }
+            polygon_free(shape);
+        }
+    }
+    bounding_box_t bbox = body_get_bounding_box(tall);
+    bounding_box_t expected_bbox = polygon_get_bounding_box(expected);
+    assert(isclose(bbox.min_x, expected_bbox.min_x));
+    assert(isclose(bbox.max_y, expected_bbox.max_y));
+    polygon_free(expected);
+
+    // Prototypes are freed with the last body using them
+    body_free(tall);
+    assert(body_shape_prototypes() == num_prototypes + 1);
+    for (size_t i = 0; i < 10; i++) {
+        body_free(walls[i]);
+    }
+    assert(body_shape_prototypes() == num_prototypes + 1);
+    body_free(copy);
+    assert(body_shape_prototypes() == num_prototypes);
+
+    // Rounding in the centroid doesn't keep identical shapes apart
+    body_t *pillars[7];
+    for (size_t i = 0; i < 7; i++) {
+        double x = 137.3 * i + 0.1;
+        double y = 91.7 * i - 3.3;
+        pillars[i] = body_init(initialize_rectangle(x, y, x + 40, y + 200), 1,
+                               (rgba_color_t){0, 0, 0});
+    }
+    assert(body_shape_prototypes() == num_prototypes + 1);
+    for (size_t i = 0; i < 7; i++) {
+        body_free(pillars[i]);
+    }
+    assert(body_shape_prototypes() == num_prototypes);
+}
+
+void test_borrowed_shape() {
+    body_t *body = body_init(initialize_rectangle(0, 0, 4, 2), 1,
+                             (rgba_color_t){0, 0, 0});
+    body_set_collision_proxy(body, COLLISION_PROXY_HULL, 3);
+    // A borrowed shape matches a copy, and is the same until the body moves
+    const polygon_t *borrowed = body_borrow_shape(body);
+    assert(body_borrow_shape(body) == borrowed);
+    polygon_t *copy = body_get_shape(body);
+    assert(borrowed->num_vertices == copy->num_vertices);
+    for (size_t i = 0; i < copy->num_vertices; i++) {
+        assert(vec_equal(borrowed->vertices[i], copy->vertices[i]));
+    }
+    body_translate(body, (vector_t){1, 1});
+    borrowed = body_borrow_shape(body);
+    for (size_t i = 0; i < copy->num_vertices; i++) {
+        assert(vec_isclose(borrowed->vertices[i],
+                           vec_add(copy->vertices[i], (vector_t){1, 1})));
+    }
+    polygon_free(copy);
+
+    const polygon_t *collision_shape = body_borrow_collision_shape(body);
+    copy = body_get_collision_shape(body);
+    assert(collision_shape->num_vertices == 3);
+    for (size_t i = 0; i < copy->num_vertices; i++) {
+        assert(vec_equal(collision_shape->vertices[i], copy->vertices[i]));
+    }
+    polygon_free(copy);
+    body_free(body);
+}
+
+void test_collision_proxy() {
+    // A box that the arms of a star miss, but its bounding box doesn't
+    body_t *star = body_init(initialize_star((vector_t){0, 0}, 4, 10, 2), 1,
+                             (rgba_color_t){0, 0, 0});
+    body_t *box = body_init(initialize_rectangle(6, 6, 9, 9), 1,
+                            (rgba_color_t){0, 0, 0});
+    body_set_collision_proxy(star, COLLISION_PROXY_AABB, 0);
+    assert(detect_body_collision(star, box).collided == FULL_COLLISION);
+    body_set_collision_proxy(star, COLLISION_PROXY_HULL, 4);
+    polygon_t *hull = body_get_collision_shape(star);
+    assert(hull->num_vertices == 4);
+    polygon_free(hull);
+    assert(detect_body_collision(star, box).collided == NO_COLLISION);
+
+    // The proxy moves with the body, and the shape is unchanged
+    body_translate(star, (vector_t){7, 7});
+    assert(detect_body_collision(star, box).collided != NO_COLLISION);
+    polygon_t *shape = body_get_shape(star);
+    assert(shape->num_vertices == 8);
+    polygon_free(shape);
+
+    // An OBB follows the shape's rotation and stays inside the bounding box
+    body_set_rotation(star, PI / 4);
+    body_set_collision_proxy(star, COLLISION_PROXY_OBB, 0);
+    polygon_t *obb = body_get_collision_shape(star);
+    assert(obb->num_vertices == 4);
+    bounding_box_t bbox =
+        bounding_box_expand(body_get_bounding_box(star), 1e-7);
+    for (size_t i = 0; i < 4; i++) {
+        assert(bounding_box_contains_point(bbox, obb->vertices[i]));
+    }
+    polygon_free(obb);
+    body_set_collision_proxy(star, COLLISION_PROXY_NONE, 0);
+    polygon_t *collision_shape = body_get_collision_shape(star);
+    assert(collision_shape->num_vertices == 8);
+    polygon_free(collision_shape);
+    body_free(star);
+    body_free(box);
+}
+
+void test_round_proxies() {
+    body_t *ball = body_init(initialize_ellipse((vector_t){0, 0}, 4, 4, 64), 1,
+                             (rgba_color_t){0, 0, 0});
+    body_set_collision_proxy(ball, COLLISION_PROXY_CIRCLE, 0);
+    body_t *rod = body_init(initialize_rectangle(-1, -5, 1, 5), 1,
+                            (rgba_color_t){0, 0, 0});
+    body_set_collision_proxy(rod, COLLISION_PROXY_CAPSULE, 0);
+    body_translate(rod, (vector_t){2.5, 0});
+    // The ball's circle is 2 wide and the rod's capsule 1 wide
+    collision_info_t info = detect_body_collision(ball, rod);
+    assert(info.collided == PARTIAL_COLLISION);
+    assert(vec_isclose(info.axis, (vector_t){1, 0}));
+    assert(isclose(info.overlap, 0.5));
+    info = detect_body_collision(rod, ball);
+    assert(vec_isclose(info.axis, (vector_t){-1, 0}));
+
+    // The capsule rotates with the rod
+    body_set_rotation(rod, PI / 2);
+    body_set_centroid(rod, (vector_t){0, 2.5});
+    info = detect_body_collision(ball, rod);
+    assert(info.collided == PARTIAL_COLLISION);
+    assert(vec_isclose(info.axis, (vector_t){0, 1}));
+    assert(isclose(info.overlap, 0.5));
+    body_set_centroid(rod, (vector_t){6, 2.5});
+    assert(detect_body_collision(ball, rod).collided == NO_COLLISION);
+
+    // Round bodies also collide with polygons
+    body_t *floor = body_init(initialize_rectangle(-10, -10, 10, -1.5), 1,
+                              (rgba_color_t){0, 0, 0});
+    info = detect_body_collision(floor, ball);
+    assert(info.collided == PARTIAL_COLLISION);
+    assert(vec_isclose(info.axis, (vector_t){0, 1}));
+    assert(isclose(info.overlap, 0.5));
+    body_free(ball);
+    body_free(rod);
+    body_free(floor);
+}
+
 int main(int argc, char *argv[]) {
     // Run all tests if there are no command-line arguments
     bool all_tests = argc == 1;
@@ -266,6 +568,15 @@ int main(int argc, char *argv[]) {
     DO_TEST(test_body_remove)
     DO_TEST(test_body_info)
     DO_TEST(test_body_info_freer)
+    DO_TEST(test_body_bounding_box)
+    DO_TEST(test_static_body)
+    DO_TEST(test_collision_cache)
+    DO_TEST(test_edge_normals)
+    DO_TEST(test_body_store)
+    DO_TEST(test_shape_prototypes)
+    DO_TEST(test_borrowed_shape)
+    DO_TEST(test_collision_proxy)
+    DO_TEST(test_round_proxies)
 
     puts("body_test PASS");
 }
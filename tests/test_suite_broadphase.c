@@ -0,0 +1,241 @@
+#include "broadphase.h"
+#include "polygon.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+const double CELL_SIZE = 10;
+
+body_t *make_box(double min_x, double min_y, double max_x, double max_y) {
+    return body_init(initialize_rectangle(min_x, min_y, max_x, max_y), 1,
+                     COLOR_BLACK);
+}
+
+bool has_pair(broadphase_t *broadphase, size_t num_pairs, body_t *body1,
+              body_t *body2) {
+    for (size_t i = 0; i < num_pairs; i++) {
+        body_pair_t *pair = broadphase_get_pair(broadphase, i);
+        if ((pair->body1 == body1 && pair->body2 == body2) ||
+            (pair->body1 == body2 && pair->body2 == body1)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void test_simple_pairs() {
+    broadphase_t *broadphase = broadphase_init(CELL_SIZE);
+    body_t *a = make_box(0, 0, 5, 5);
+    body_t *b = make_box(4, 4, 8, 8);
+    body_t *c = make_box(50, 50, 55, 55);
+    // Spans several cells, and overlaps b in more than one of them
+    body_t *d = make_box(5, -15, 25, 25);
+    broadphase_add_body(broadphase, a);
+    broadphase_add_body(broadphase, b);
+    broadphase_add_body(broadphase, c);
+    broadphase_add_body(broadphase, d);
+    size_t num_pairs = broadphase_find_pairs(broadphase);
+    assert(num_pairs == 3);
+    assert(has_pair(broadphase, num_pairs, a, b));
+    assert(has_pair(broadphase, num_pairs, a, d));
+    assert(has_pair(broadphase, num_pairs, b, d));
+    // Pairs are ordered by the order the bodies were added
+    body_pair_t *first = broadphase_get_pair(broadphase, 0);
+    assert(first->body1 == a && first->body2 == b);
+    body_free(a);
+    body_free(b);
+    body_free(c);
+    body_free(d);
+    broadphase_free(broadphase);
+}
+
+void test_matches_all_pairs() {
+    const size_t NUM_BODIES = 200;
+    srand(3);
+    broadphase_t *broadphase = broadphase_init(CELL_SIZE);
+    body_t *bodies[NUM_BODIES];
+    for (size_t i = 0; i < NUM_BODIES; i++) {
+        double x = rand() % 300 - 150;
+        double y = rand() % 300 - 150;
+        double width = 1 + rand() % 30;
+        double height = 1 + rand() % 30;
+        // A few bodies are too big to be put in the grid
+        if (i % 50 == 0) {
+            width = 200;
+        }
+        bodies[i] = make_box(x, y, x + width, y + height);
+        broadphase_add_body(broadphase, bodies[i]);
+    }
+    size_t num_pairs = broadphase_find_pairs(broadphase);
+    size_t expected_pairs = 0;
+    for (size_t i = 0; i < NUM_BODIES; i++) {
+        for (size_t j = i + 1; j < NUM_BODIES; j++) {
+            if (bounding_box_overlaps(body_get_bounding_box(bodies[i]),
+                                      body_get_bounding_box(bodies[j]))) {
+                expected_pairs++;
+                assert(has_pair(broadphase, num_pairs, bodies[i], bodies[j]));
+            }
+        }
+    }
+    assert(num_pairs == expected_pairs);
+    for (size_t i = 0; i < NUM_BODIES; i++) {
+        body_free(bodies[i]);
+    }
+    broadphase_free(broadphase);
+}
+
+void test_pair_state() {
+    broadphase_t *broadphase = broadphase_init(CELL_SIZE);
+    body_t *a = make_box(0, 0, 5, 5);
+    body_t *b = make_box(4, 4, 8, 8);
+    body_t *c = make_box(3, 3, 6, 6);
+
+    broadphase_add_body(broadphase, a);
+    broadphase_add_body(broadphase, b);
+    assert(broadphase_find_pairs(broadphase) == 1);
+    assert(broadphase_get_pair(broadphase, 0)->status == NO_COLLISION);
+    broadphase_get_pair(broadphase, 0)->status = PARTIAL_COLLISION;
+
+    // The state is kept while the bodies stay a pair
+    broadphase_add_body(broadphase, c);
+    broadphase_add_body(broadphase, a);
+    broadphase_add_body(broadphase, b);
+    assert(broadphase_find_pairs(broadphase) == 3);
+    for (size_t i = 0; i < 3; i++) {
+        body_pair_t *pair = broadphase_get_pair(broadphase, i);
+        bool is_ab = (pair->body1 == a && pair->body2 == b) ||
+                     (pair->body1 == b && pair->body2 == a);
+        assert(pair->status == (is_ab ? PARTIAL_COLLISION : NO_COLLISION));
+    }
+
+    assert(broadphase_lost_pairs(broadphase) == 0);
+
+    // Moving apart forgets the state, after reporting the pair as lost once
+    body_translate(b, (vector_t){100, 0});
+    broadphase_add_body(broadphase, a);
+    broadphase_add_body(broadphase, b);
+    assert(broadphase_find_pairs(broadphase) == 0);
+    assert(broadphase_lost_pairs(broadphase) == 3);
+    bool lost_ab = false;
+    for (size_t i = 0; i < 3; i++) {
+        body_pair_t *pair = broadphase_get_lost_pair(broadphase, i);
+        if ((pair->body1 == a && pair->body2 == b) ||
+            (pair->body1 == b && pair->body2 == a)) {
+            assert(pair->status == PARTIAL_COLLISION);
+            lost_ab = true;
+        }
+    }
+    assert(lost_ab);
+    broadphase_add_body(broadphase, a);
+    broadphase_add_body(broadphase, b);
+    assert(broadphase_find_pairs(broadphase) == 0);
+    assert(broadphase_lost_pairs(broadphase) == 0);
+    body_translate(b, (vector_t){-100, 0});
+    broadphase_add_body(broadphase, a);
+    broadphase_add_body(broadphase, b);
+    assert(broadphase_find_pairs(broadphase) == 1);
+    assert(broadphase_get_pair(broadphase, 0)->status == NO_COLLISION);
+
+    // So does removing one of the bodies, without reporting the pair as lost
+    broadphase_get_pair(broadphase, 0)->status = PARTIAL_COLLISION;
+    body_remove(b);
+    broadphase_forget_removed_bodies(broadphase);
+    broadphase_add_body(broadphase, a);
+    broadphase_add_body(broadphase, c);
+    assert(broadphase_find_pairs(broadphase) == 1);
+    assert(broadphase_lost_pairs(broadphase) == 0);
+    assert(broadphase_get_pair(broadphase, 0)->status == NO_COLLISION);
+
+    // And clearing the broadphase
+    broadphase_get_pair(broadphase, 0)->status = PARTIAL_COLLISION;
+    broadphase_clear(broadphase);
+    broadphase_add_body(broadphase, a);
+    broadphase_add_body(broadphase, c);
+    assert(broadphase_find_pairs(broadphase) == 1);
+    assert(broadphase_get_pair(broadphase, 0)->status == NO_COLLISION);
+
+    body_free(a);
+    body_free(b);
+    body_free(c);
+    broadphase_free(broadphase);
+}
+
+void test_static_bodies() {
+    broadphase_t *broadphase = broadphase_init(CELL_SIZE);
+    body_t *wall1 = make_box(0, 0, 30, 5);
+    body_t *wall2 = make_box(25, 0, 30, 30);
+    // Too big for the grid
+    body_t *floor = make_box(-1000, -10, 1000, 4);
+    body_t *player = make_box(26, 3, 28, 6);
+    body_t *bullet = make_box(100, 100, 101, 101);
+    body_t *bodies[] = {wall1, wall2, floor, player, bullet};
+    for (size_t i = 0; i < 5; i++) {
+        body_set_collision_layers(bodies[i], 1);
+    }
+    for (size_t i = 0; i < 3; i++) {
+        body_set_static(bodies[i], true);
+        broadphase_add_static_body(broadphase, bodies[i]);
+    }
+
+    // The walls overlap each other, but only pairs with the player are found,
+    // and static bodies stay in the broadphase between calls
+    for (size_t i = 0; i < 2; i++) {
+        broadphase_add_body(broadphase, player);
+        broadphase_add_body(broadphase, bullet);
+        size_t num_pairs = broadphase_find_pairs(broadphase);
+        assert(num_pairs == 3);
+        assert(has_pair(broadphase, num_pairs, player, wall1));
+        assert(has_pair(broadphase, num_pairs, player, wall2));
+        assert(has_pair(broadphase, num_pairs, player, floor));
+        // Dynamic bodies come first in pairs
+        for (size_t j = 0; j < num_pairs; j++) {
+            assert(broadphase_get_pair(broadphase, j)->body1 == player);
+        }
+    }
+
+    // Static bodies without collision layers aren't paired
+    body_set_collision_layers(floor, 0);
+    broadphase_add_body(broadphase, player);
+    assert(broadphase_find_pairs(broadphase) == 2);
+    body_set_collision_layers(floor, 1);
+
+    // Removed static bodies are dropped
+    body_remove(wall2);
+    broadphase_forget_removed_bodies(broadphase);
+    body_free(wall2);
+    broadphase_add_body(broadphase, player);
+    size_t num_pairs = broadphase_find_pairs(broadphase);
+    assert(num_pairs == 2);
+    assert(has_pair(broadphase, num_pairs, player, wall1));
+    assert(has_pair(broadphase, num_pairs, player, floor));
+
+    // Clearing removes the static bodies too
+    broadphase_clear(broadphase);
+    broadphase_add_body(broadphase, player);
+    assert(broadphase_find_pairs(broadphase) == 0);
+
+    body_free(wall1);
+    body_free(floor);
+    body_free(player);
+    body_free(bullet);
+    broadphase_free(broadphase);
+}
+
+int main(int argc, char *argv[]) {
+    // Run all tests if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests) {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_simple_pairs)
+    DO_TEST(test_matches_all_pairs)
+    DO_TEST(test_pair_state)
+    DO_TEST(test_static_bodies)
+
+    puts("broadphase_test PASS");
+}
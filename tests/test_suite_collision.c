@@ -24,8 +24,8 @@ void test_collisions() {
         vector_t dir = {.x = cos(theta), .y = sin(theta)};
         scene_t *scene = scene_init();
         // initialize squares separated by given distance
-        list_t *shape1 = initialize_rectangle(0, -L1 / 2, L1, L1 / 2);
-        list_t *shape2 =
+        polygon_t *shape1 = initialize_rectangle(0, -L1 / 2, L1, L1 / 2);
+        polygon_t *shape2 =
             initialize_rectangle(L1 + INITIAL_SEPARATION, -L2 / 2,
                                  L1 + INITIAL_SEPARATION + L2, L2 / 2);
         // rotate both around the origin
@@ -61,6 +61,179 @@ void test_collisions() {
     }
 }
 
+void test_collision_axis_hint() {
+    const double DX = 0.5;
+    const int STEPS = 200;
+    // A rotated square moving through a wall and out the other side
+    polygon_t *square =
+        initialize_rectangle_centered((vector_t){-40, 3}, 20, 20);
+    polygon_rotate(square, 0.3, (vector_t){-40, 3});
+    polygon_t *wall = initialize_rectangle(-5, -50, 5, 50);
+    vector_t axis_hint = VEC_ZERO;
+    for (int i = 0; i < STEPS; i++) {
+        collision_info_t expected = find_collision(square, wall);
+        collision_info_t info =
+            find_collision_with_hint(square, wall, &axis_hint);
+        assert(info.collided == expected.collided);
+        if (info.collided) {
+            assert(vec_isclose(info.axis, expected.axis));
+            assert(isclose(info.overlap, expected.overlap));
+        } else {
+            // The axis still points from the square towards the wall
+            vector_t to_wall = vec_negate(polygon_centroid(square));
+            assert(vec_dot(info.axis, to_wall) > 0);
+        }
+        assert(vec_isclose(axis_hint, info.axis));
+        polygon_translate(square, (vector_t){DX, 0});
+    }
+    polygon_free(square);
+    polygon_free(wall);
+}
+
+void test_time_of_impact() {
+    polygon_t *bullet = initialize_rectangle_centered((vector_t){0, 0}, 2, 2);
+    polygon_t *wall = initialize_rectangle(50, -100, 51, 100);
+    // Reaches the wall after moving 49 of 100
+    assert(isclose(find_time_of_impact(bullet, wall, (vector_t){100, 0}),
+                   0.49));
+    // Stops short of the wall, or moves away from it
+    assert(find_time_of_impact(bullet, wall, (vector_t){40, 0}) == INFINITY);
+    assert(find_time_of_impact(bullet, wall, (vector_t){-100, 0}) ==
+           INFINITY);
+    // Passes over the wall diagonally
+    polygon_t *box = initialize_rectangle(50, -10, 60, 10);
+    assert(find_time_of_impact(bullet, box, (vector_t){100, 100}) ==
+           INFINITY);
+    assert(isclose(find_time_of_impact(bullet, box, (vector_t){100, 10}),
+                   0.49));
+    // Already overlapping
+    polygon_t *overlapping = initialize_rectangle(0, 0, 5, 5);
+    assert(find_time_of_impact(bullet, overlapping, (vector_t){100, 0}) == 0);
+    polygon_free(bullet);
+    polygon_free(wall);
+    polygon_free(box);
+    polygon_free(overlapping);
+}
+
+void test_gjk_matches_sat() {
+    const int STEPS = 120;
+    const vector_t STEP = {0.7, 0.23};
+    polygon_t *moving_shapes[] = {
+        initialize_ellipse((vector_t){-50, -10}, 30, 18, 40),
+        initialize_regular_polygon((vector_t){-50, -10}, 12, 7),
+        initialize_rectangle_centered((vector_t){-50, -10}, 10, 6)};
+    polygon_t *still_shapes[] = {
+        initialize_ellipse((vector_t){0, 0}, 40, 25, 64),
+        initialize_rectangle(-3, -40, 4, 40),
+        initialize_regular_polygon((vector_t){0, 0}, 15, 5)};
+    polygon_rotate(moving_shapes[2], 0.4, (vector_t){-50, -10});
+    for (size_t m = 0; m < 3; m++) {
+        polygon_t *moving = moving_shapes[m];
+        for (size_t s = 0; s < 3; s++) {
+            polygon_t *still = still_shapes[s];
+            for (int i = 0; i < STEPS; i++) {
+                collision_info_t expected = find_collision(moving, still);
+                collision_info_t info = find_collision_gjk(moving, still);
+                if (expected.collided == PARTIAL_COLLISION) {
+                    assert(info.collided == PARTIAL_COLLISION);
+                    assert(isclose(info.overlap, expected.overlap));
+                    assert(vec_isclose(info.axis, expected.axis));
+                } else if (expected.collided == FULL_COLLISION) {
+                    // SAT picks an axis where one shape contains the other,
+                    // which may not be the axis of least penetration
+                    assert(info.collided != NO_COLLISION);
+                } else {
+                    assert(info.collided == NO_COLLISION);
+                    // The axis separates the shapes, from moving to still
+                    double min1 = INFINITY, max1 = -INFINITY;
+                    double min2 = INFINITY, max2 = -INFINITY;
+                    for (size_t v = 0; v < moving->num_vertices; v++) {
+                        double p = vec_dot(moving->vertices[v], info.axis);
+                        min1 = fmin(min1, p);
+                        max1 = fmax(max1, p);
+                    }
+                    for (size_t v = 0; v < still->num_vertices; v++) {
+                        double p = vec_dot(still->vertices[v], info.axis);
+                        min2 = fmin(min2, p);
+                        max2 = fmax(max2, p);
+                    }
+                    assert(max1 <= min2 + 1e-7);
+                }
+                polygon_translate(moving, STEP);
+            }
+            polygon_translate(moving, vec_multiply(-STEPS, STEP));
+        }
+    }
+    for (size_t i = 0; i < 3; i++) {
+        polygon_free(moving_shapes[i]);
+        polygon_free(still_shapes[i]);
+    }
+    // Shapes with many vertices are checked with GJK automatically
+    polygon_t *inner = initialize_ellipse((vector_t){1, 0}, 10, 10, 32);
+    polygon_t *outer = initialize_ellipse((vector_t){0, 0}, 40, 40, 32);
+    collision_info_t info =
+        find_collision_with_method(inner, outer, COLLISION_METHOD_AUTO, NULL);
+    assert(info.collided == FULL_COLLISION);
+    polygon_free(inner);
+    polygon_free(outer);
+}
+
+void test_capsules() {
+    capsule_t circle1 = {.start = {0, 0}, .end = {0, 0}, .radius = 2};
+    capsule_t circle2 = {.start = {3, 0}, .end = {3, 0}, .radius = 2};
+    collision_info_t info = find_collision_capsules(circle1, circle2);
+    assert(info.collided == PARTIAL_COLLISION);
+    assert(vec_isclose(info.axis, (vector_t){1, 0}));
+    assert(isclose(info.overlap, 1));
+    circle2.start = circle2.end = (vector_t){0, -5};
+    info = find_collision_capsules(circle1, circle2);
+    assert(info.collided == NO_COLLISION);
+    assert(vec_isclose(info.axis, (vector_t){0, -1}));
+
+    // A circle sitting in a capsule's side
+    capsule_t capsule = {.start = {-10, 3}, .end = {10, 3}, .radius = 1.5};
+    info = find_collision_capsules(circle1, capsule);
+    assert(info.collided == PARTIAL_COLLISION);
+    assert(vec_isclose(info.axis, (vector_t){0, 1}));
+    assert(isclose(info.overlap, 0.5));
+
+    // Near a box's corner, a circle only touches if the corner is close enough
+    polygon_t *box = initialize_rectangle(0, 0, 10, 10);
+    capsule_t corner_circle = {.start = {-1, -1}, .end = {-1, -1}, .radius = 1};
+    info = find_collision_capsule_polygon(corner_circle, box);
+    assert(info.collided == NO_COLLISION);
+    corner_circle.radius = 1.5;
+    info = find_collision_capsule_polygon(corner_circle, box);
+    assert(info.collided == PARTIAL_COLLISION);
+    assert(vec_isclose(info.axis, vec_direction((vector_t){1, 1})));
+
+    // Capsules against polygons match SAT on the same capsule as a polygon
+    capsule_t wide = {.start = {-3, 4}, .end = {3, 4}, .radius = 1};
+    polygon_t *wide_box = initialize_rectangle(-3, 3, 3, 5);
+    for (double y = 12; y > -2; y -= 0.37) {
+        capsule_t moved = {.start = {wide.start.x + 7, y},
+                           .end = {wide.end.x + 7, y},
+                           .radius = wide.radius};
+        polygon_translate(wide_box, (vector_t){7, y - 4});
+        collision_info_t expected = find_collision(wide_box, box);
+        info = find_collision_capsule_polygon(moved, box);
+        assert(info.collided == expected.collided);
+        if (expected.collided == PARTIAL_COLLISION) {
+            assert(vec_isclose(info.axis, expected.axis));
+            assert(isclose(info.overlap, expected.overlap));
+        }
+        polygon_translate(wide_box, (vector_t){-7, 4 - y});
+    }
+    // A capsule lying across the box collides along its own normal
+    capsule_t crossing = {.start = {-5, 8}, .end = {15, 8}, .radius = 1};
+    info = find_collision_capsule_polygon(crossing, box);
+    assert(info.collided == FULL_COLLISION);
+    assert(vec_isclose(info.axis, (vector_t){0, -1}));
+    assert(isclose(info.overlap, 2));
+    polygon_free(wide_box);
+    polygon_free(box);
+}
+
 int main(int argc, char *argv[]) {
     // Run all tests if there are no command-line arguments
     bool all_tests = argc == 1;
@@ -71,4 +244,8 @@ int main(int argc, char *argv[]) {
     }
 
     DO_TEST(test_collisions)
+    DO_TEST(test_collision_axis_hint)
+    DO_TEST(test_time_of_impact)
+    DO_TEST(test_gjk_matches_sat)
+    DO_TEST(test_capsules)
 }
@@ -1,8 +1,11 @@
+#include "array.h"
 #include "list.h"
 #include "test_util.h"
 #include <assert.h>
 #include <stdlib.h>
 
+DEFINE_ARRAY(vector_array, vector_t)
+
 void test_list_size0() {
     list_t *l = list_init(0, free);
     assert(list_size(l) == 0);
@@ -248,6 +251,64 @@ void test_null_values() {
     list_free(l);
 }
 
+void test_array() {
+    vector_array_t *array = vector_array_init(0);
+    assert(vector_array_size(array) == 0);
+    // Values are stored by value, and the array grows to fit them
+    for (size_t i = 0; i < 100; i++) {
+        vector_array_add(array, (vector_t){.x = i, .y = -(double)i});
+    }
+    assert(vector_array_size(array) == 100);
+    for (size_t i = 0; i < 100; i++) {
+        assert(vec_equal(vector_array_get(array, i),
+                         (vector_t){.x = i, .y = -(double)i}));
+    }
+    vector_array_set(array, 5, VEC_ZERO);
+    assert(vec_equal(vector_array_get(array, 5), VEC_ZERO));
+
+    // Removing keeps the order, swap-removing moves the last value
+    vector_t removed = vector_array_remove(array, 10);
+    assert(removed.x == 10);
+    assert(vector_array_get(array, 10).x == 11);
+    assert(vector_array_get(array, 98).x == 99);
+    removed = vector_array_swap_remove(array, 20);
+    assert(removed.x == 21);
+    assert(vector_array_get(array, 20).x == 99);
+    assert(vector_array_get(array, 21).x == 22);
+    assert(vector_array_size(array) == 98);
+    removed = vector_array_swap_remove(array, 97);
+    assert(removed.x == 98);
+    assert(vector_array_size(array) == 97);
+
+    // Keeping the values with even x in one pass keeps their order
+    vector_t evens[100];
+    size_t num_evens = 0;
+    size_t num_kept = 0;
+    for (size_t i = 0; i < vector_array_size(array); i++) {
+        vector_t v = vector_array_get(array, i);
+        if ((int)v.x % 2 == 0) {
+            evens[num_evens] = v;
+            num_evens++;
+            vector_array_set(array, num_kept, v);
+            num_kept++;
+        }
+    }
+    vector_array_truncate(array, num_kept);
+    assert(vector_array_size(array) == num_evens);
+    for (size_t i = 0; i < num_evens; i++) {
+        assert(vec_equal(vector_array_get(array, i), evens[i]));
+    }
+
+    // Reserving keeps the values
+    size_t size = vector_array_size(array);
+    vector_array_reserve(array, 1000);
+    assert(vector_array_size(array) == size);
+    assert(vector_array_get(array, 1).x == 2);
+    vector_array_clear(array);
+    assert(vector_array_size(array) == 0);
+    vector_array_free(array);
+}
+
 int main(int argc, char *argv[]) {
     // Run all tests if there are no command-line arguments
     bool all_tests = argc == 1;
@@ -266,6 +327,7 @@ int main(int argc, char *argv[]) {
     DO_TEST(test_full_add)
     DO_TEST(test_empty_remove_back)
     DO_TEST(test_null_values)
+    DO_TEST(test_array)
 
     puts("list_test PASS");
 }
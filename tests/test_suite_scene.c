@@ -1,3 +1,4 @@
+#include "forces.h"
 #include "polygon.h"
 #include "scene.h"
 #include "test_util.h"
@@ -23,20 +24,12 @@ void test_empty_scene() {
     scene_free(scene);
 }
 
-list_t *make_shape() {
-    list_t *shape = list_init(4, free);
-    vector_t *v = malloc(sizeof(*v));
-    *v = (vector_t){-1, -1};
-    list_add(shape, v);
-    v = malloc(sizeof(*v));
-    *v = (vector_t){+1, -1};
-    list_add(shape, v);
-    v = malloc(sizeof(*v));
-    *v = (vector_t){+1, +1};
-    list_add(shape, v);
-    v = malloc(sizeof(*v));
-    *v = (vector_t){-1, +1};
-    list_add(shape, v);
+polygon_t *make_shape() {
+    polygon_t *shape = polygon_init(4);
+    shape->vertices[0] = (vector_t){-1, -1};
+    shape->vertices[1] = (vector_t){+1, -1};
+    shape->vertices[2] = (vector_t){+1, +1};
+    shape->vertices[3] = (vector_t){-1, +1};
     return shape;
 }
 
@@ -240,9 +233,10 @@ void test_line_of_sight() {
     vector_t player_center = {.x = 15, .y = 15};
     vector_t crewmate_center = {.x = 654.341962, .y = 264.393454};
 
-    list_t *player_shape = initialize_rectangle_centered(player_center, 30, 30);
-    list_t *wall_shape = initialize_rectangle(245, 0, 255, 250);
-    list_t *crewmate_shape =
+    polygon_t *player_shape =
+        initialize_rectangle_centered(player_center, 30, 30);
+    polygon_t *wall_shape = initialize_rectangle(245, 0, 255, 250);
+    polygon_t *crewmate_shape =
         initialize_rectangle_centered(crewmate_center, 30, 30);
 
     body_t *player_body = body_init(player_shape, 0, COLOR_BLACK);
@@ -262,6 +256,588 @@ void test_line_of_sight() {
     scene_free(scene);
 }
 
+typedef struct {
+    body_t *expected_body1;
+    int count;
+} rule_aux_t;
+void count_rule_calls(body_t *body1, body_t *body2, vector_t axis, void *aux) {
+    rule_aux_t *rule_aux = aux;
+    // The body matching layer1 is always passed first
+    assert(body1 == rule_aux->expected_body1);
+    rule_aux->count++;
+}
+
+void test_collision_rules() {
+    const uint32_t LAYER_A = 1, LAYER_B = 2, LAYER_C = 4;
+    scene_t *scene = scene_init();
+    body_t *a = body_init(make_shape(), 1, (rgba_color_t){0, 0, 0});
+    body_t *b = body_init(make_shape(), 1, (rgba_color_t){0, 0, 0});
+    body_t *c = body_init(make_shape(), 1, (rgba_color_t){0, 0, 0});
+    body_t *no_layers = body_init(make_shape(), 1, (rgba_color_t){0, 0, 0});
+    body_set_collision_layers(a, LAYER_A);
+    body_set_collision_layers(b, LAYER_B);
+    body_set_collision_layers(c, LAYER_C);
+    scene_add_body(scene, b);
+    scene_add_body(scene, a);
+    scene_add_body(scene, c);
+    scene_add_body(scene, no_layers);
+
+    rule_aux_t *once_aux = malloc(sizeof(*once_aux));
+    *once_aux = (rule_aux_t){.expected_body1 = a, .count = 0};
+    scene_add_collision_rule(scene,
+                             (collision_rule_t){.layer1 = LAYER_A,
+                                                .layer2 = LAYER_B,
+                                                .handler = count_rule_calls},
+                             once_aux, free);
+    rule_aux_t *contact_aux = malloc(sizeof(*contact_aux));
+    *contact_aux = (rule_aux_t){.expected_body1 = c, .count = 0};
+    scene_add_collision_rule(
+        scene,
+        (collision_rule_t){.layer1 = LAYER_C,
+                           .layer2 = LAYER_A | LAYER_B,
+                           .handler = count_rule_calls,
+                           .is_post_tick = true,
+                           .is_contact_collision = true},
+        contact_aux, free);
+
+    // All 3 bodies overlap, so the first rule fires once while they stay
+    // overlapping, and the second rule fires for (c, a) and (c, b) every tick
+    for (int i = 0; i < 3; i++) {
+        scene_tick(scene, 0);
+    }
+    assert(once_aux->count == 1);
+    assert(contact_aux->count == 6);
+
+    // Separating and overlapping again fires the first rule again
+    body_set_centroid(a, (vector_t){10, 0});
+    scene_tick(scene, 0);
+    body_set_centroid(a, (vector_t){0, 0});
+    scene_tick(scene, 0);
+    assert(once_aux->count == 2);
+    assert(contact_aux->count == 6 + 1 + 2);
+
+    // Removed bodies no longer collide
+    body_remove(b);
+    scene_tick(scene, 0);
+    assert(once_aux->count == 2);
+    assert(contact_aux->count == 9 + 1);
+
+    // Clearing the scene removes the rules
+    scene_clear(scene);
+    assert(scene_bodies(scene) == 0);
+    scene_free(scene);
+}
+
+size_t num_freed_auxes = 0;
+void do_nothing(void *aux) {}
+void count_frees(void *aux) {
+    num_freed_auxes++;
+    free(aux);
+}
+
+void test_scene_clear() {
+    scene_t *scene = scene_init();
+    for (size_t level = 0; level < 3; level++) {
+        // Memory from the scene lasts until it is cleared
+        double *values = scene_alloc(scene, 100 * sizeof(double));
+        for (size_t i = 0; i < 100; i++) {
+            values[i] = i;
+        }
+        body_t *anchor = body_init(make_shape(), 1, (rgba_color_t){0, 0, 0});
+        scene_add_body(scene, anchor);
+        for (size_t i = 0; i < 20; i++) {
+            body_t *body = body_init(make_shape(), 1, (rgba_color_t){0, 0, 0});
+            body_set_centroid(body, (vector_t){.x = 10 * (double)i, .y = 0});
+            scene_add_body(scene, body);
+            create_spring(scene, 1, anchor, body);
+            if (i % 2 == 0) {
+                body_remove(body);
+            }
+        }
+        scene_add_force_creator(scene, do_nothing, malloc(1), count_frees);
+        scene_tick(scene, 0);
+        // Removed bodies' entries are reused by new bodies
+        for (size_t i = 0; i < 10; i++) {
+            scene_add_body(scene,
+                           body_init(make_shape(), 1, (rgba_color_t){0, 0, 0}));
+        }
+        list_t *found = list_init(25, NULL);
+        assert(scene_query_region(scene, INFINITE_BBOX, found) == 21);
+        list_free(found);
+        for (size_t i = 0; i < 100; i++) {
+            assert(values[i] == i);
+        }
+        // Clearing still frees the auxiliary values the scene doesn't own
+        scene_clear(scene);
+        assert(num_freed_auxes == level + 1);
+        assert(scene_bodies(scene) == 0);
+    }
+    scene_free(scene);
+}
+
+void keep_released_body(body_t *body, list_t *released) {
+    list_add(released, body);
+}
+
+void test_released_bodies() {
+    scene_t *scene = scene_init();
+    list_t *released = list_init(2, (free_func_t)body_free);
+    body_t *body = body_init(make_shape(), 1, (rgba_color_t){0, 0, 0});
+    body_set_release_handler(body, (body_release_handler_t)keep_released_body,
+                             released);
+    scene_add_body(scene, body);
+    scene_add_body(scene, body_init(make_shape(), 1, (rgba_color_t){0, 0, 0}));
+    create_global_gravity(scene, 10, body);
+    for (size_t use = 0; use < 3; use++) {
+        // The force added in the tick the body is removed in is dropped
+        body_set_velocity(body, VEC_ZERO);
+        scene_tick(scene, 1);
+        body_add_force(body, (vector_t){.x = 100, .y = 0});
+        body_remove(body);
+        scene_tick(scene, 1);
+        assert(scene_bodies(scene) == 1);
+        assert(list_size(released) == 1);
+        assert(list_get(released, 0) == body);
+        assert(!body_is_removed(body));
+        // The body can be added again, and keeps moving like before
+        list_remove(released, 0);
+        body_set_velocity(body, VEC_ZERO);
+        scene_add_body(scene, body);
+        scene_tick(scene, 1);
+        assert(vec_isclose(body_get_velocity(body), VEC_ZERO));
+        create_global_gravity(scene, 10, body);
+    }
+    // Clearing and freeing the scene hand the body back too
+    scene_clear(scene);
+    assert(list_size(released) == 1);
+    scene_add_body(scene, list_remove(released, 0));
+    scene_free(scene);
+    assert(list_size(released) == 1);
+    list_free(released);
+}
+
+void test_spatial_queries() {
+    scene_t *scene = scene_init();
+    body_t *bodies[5];
+    for (size_t i = 0; i < 5; i++) {
+        bodies[i] = body_init(make_shape(), 1, (rgba_color_t){0, 0, 0});
+        // Add the bodies right to left so tree order differs from scene order
+        body_set_centroid(bodies[i], (vector_t){.x = 100 - 10 * (double)i,
+                                                .y = 0});
+        scene_add_body(scene, bodies[i]);
+    }
+
+    list_t *found = list_init(5, NULL);
+    bounding_box_t region = {.min_x = 65, .min_y = -5, .max_x = 85, .max_y = 5};
+    assert(scene_query_region(scene, region, found) == 2);
+    assert(list_get(found, 0) == bodies[2]);
+    assert(list_get(found, 1) == bodies[3]);
+
+    // Results are appended to the list
+    assert(scene_query_point(scene, (vector_t){.x = 100.5, .y = 0}, found) ==
+           1);
+    assert(list_size(found) == 3 && list_get(found, 2) == bodies[0]);
+    list_free(found);
+
+    found = list_init(5, NULL);
+    assert(scene_query_segment(scene, (vector_t){.x = 0, .y = 0},
+                               (vector_t){.x = 200, .y = 0}, found) == 5);
+    for (size_t i = 0; i < 5; i++) {
+        assert(list_get(found, i) == bodies[i]);
+    }
+    list_free(found);
+
+    // Bodies moved during a tick are found at their new position, and
+    // removed bodies aren't found
+    body_set_centroid(bodies[4], (vector_t){.x = 0, .y = 500});
+    body_remove(bodies[1]);
+    found = list_init(5, NULL);
+    assert(scene_query_point(scene, (vector_t){.x = 90, .y = 0}, found) == 0);
+    scene_tick(scene, 0);
+    assert(scene_query_point(scene, (vector_t){.x = 0, .y = 500}, found) == 1);
+    assert(list_get(found, 0) == bodies[4]);
+    assert(scene_query_region(scene, INFINITE_BBOX, found) == 4);
+    list_free(found);
+    scene_free(scene);
+}
+
+bool is_not_ignored(body_t *body, void *aux) {
+    return body != aux;
+}
+
+void test_raycast() {
+    scene_t *scene = scene_init();
+    body_t *bodies[3];
+    for (size_t i = 0; i < 3; i++) {
+        bodies[i] = body_init(make_shape(), 1, (rgba_color_t){0, 0, 0});
+        body_set_centroid(bodies[i], (vector_t){.x = 10 * (double)(3 - i),
+                                                .y = 0});
+        scene_add_body(scene, bodies[i]);
+    }
+
+    // The closest body is hit, even though it was added last
+    raycast_hit_t hit;
+    assert(scene_raycast(scene, VEC_ZERO, (vector_t){.x = 40, .y = 0}, NULL,
+                         NULL, &hit));
+    assert(hit.body == bodies[2]);
+    assert(isclose(hit.distance, 9));
+    assert(vec_isclose(hit.point, (vector_t){.x = 9, .y = 0}));
+
+    // Filtered bodies are passed through
+    assert(scene_raycast(scene, VEC_ZERO, (vector_t){.x = 40, .y = 0},
+                         is_not_ignored, bodies[2], &hit));
+    assert(hit.body == bodies[1]);
+    assert(isclose(hit.distance, 19));
+
+    // Rays that stop short or pass by don't hit anything
+    assert(!scene_raycast(scene, VEC_ZERO, (vector_t){.x = 8, .y = 0}, NULL,
+                          NULL, NULL));
+    assert(!scene_raycast(scene, (vector_t){.x = 0, .y = 2},
+                          (vector_t){.x = 40, .y = 2}, NULL, NULL, NULL));
+    assert(scene_raycast(scene, VEC_ZERO, (vector_t){.x = 40, .y = 0}, NULL,
+                         NULL, NULL));
+
+    // Removed bodies can't be hit
+    body_remove(bodies[2]);
+    assert(scene_raycast(scene, VEC_ZERO, (vector_t){.x = 40, .y = 0}, NULL,
+                         NULL, &hit));
+    assert(hit.body == bodies[1]);
+    scene_free(scene);
+}
+
+void count_static_rule_calls(body_t *body1, body_t *body2, vector_t axis,
+                             void *aux) {
+    // Two static bodies are never checked against each other
+    assert(!body_is_static(body1) || !body_is_static(body2));
+    (*(int *)aux)++;
+}
+
+void test_static_bodies() {
+    scene_t *scene = scene_init();
+    body_t *wall1 = body_init(make_shape(), 1, (rgba_color_t){0, 0, 0});
+    body_t *wall2 = body_init(make_shape(), 1, (rgba_color_t){0, 0, 0});
+    body_t *player = body_init(make_shape(), 1, (rgba_color_t){0, 0, 0});
+    body_set_static(wall1, true);
+    body_set_static(wall2, true);
+    body_t *bodies[] = {wall1, player, wall2};
+    for (size_t i = 0; i < 3; i++) {
+        body_set_collision_layers(bodies[i], 1);
+        scene_add_body(scene, bodies[i]);
+    }
+    int *count = malloc(sizeof(*count));
+    *count = 0;
+    scene_add_collision_rule(scene,
+                             (collision_rule_t){.layer1 = 1,
+                                                .layer2 = 1,
+                                                .handler =
+                                                    count_static_rule_calls,
+                                                .is_contact_collision = true},
+                             count, free);
+
+    body_set_velocity(wall1, (vector_t){1, 0});
+    body_set_velocity(player, (vector_t){1, 0});
+    scene_tick(scene, 1);
+    assert(*count == 2);
+    assert(vec_equal(body_get_centroid(wall1), VEC_ZERO));
+    assert(vec_isclose(body_get_centroid(player), (vector_t){1, 0}));
+
+    // Removing a static body stops its collisions
+    body_remove(wall2);
+    scene_tick(scene, 1);
+    assert(scene_bodies(scene) == 2);
+    assert(*count == 3);
+    scene_free(scene);
+}
+
+void count_hits(body_t *body1, body_t *body2, vector_t axis, void *aux) {
+    (*(int *)aux)++;
+}
+
+void test_continuous_bodies() {
+    const uint32_t BULLET = 1, WALL = 2;
+    scene_t *scene = scene_init();
+    body_t *wall = body_init(initialize_rectangle(10, -50, 11, 50), INFINITY,
+                             (rgba_color_t){0, 0, 0});
+    body_set_static(wall, true);
+    body_set_collision_layers(wall, WALL);
+    scene_add_body(scene, wall);
+    body_t *bullets[2];
+    for (size_t i = 0; i < 2; i++) {
+        bullets[i] = body_init(make_shape(), 1, (rgba_color_t){0, 0, 0});
+        body_set_collision_layers(bullets[i], BULLET);
+        body_set_velocity(bullets[i], (vector_t){100, 0});
+        scene_add_body(scene, bullets[i]);
+    }
+    body_set_continuous(bullets[0], true);
+    int *hits = malloc(sizeof(*hits));
+    *hits = 0;
+    scene_add_collision_rule(
+        scene,
+        (collision_rule_t){.layer1 = BULLET,
+                           .layer2 = WALL,
+                           .handler = count_hits,
+                           .is_continuous = true},
+        hits, free);
+
+    scene_tick(scene, 1);
+    // The continuous bullet stops just inside the wall, while the other one
+    // passes through it
+    vector_t centroid = body_get_centroid(bullets[0]);
+    assert(centroid.x > 8 && centroid.x < 9.5);
+    assert(isclose(body_get_centroid(bullets[1]).x, 100));
+    scene_tick(scene, 0);
+    assert(*hits == 1);
+    scene_free(scene);
+}
+
+void test_rule_layer_index() {
+    const uint32_t LAYER_A = 1, LAYER_B = 2, LAYER_C = 4, LAYER_D = 8;
+    scene_t *scene = scene_init();
+    uint32_t layers[] = {LAYER_A, LAYER_B, LAYER_C, LAYER_D, LAYER_A | LAYER_D};
+    for (size_t i = 0; i < 5; i++) {
+        body_t *body = body_init(make_shape(), 1, (rgba_color_t){0, 0, 0});
+        body_set_collision_layers(body, layers[i]);
+        scene_add_body(scene, body);
+    }
+    int *count = malloc(sizeof(*count));
+    *count = 0;
+    // A and B both appear in the rule, but only on the same side, so A-B
+    // pairs don't match. D isn't in any rule.
+    scene_add_collision_rule(scene,
+                             (collision_rule_t){.layer1 = LAYER_A | LAYER_B,
+                                                .layer2 = LAYER_C,
+                                                .handler = count_hits,
+                                                .is_contact_collision = true},
+                             count, free);
+    scene_tick(scene, 0);
+    // (A, C), (B, C) and (A | D, C)
+    assert(*count == 3);
+    scene_free(scene);
+}
+
+typedef struct {
+    int begins;
+    int persists;
+    int ends;
+} contact_aux_t;
+void count_begins(body_t *body1, body_t *body2, vector_t axis, void *aux) {
+    ((contact_aux_t *)aux)->begins++;
+}
+void count_persists(body_t *body1, body_t *body2, vector_t axis, void *aux) {
+    ((contact_aux_t *)aux)->persists++;
+}
+void count_ends(body_t *body1, body_t *body2, vector_t axis, void *aux) {
+    ((contact_aux_t *)aux)->ends++;
+}
+
+void test_contact_events() {
+    const uint32_t LAYER_A = 1, LAYER_B = 2;
+    scene_t *scene = scene_init();
+    body_t *a = body_init(make_shape(), 1, (rgba_color_t){0, 0, 0});
+    body_t *b = body_init(make_shape(), 1, (rgba_color_t){0, 0, 0});
+    body_set_collision_layers(a, LAYER_A);
+    body_set_collision_layers(b, LAYER_B);
+    body_set_centroid(b, (vector_t){1, 0});
+    scene_add_body(scene, a);
+    scene_add_body(scene, b);
+    contact_aux_t *aux = malloc(sizeof(*aux));
+    *aux = (contact_aux_t){0};
+    scene_add_collision_rule(scene,
+                             (collision_rule_t){.layer1 = LAYER_A,
+                                                .layer2 = LAYER_B,
+                                                .handler = count_begins,
+                                                .end_handler = count_ends},
+                             aux, free);
+    scene_add_collision_rule(scene,
+                             (collision_rule_t){.layer1 = LAYER_B,
+                                                .layer2 = LAYER_A,
+                                                .handler = count_persists,
+                                                .is_contact_collision = true},
+                             aux, NULL);
+
+    for (int i = 0; i < 3; i++) {
+        scene_tick(scene, 0);
+    }
+    assert(aux->begins == 1);
+    assert(aux->persists == 3);
+    assert(aux->ends == 0);
+
+    // Moving apart ends the contact once, even though the bodies are no
+    // longer a candidate pair
+    body_set_centroid(b, (vector_t){5, 0});
+    scene_tick(scene, 0);
+    scene_tick(scene, 0);
+    assert(aux->begins == 1);
+    assert(aux->persists == 3);
+    assert(aux->ends == 1);
+
+    // Touching again begins a new contact
+    body_set_centroid(b, (vector_t){1, 0});
+    scene_tick(scene, 0);
+    assert(aux->begins == 2);
+    assert(aux->persists == 4);
+
+    // Removing a body ends the contact without calling the end handler
+    body_remove(b);
+    scene_tick(scene, 0);
+    scene_tick(scene, 0);
+    assert(aux->ends == 1);
+    scene_free(scene);
+}
+
+void test_sensors() {
+    const uint32_t PLAYER = 1, KEY = 2, WALL = 4;
+    scene_t *scene = scene_init();
+    // The player misses the diamond-shaped key, but not its bounding box
+    body_t *key = body_init(initialize_regular_polygon(VEC_ZERO, 2, 4), 1,
+                            (rgba_color_t){0, 0, 0});
+    body_t *player = body_init(make_shape(), 1, (rgba_color_t){0, 0, 0});
+    body_t *wall = body_init(make_shape(), 1, (rgba_color_t){0, 0, 0});
+    body_set_static(key, true);
+    body_set_static(wall, true);
+    body_set_sensor(key, SENSOR_BOUNDING_BOX);
+    body_set_collision_layers(key, KEY);
+    body_set_collision_layers(player, PLAYER);
+    body_set_collision_layers(wall, WALL);
+    body_set_centroid(player, (vector_t){2.2, 2.2});
+    scene_add_body(scene, key);
+    scene_add_body(scene, player);
+    scene_add_body(scene, wall);
+    int *hits = malloc(sizeof(*hits));
+    *hits = 0;
+    scene_add_collision_rule(scene,
+                             (collision_rule_t){.layer1 = PLAYER | WALL,
+                                                .layer2 = KEY,
+                                                .handler = count_hits,
+                                                .is_contact_collision = true},
+                             hits, free);
+    create_instant_resolution_collision_rule(scene, PLAYER, KEY);
+    scene_tick(scene, 0);
+    assert(*hits == 1);
+    // The sensor doesn't push the player out, and the static wall inside the
+    // key is never checked against it
+    assert(vec_isclose(body_get_centroid(player), (vector_t){2.2, 2.2}));
+
+    body_set_sensor(key, SENSOR_SHAPE);
+    scene_tick(scene, 0);
+    assert(*hits == 1);
+    body_set_centroid(player, (vector_t){1.5, 1.5});
+    scene_tick(scene, 0);
+    assert(*hits == 2);
+    assert(vec_isclose(body_get_centroid(player), (vector_t){1.5, 1.5}));
+    scene_free(scene);
+}
+
+void test_resolution_against_adjacent_walls() {
+    const uint32_t PLAYER = 1, WALL = 2;
+    scene_t *scene = scene_init();
+    // The player sinks into two floor tiles, the second one a step lower
+    body_t *tiles[2];
+    for (size_t i = 0; i < 2; i++) {
+        tiles[i] = body_init(
+            initialize_rectangle(2 * i, 0, 2 * i + 2, 1 - 0.1 * i), INFINITY,
+            (rgba_color_t){0, 0, 0});
+        body_set_static(tiles[i], true);
+        body_set_collision_layers(tiles[i], WALL);
+        scene_add_body(scene, tiles[i]);
+    }
+    body_t *player = body_init(initialize_rectangle(1.5, 0.8, 3.5, 2.8), 1,
+                               (rgba_color_t){0, 0, 0});
+    body_set_collision_layers(player, PLAYER);
+    scene_add_body(scene, player);
+    create_instant_resolution_collision_rule(scene, PLAYER, WALL);
+    scene_tick(scene, 0);
+    // The player is left just inside the higher tile, which lifts it off the
+    // lower one, and the lower tile's stale contact doesn't pull it back down
+    assert(vec_isclose(body_get_centroid(player), (vector_t){2.5, 1.99}));
+    assert(detect_body_collision(player, tiles[1]).collided == NO_COLLISION);
+    scene_free(scene);
+}
+
+void test_parallel_narrowphase() {
+    // Enough overlapping pairs to be checked on several threads
+    const size_t GRID_SIZE = 20;
+    scene_t *scene = scene_init();
+    for (size_t x = 0; x < GRID_SIZE; x++) {
+        for (size_t y = 0; y < GRID_SIZE; y++) {
+            body_t *body = body_init(make_shape(), 1, (rgba_color_t){0, 0, 0});
+            body_set_centroid(body, (vector_t){1.5 * x, 1.7 * y});
+            body_rotate(body, 0.1 * (x + y));
+            body_set_collision_layers(body, 1);
+            scene_add_body(scene, body);
+        }
+    }
+    int expected = 0;
+    for (size_t i = 0; i < scene_bodies(scene); i++) {
+        for (size_t j = i + 1; j < scene_bodies(scene); j++) {
+            collision_info_t info = detect_body_collision(
+                scene_get_body(scene, i), scene_get_body(scene, j));
+            expected += info.collided != NO_COLLISION;
+        }
+    }
+    int *hits = malloc(sizeof(*hits));
+    *hits = 0;
+    scene_add_collision_rule(scene,
+                             (collision_rule_t){.layer1 = 1,
+                                                .layer2 = 1,
+                                                .handler = count_hits,
+                                                .is_contact_collision = true},
+                             hits, free);
+    scene_tick(scene, 0);
+    assert(expected > 256);
+    assert(*hits == expected);
+    scene_tick(scene, 0);
+    assert(*hits == 2 * expected);
+    scene_free(scene);
+}
+
+void test_scene_stats() {
+    scene_t *scene = scene_init();
+    body_t *a = body_init(make_shape(), 1, (rgba_color_t){0, 0, 0});
+    body_t *b = body_init(make_shape(), 1, (rgba_color_t){0, 0, 0});
+    body_t *c = body_init(make_shape(), 1, (rgba_color_t){0, 0, 0});
+    body_set_collision_layers(a, 1);
+    body_set_collision_layers(b, 2);
+    body_set_collision_layers(c, 4);
+    body_set_centroid(b, (vector_t){1, 0});
+    body_set_centroid(c, (vector_t){1, 1});
+    scene_add_body(scene, a);
+    scene_add_body(scene, b);
+    scene_add_body(scene, c);
+    int *hits = malloc(sizeof(*hits));
+    *hits = 0;
+    scene_add_collision_rule(scene,
+                             (collision_rule_t){.layer1 = 1,
+                                                .layer2 = 2 | 4,
+                                                .handler = count_hits,
+                                                .is_contact_collision = true},
+                             hits, free);
+    scene_stats_t stats = scene_get_stats(scene);
+    assert(stats.candidate_pairs == 0 && stats.handler_calls == 0);
+
+    scene_tick(scene, 0);
+    stats = scene_get_stats(scene);
+    // The rule mentions the layers of b and c, so they are checked too, but
+    // no handler is called for them
+    assert(stats.candidate_pairs == 3);
+    assert(stats.pairs_checked == 3);
+    assert(stats.sat_calls == 3);
+    // The squares' edges are all parallel to the same two axes
+    assert(stats.axes_projected == 6);
+    assert(stats.gjk_calls == 0);
+    assert(stats.contacts == 3);
+    assert(stats.handler_calls == 2);
+
+    // Bodies that didn't move are remembered, and the counters start over
+    scene_tick(scene, 0);
+    stats = scene_get_stats(scene);
+    assert(stats.pairs_checked == 3);
+    assert(stats.sat_calls == 0 && stats.axes_projected == 0);
+    assert(stats.handler_calls == 2);
+    assert(*hits == 4);
+    scene_free(scene);
+}
+
 int main(int argc, char *argv[]) {
     // Run all tests if there are no command-line arguments
     bool all_tests = argc == 1;
@@ -276,7 +852,20 @@ int main(int argc, char *argv[]) {
     DO_TEST(test_force_creator)
     DO_TEST(test_force_creator_aux)
     DO_TEST(test_reaping)
+    DO_TEST(test_scene_clear)
+    DO_TEST(test_released_bodies)
     DO_TEST(test_line_of_sight)
+    DO_TEST(test_collision_rules)
+    DO_TEST(test_spatial_queries)
+    DO_TEST(test_raycast)
+    DO_TEST(test_static_bodies)
+    DO_TEST(test_continuous_bodies)
+    DO_TEST(test_rule_layer_index)
+    DO_TEST(test_contact_events)
+    DO_TEST(test_sensors)
+    DO_TEST(test_resolution_against_adjacent_walls)
+    DO_TEST(test_parallel_narrowphase)
+    DO_TEST(test_scene_stats)
 
     puts("scene_test PASS");
 }
@@ -0,0 +1,69 @@
+#include "test_util.h"
+#include "thread_pool.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#define NUM_ITEMS 1000
+
+typedef struct {
+    size_t visits[NUM_ITEMS];
+} visit_aux_t;
+
+void visit_items(visit_aux_t *aux, size_t start, size_t end) {
+    assert(start < end && end <= NUM_ITEMS);
+    for (size_t i = start; i < end; i++) {
+        aux->visits[i]++;
+    }
+}
+
+void check_pool(thread_pool_t *pool) {
+    size_t counts[] = {0, 1, 2, 7, NUM_ITEMS};
+    for (size_t c = 0; c < sizeof(counts) / sizeof(*counts); c++) {
+        visit_aux_t *aux = calloc(1, sizeof(visit_aux_t));
+        assert(aux);
+        // Every item is processed exactly once, every time the pool is used
+        for (size_t run = 0; run < 3; run++) {
+            thread_pool_run(pool, counts[c], (thread_pool_func_t)visit_items,
+                            aux);
+            for (size_t i = 0; i < NUM_ITEMS; i++) {
+                assert(aux->visits[i] == (i < counts[c] ? run + 1 : 0));
+            }
+        }
+        free(aux);
+    }
+}
+
+void test_serial_pool() {
+    thread_pool_t *pool = thread_pool_init(0);
+    assert(thread_pool_workers(pool) == 0);
+    check_pool(pool);
+    thread_pool_free(pool);
+}
+
+void test_worker_pools() {
+    for (size_t num_workers = 1; num_workers <= 4; num_workers++) {
+        thread_pool_t *pool = thread_pool_init(num_workers);
+        assert(thread_pool_workers(pool) <= num_workers);
+        check_pool(pool);
+        thread_pool_free(pool);
+    }
+    thread_pool_t *pool = thread_pool_init(thread_pool_default_workers());
+    check_pool(pool);
+    thread_pool_free(pool);
+}
+
+int main(int argc, char *argv[]) {
+    // Run all tests if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests) {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_serial_pool)
+    DO_TEST(test_worker_pools)
+
+    puts("thread_pool_test PASS");
+}